@@ -0,0 +1,172 @@
+/*=============================================================================
+  Copyright (C) 2012-2022 Allied Vision Technologies.  All Rights Reserved.
+
+  Redistribution of this file, in original or modified form, without
+  prior written consent of Allied Vision Technologies is prohibited.
+
+-------------------------------------------------------------------------------
+
+  File:        AsyncFileLogger.h
+
+  Description: Definition of class VmbCPP::AsyncFileLogger.
+
+-------------------------------------------------------------------------------
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+  NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+  DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+=============================================================================*/
+
+#ifndef VMBCPP_ASYNCFILELOGGER_H
+#define VMBCPP_ASYNCFILELOGGER_H
+
+/**
+* \file        AsyncFileLogger.h
+*
+* \brief Definition of class VmbCPP::AsyncFileLogger.
+*/
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <VmbC/VmbCommonTypes.h>
+#include <VmbCPP/LogLevel.h>
+
+
+namespace VmbCPP {
+
+/**
+ * \brief A logger writing to a file from a background thread.
+ *
+ * Log() copies the message and a monotonic time stamp into a fixed size slot of a
+ * lock-free ring and returns; it neither allocates nor takes a lock, so it is safe
+ * to call from the frame and feature callbacks. A writer thread formats the queued
+ * messages and writes them with one write and flush per batch. If the ring is full,
+ * the message is dropped and counted; the count is written to the log.
+ *
+ * Time stamps are seconds since the logger was created; the first line of every
+ * session holds the wall clock time of that point.
+ */
+class AsyncFileLogger
+{
+public:
+    /**
+     * \brief Number of messages the ring holds. A power of two.
+     */
+    static constexpr std::size_t RingCapacity = 1024;
+
+    /**
+     * \brief Longer messages are truncated.
+     */
+    static constexpr std::size_t MaxMessageLength = 240;
+
+    /**
+     * \param[in] pFileName     the file name of the log file, in the temporary directory
+     * \param[in] append        determines, if the contents of an existing file are kept or not
+     * \param[in] level         messages below this level are discarded
+     */
+    AsyncFileLogger( const char *pFileName, bool append = true, LogLevel level = LogLevel::Info );
+
+    /**
+     * \brief Object is not copyable
+     */
+    AsyncFileLogger(const AsyncFileLogger&) = delete;
+
+    /**
+     * \brief Object is not copyable
+     */
+    AsyncFileLogger& operator=(const AsyncFileLogger&) = delete;
+
+    /**
+     * \brief null is not allowed as file name
+     */
+    AsyncFileLogger(std::nullptr_t, bool) = delete;
+
+    /**
+     * \brief Writes the messages still queued and stops the writer thread.
+     */
+    virtual ~AsyncFileLogger();
+
+    /**
+     * \brief Queue \p StrMessage with level Info
+     *
+     * \param[in] StrMessage the message to log
+     */
+    void Log( const std::string &StrMessage );
+
+    /**
+     * \brief Queue \p StrMessage, if \p level passes the filter
+     *
+     * \param[in] level      the severity of the message
+     * \param[in] StrMessage the message to log
+     */
+    void Log( LogLevel level, const std::string &StrMessage );
+
+    /**
+     * \brief Check the filter before building a message.
+     */
+    bool IsEnabled( LogLevel level ) const noexcept
+    {
+        return static_cast<int>( level ) >= m_level.load( std::memory_order_relaxed );
+    }
+
+    /**
+     * \brief Discard messages below \p level from now on.
+     */
+    void SetLevel( LogLevel level ) noexcept
+    {
+        m_level.store( static_cast<int>( level ), std::memory_order_relaxed );
+    }
+
+    /**
+     * \brief Number of messages dropped because the ring was full.
+     */
+    VmbUint64_t GetDroppedCount() const noexcept
+    {
+        return m_dropped.load( std::memory_order_relaxed );
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<std::size_t>    sequence;
+        VmbUint64_t                 timeNs;
+        LogLevel                    level;
+        VmbUint32_t                 length;
+        char                        text[MaxMessageLength];
+    };
+
+    std::ofstream                   m_File;
+    std::unique_ptr<Slot[]>         m_pSlots;
+    alignas(64) std::atomic<std::size_t> m_enqueuePos { 0 };
+    alignas(64) std::size_t         m_dequeuePos { 0 };
+    std::atomic<int>                m_level;
+    std::atomic<VmbUint64_t>        m_dropped { 0 };
+    VmbUint64_t                     m_startTimeNs;
+
+    std::mutex                      m_wakeMutex;
+    std::condition_variable         m_wake;
+    bool                            m_stop { false };
+    std::thread                     m_writer;
+
+    void WriterLoop();
+    bool WriteBatch( std::string &batch, VmbUint64_t &reportedDrops );
+};
+
+} //namespace VmbCPP
+
+#endif
@@ -86,11 +86,14 @@ public:
      */
     void Log( const std::string &StrMessage );
 
+    /**
+     * \brief The directory log files are created in, with a trailing delimiter; empty if none was found
+     */
+    static std::string GetTemporaryDirectoryPath();
+
 private:
     std::ofstream   m_File;
     MutexPtr        m_pMutex;
-
-    std::string GetTemporaryDirectoryPath();
 };
 
 } //namespace VmbCPP
@@ -0,0 +1,54 @@
+/*=============================================================================
+  Copyright (C) 2012-2022 Allied Vision Technologies.  All Rights Reserved.
+
+  Redistribution of this file, in original or modified form, without
+  prior written consent of Allied Vision Technologies is prohibited.
+
+-------------------------------------------------------------------------------
+
+  File:        LogLevel.h
+
+  Description: Severity levels for the VmbCPP log.
+
+-------------------------------------------------------------------------------
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+  NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+  DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+=============================================================================*/
+
+#ifndef VMBCPP_LOGLEVEL_H
+#define VMBCPP_LOGLEVEL_H
+
+/**
+* \file  LogLevel.h
+*
+* \brief Severity levels for the VmbCPP log.
+*/
+
+
+namespace VmbCPP {
+
+/**
+ * \brief Severity of a log message, in increasing order.
+ */
+enum class LogLevel
+{
+    Trace,      //!< Detailed tracing of calls
+    Debug,      //!< Information useful while debugging
+    Info,       //!< Free text messages of the API
+    Warning,    //!< Unexpected, but recoverable conditions
+    Error,      //!< Failed calls, logged together with their VmbErrorType
+};
+
+}  // namespace VmbCPP
+
+#endif //VMBCPP_LOGLEVEL_H
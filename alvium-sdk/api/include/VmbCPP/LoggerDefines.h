@@ -43,14 +43,31 @@
 #endif
 #ifndef USER_LOGGER
 
-#include "FileLogger.h"
+#include "LogLevel.h"
+#ifdef VMBCPP_ASYNC_LOGGER
+    #include "AsyncFileLogger.h"
+#else
+    #include "FileLogger.h"
+#endif
+
+/**
+ * \brief Defined if the logger provides LOGGER_ENABLED and LOGGER_LOG_LEVEL.
+ */
+#define VMBCPP_LOGGER_HAS_LEVELS
 
 namespace VmbCPP {
 
+#ifdef VMBCPP_ASYNC_LOGGER
+    /**
+     * \brief A type alias determining the logger type to be used by the VmbCPP API.
+     */
+    using Logger = AsyncFileLogger;
+#else
     /**
      * \brief A type alias determining the logger type to be used by the VmbCPP API.
      */
     using Logger = FileLogger;
+#endif
 
     /**
      * \brief The used to pass the log info on to the logger object.
@@ -69,16 +86,56 @@ namespace VmbCPP {
         }
     }
 
+    /**
+     * \brief Check whether a message of the given level would be logged, before it is built.
+     *
+     * \param[in] logger        a pointer to the logger object; may be null
+     * \param[in] level         the severity of the message
+     */
+    inline bool LOGGER_ENABLED(Logger* logger, LogLevel level)
+    {
+#ifdef VMBCPP_ASYNC_LOGGER
+        return nullptr != logger && logger->IsEnabled(level);
+#else
+        (void)level;
+        return nullptr != logger;
+#endif
+    }
+
+    /**
+     * \brief Pass the log info on to the logger object together with its severity.
+     *
+     * \param[in] logger        a pointer to the logger object; may be null resulting in the log message being dropped
+     * \param[in] level         the severity of the message
+     * \param[in] loggingInfo   the info that should be logged
+     *
+     * \tparam LoggingInfoType  the type of information to be forwarded to the logger.
+     */
+    template<typename LoggingInfoType>
+    inline void LOGGER_LOG_LEVEL(Logger* logger, LogLevel level, LoggingInfoType&& loggingInfo)
+    {
+#ifdef VMBCPP_ASYNC_LOGGER
+        if (nullptr != logger)
+        {
+            logger->Log(level, std::forward<LoggingInfoType>(loggingInfo));
+        }
+#else
+        (void)level;
+        LOGGER_LOG(logger, std::forward<LoggingInfoType>(loggingInfo));
+#endif
+    }
+
     /**
      * \brief Create a file logger object.
      *
      * The created logger appends log entries to VmbCPP.log in the temporary directory.
+     * With VMBCPP_ASYNC_LOGGER defined, the entries are written by a background thread.
      *
      * \return a raw pointer to the newly created file object.
      */
     inline Logger* CreateLogger()
     {
-        return new FileLogger("VmbCPP.log", true);
+        return new Logger("VmbCPP.log", true);
     }
 }
 
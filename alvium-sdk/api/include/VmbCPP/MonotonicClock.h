@@ -0,0 +1,97 @@
+/*=============================================================================
+  Copyright (C) 2012-2022 Allied Vision Technologies.  All Rights Reserved.
+
+  Redistribution of this file, in original or modified form, without
+  prior written consent of Allied Vision Technologies is prohibited.
+
+-------------------------------------------------------------------------------
+
+  File:        MonotonicClock.h
+
+  Description: Monotonic nanosecond time stamps and sleeps.
+
+-------------------------------------------------------------------------------
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+  NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+  DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+=============================================================================*/
+
+#ifndef VMBCPP_MONOTONICCLOCK
+#define VMBCPP_MONOTONICCLOCK
+
+/**
+* \file  MonotonicClock.h
+*
+* \brief Monotonic nanosecond time stamps and sleeps.
+*
+* Header only, so that applications can time acquisitions against the same
+* clock VmbCPP uses for its own timeouts. Not included by VmbCPP.h.
+*/
+
+#include <VmbC/VmbCommonTypes.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <errno.h>
+    #include <time.h>
+#endif
+
+
+namespace VmbCPP {
+
+/**
+ * \brief Nanoseconds since an arbitrary fixed point.
+ *
+ * Based on CLOCK_MONOTONIC (QueryPerformanceCounter on Windows), so unaffected
+ * by changes to the wall clock. Only differences between two values are meaningful.
+ */
+inline VmbUint64_t GetMonotonicTimeNs()
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency( &frequency );
+    QueryPerformanceCounter( &counter );
+    const VmbUint64_t seconds = (VmbUint64_t)counter.QuadPart / (VmbUint64_t)frequency.QuadPart;
+    const VmbUint64_t rest = (VmbUint64_t)counter.QuadPart % (VmbUint64_t)frequency.QuadPart;
+    return seconds * 1000000000ull + rest * 1000000000ull / (VmbUint64_t)frequency.QuadPart;
+#else
+    timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return (VmbUint64_t)now.tv_sec * 1000000000ull + (VmbUint64_t)now.tv_nsec;
+#endif
+}
+
+/**
+ * \brief Sleep until GetMonotonicTimeNs() reaches deadlineNs.
+ */
+inline void SleepUntilMonotonicNs( VmbUint64_t deadlineNs )
+{
+#ifdef _WIN32
+    for ( VmbUint64_t now = GetMonotonicTimeNs(); now < deadlineNs; now = GetMonotonicTimeNs() )
+    {
+        ::Sleep( (DWORD)( ( deadlineNs - now + 999999ull ) / 1000000ull ) );
+    }
+#else
+    timespec deadline;
+    deadline.tv_sec = (time_t)( deadlineNs / 1000000000ull );
+    deadline.tv_nsec = (long)( deadlineNs % 1000000000ull );
+    while ( EINTR == clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr ) )
+    {
+    }
+#endif
+}
+
+}  // namespace VmbCPP
+
+#endif //VMBCPP_MONOTONICCLOCK
@@ -60,19 +60,28 @@ namespace VmbCPP {
     class shared_ptr final
     {
     private:
-        class ref_count;
+        class atomic_ref_count;
+        class inplace_ref_count;
 
         typedef shared_ptr<T> this_type;
         
         template<class T2>
         friend class shared_ptr;
 
+        template<class T2, class... Args>
+        friend shared_ptr<T2> make_shared(Args&&... args);
+
         VmbCPP::ref_count_base  *m_pRefCount;
         T                       *m_pObject;
 
         template <class T2>
         static void swap(T2 &rValue1, T2 &rValue2);
 
+        /**
+         * \brief Adopt a reference counter that already counts this pointer (used by make_shared).
+         */
+        shared_ptr(VmbCPP::ref_count_base *pRefCount, T *pObject) noexcept;
+
     public:
         shared_ptr() noexcept;
 
@@ -314,6 +323,19 @@ namespace VmbCPP {
     template<class T>
     using SharedPointer = shared_ptr<T>;
 
+    /**
+     * \brief Create an object and the reference counter owning it in a single allocation.
+     *
+     * \param[in] args  the arguments passed to the constructor of \p T
+     *
+     * \tparam T       the type of the object to create
+     * \tparam Args    the types of the constructor arguments
+     *
+     * \return a shared pointer owning the new object
+     */
+    template<class T, class... Args>
+    shared_ptr<T> make_shared(Args&&... args);
+
     /**
      * \brief The function used for assigning ownership of a raw pointer to a shared pointer object.
      * 
@@ -36,9 +36,13 @@
 * \note        (This include file contains example code only.)
 */
 
+#include <atomic>
 #include <cassert>
 #include <cstddef>
+#include <new>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 #include <VmbCPP/Mutex.h>
 
@@ -71,17 +75,63 @@ namespace VmbCPP {
     };
 
     /**
-     * \brief Reference counter implementation for shared_ptr.
+     * \brief Lock-free reference count shared by the counter implementations below.
+     *
+     * Increments only need to be atomic; the decrement that releases the object synchronizes with
+     * all earlier decrements so that the object is destroyed after every other owner is done with it.
+     */
+    class atomic_count
+    {
+    private:
+        std::atomic<long> m_nCount;
+
+    public:
+        atomic_count() noexcept
+            : m_nCount(1)
+        {
+        }
+
+        void inc() noexcept
+        {
+            m_nCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * \brief decrement the count
+         *
+         * \return true if this released the last reference
+         */
+        bool dec()
+        {
+            const long previous = m_nCount.fetch_sub(1, std::memory_order_acq_rel);
+            if (previous <= 0)
+            {
+                throw std::logic_error("shared pointer, used incorrectly");
+            }
+            return previous == 1;
+        }
+
+        long get() const noexcept
+        {
+            return m_nCount.load(std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * \brief Reference counter for an object allocated separately.
+     *
+     * This replaces the mutex-based shared_ptr<T>::ref_count of earlier versions. It has a different
+     * name on purpose: the prebuilt library exports its instantiations of ref_count as weak symbols,
+     * and both kinds of counter have to coexist behind ref_count_base.
      *
      * \tparam T    The type of object the shared pointer refers to
      */
     template <class T>
-    class shared_ptr<T>::ref_count : public ref_count_base
+    class shared_ptr<T>::atomic_ref_count : public ref_count_base
     {
     private:
-        T* m_pObject;
-        long            m_nCount;
-        Mutex           m_Mutex;
+        T*              m_pObject;
+        atomic_count    m_Count;
 
     public:
         /**
@@ -89,57 +139,89 @@ namespace VmbCPP {
          *
          * \param[in]   pObject     a pointer to the object the created object counts references for
          */
-        explicit ref_count(T* pObject)
-            : m_pObject(pObject),
-            m_nCount(1)
+        explicit atomic_ref_count(T* pObject)
+            : m_pObject(pObject)
         {
         }
 
-        virtual ~ref_count()
+        virtual ~atomic_ref_count()
         {
-            if (nullptr != m_pObject)
+            delete m_pObject;
+        }
+
+        atomic_ref_count(const atomic_ref_count& rRefCount) = delete;
+        atomic_ref_count& operator=(const atomic_ref_count& rRefCount) = delete;
+
+        virtual void inc() override
+        {
+            m_Count.inc();
+        }
+
+        virtual void dec() override
+        {
+            if (m_Count.dec())
             {
-                delete m_pObject;
+                delete this;
             }
+        }
 
-            m_Mutex.Unlock();
+        virtual long use_count() const override
+        {
+            return m_Count.get();
         }
+    };
 
-        ref_count(const ref_count& rRefCount) = delete;
-        ref_count& operator=(const ref_count& rRefCount) = delete;
+    /**
+     * \brief Reference counter that holds the object itself, created by make_shared.
+     *
+     * \tparam T    The type of object the shared pointer refers to
+     */
+    template <class T>
+    class shared_ptr<T>::inplace_ref_count : public ref_count_base
+    {
+    private:
+        atomic_count    m_Count;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type m_Storage;
 
-        virtual void inc() override
+    public:
+        /**
+         * \brief constructor creating the object from the given arguments
+         */
+        template <class... Args>
+        explicit inplace_ref_count(Args&&... args)
+        {
+            ::new (static_cast<void*>(&m_Storage)) T(std::forward<Args>(args)...);
+        }
+
+        virtual ~inplace_ref_count()
         {
-            m_Mutex.Lock();
+            object()->~T();
+        }
 
-            m_nCount++;
+        inplace_ref_count(const inplace_ref_count& rRefCount) = delete;
+        inplace_ref_count& operator=(const inplace_ref_count& rRefCount) = delete;
 
-            m_Mutex.Unlock();
+        T* object() noexcept
+        {
+            return reinterpret_cast<T*>(&m_Storage);
         }
 
-        virtual void dec() override
+        virtual void inc() override
         {
-            m_Mutex.Lock();
-            if (m_nCount == 0)
-            {
-                throw std::logic_error("shared pointer, used incorrectly");
-            }
-            if (m_nCount > 1)
-            {
-                m_nCount--;
+            m_Count.inc();
+        }
 
-                m_Mutex.Unlock();
-            }
-            else
+        virtual void dec() override
+        {
+            if (m_Count.dec())
             {
-                // m_Mutex will be unlocked in d'tor
                 delete this;
             }
         }
 
         virtual long use_count() const override
         {
-            return m_nCount;
+            return m_Count.get();
         }
     };
 
@@ -165,17 +247,27 @@ namespace VmbCPP {
         :   m_pRefCount(nullptr)
         ,   m_pObject(nullptr)
     {
-        m_pRefCount = new typename shared_ptr<T2>::ref_count(pObject);
-        if(nullptr == m_pRefCount)
+        try
+        {
+            m_pRefCount = new typename shared_ptr<T2>::atomic_ref_count(pObject);
+        }
+        catch(...)
         {
             delete pObject;
 
-            throw std::bad_alloc();
+            throw;
         }
 
         m_pObject = pObject;
     }
 
+    template <class T>
+    shared_ptr<T>::shared_ptr(VmbCPP::ref_count_base *pRefCount, T *pObject) noexcept
+        :   m_pRefCount(pRefCount)
+        ,   m_pObject(pObject)
+    {
+    }
+
     template <class T>
     shared_ptr<T>::shared_ptr(std::nullptr_t) noexcept
         : shared_ptr(static_cast<T*>(nullptr))
@@ -357,6 +449,14 @@ namespace VmbCPP {
         return sp.get() != nullptr;
     }
 
+    template<class T, class... Args>
+    shared_ptr<T> make_shared(Args&&... args)
+    {
+        typename shared_ptr<T>::inplace_ref_count *pRefCount = new typename shared_ptr<T>::inplace_ref_count(std::forward<Args>(args)...);
+
+        return shared_ptr<T>(pRefCount, pRefCount->object());
+    }
+
     template<class T, class U, typename std::enable_if<std::is_assignable<T*&, U*>::value, int>::type>
     inline void SP_SET(shared_ptr<T>& target, U* rawPtr)
     {
@@ -53,6 +53,8 @@ set(VMB_CPP_TEMPLATE_SCRIPT_DIR ${CMAKE_CURRENT_LIST_DIR} CACHE INTERNAL "Path t
 #
 #   - ADDITIONAL_SOURCES [<src>...]                             sources to add to the sources of the target
 #   - NO_RC                                                     exclude rc file on windows (automatically done for non-shared
+#   - ASYNC_LOGGER                                              log through VmbCPP::AsyncFileLogger instead of VmbCPP::FileLogger;
+#                                                               ignored if FILE_LOGGER_HEADER is given
 #
 #   - DOXYGEN_TARGET <target-name>                              Specify the name of the target for generating the doxygen docu, if doxygen is found
 #
@@ -63,7 +65,7 @@ set(VMB_CPP_TEMPLATE_SCRIPT_DIR ${CMAKE_CURRENT_LIST_DIR} CACHE INTERNAL "Path t
 # If ADDITIONAL_SOURCES is present, the sources are added to the target's sources
 #
 function(vmb_create_cpp_target PARAM_1 PARAM_2)
-    set(OPTION_PARAMS NO_RC)
+    set(OPTION_PARAMS NO_RC ASYNC_LOGGER)
     set(SINGLE_VALUE_PARAMS
         TARGET_NAME TYPE
         GENERATED_INCLUDES_DIR
@@ -107,6 +109,7 @@ function(vmb_create_cpp_target PARAM_1 PARAM_2)
     set(PUBLIC_HEADERS)
 
     vmb_source_group(SOURCES ${VMBCPP_SOURCE_DIR} Base
+        AsyncFileLogger.cpp
         BasicLockable.cpp
         Clock.cpp
         Condition.cpp
@@ -118,9 +121,12 @@ function(vmb_create_cpp_target PARAM_1 PARAM_2)
     )
 
     vmb_source_group(PUBLIC_HEADERS "${VMBCPP_INCLUDE_DIR}/VmbCPP" Base
+        AsyncFileLogger.h
         BasicLockable.h
         FileLogger.h
+        LogLevel.h
         LoggerDefines.h
+        MonotonicClock.h
         Mutex.h
         SharedPointer.h
         SharedPointerDefines.h
@@ -278,6 +284,13 @@ function(vmb_create_cpp_target PARAM_1 PARAM_2)
 
     vmb_cpp_add_config_header(FILE_LOGGER_HEADER USER_LOGGER VmbCPP/UserLoggerDefines.h VMBCPP_LOGGERDEFINES_H LoggerDefines.h)
     vmb_cpp_add_config_header(SHARED_POINTER_HEADER USER_SHARED_POINTER VmbCPP/UserSharedPointerDefines.h VMBCPP_SHAREDPOINTERDEFINES_H SharedPointerDefines.h)
+
+    if (PARAMS_ASYNC_LOGGER)
+        set(_CONTENT "${_CONTENT}
+
+#define VMBCPP_ASYNC_LOGGER
+")
+    endif()
     
     if(APPLE)
         file(MAKE_DIRECTORY "${PARAMS_GENERATED_INCLUDES_DIR}/VmbCPP")
@@ -339,6 +352,10 @@ function(vmb_create_cpp_target PARAM_1 PARAM_2)
     endif()
 
     target_link_libraries(${PARAMS_TARGET_NAME} PUBLIC Vmb::C)
+
+    # AsyncFileLogger runs a writer thread
+    find_package(Threads REQUIRED)
+    target_link_libraries(${PARAMS_TARGET_NAME} PRIVATE Threads::Threads)
     target_include_directories(${PARAMS_TARGET_NAME} PUBLIC
         $<BUILD_INTERFACE:${VMBCPP_INCLUDE_DIR}>
     )
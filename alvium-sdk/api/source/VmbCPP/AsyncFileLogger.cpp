@@ -0,0 +1,254 @@
+/*=============================================================================
+  Copyright (C) 2012-2022 Allied Vision Technologies.  All Rights Reserved.
+
+  Redistribution of this file, in original or modified form, without
+  prior written consent of Allied Vision Technologies is prohibited.
+
+-------------------------------------------------------------------------------
+
+  File:        AsyncFileLogger.cpp
+
+  Description: Implementation of class VmbCPP::AsyncFileLogger.
+
+-------------------------------------------------------------------------------
+
+  THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED
+  WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF TITLE,
+  NON-INFRINGEMENT, MERCHANTABILITY AND FITNESS FOR A PARTICULAR  PURPOSE ARE
+  DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+=============================================================================*/
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+
+#include <VmbCPP/AsyncFileLogger.h>
+#include <VmbCPP/FileLogger.h>
+#include <VmbCPP/MonotonicClock.h>
+
+
+namespace VmbCPP {
+
+namespace {
+
+// How long the writer sleeps when the ring is less than half full.
+const std::chrono::milliseconds FlushInterval( 100 );
+
+const char* LevelName( LogLevel level )
+{
+    switch( level )
+    {
+    case LogLevel::Trace:   return "TRACE";
+    case LogLevel::Debug:   return "DEBUG";
+    case LogLevel::Info:    return "INFO";
+    case LogLevel::Warning: return "WARNING";
+    case LogLevel::Error:   return "ERROR";
+    }
+    return "";
+}
+
+void AppendTime( std::string &batch, VmbUint64_t elapsedNs )
+{
+    char strTime[32];
+    int length = std::snprintf( strTime, sizeof( strTime ), "[%6" PRIu64 ".%06" PRIu64 "] ",
+                                static_cast<uint64_t>( elapsedNs / 1000000000ull ),
+                                static_cast<uint64_t>( elapsedNs % 1000000000ull / 1000ull ) );
+    batch.append( strTime, static_cast<std::size_t>( length ) );
+}
+
+}  // namespace
+
+AsyncFileLogger::AsyncFileLogger( const char *pFileName, bool bAppend, LogLevel level )
+    :   m_pSlots( new Slot[RingCapacity] )
+    ,   m_level( static_cast<int>( level ) )
+    ,   m_startTimeNs( GetMonotonicTimeNs() )
+{
+    static_assert( ( RingCapacity & ( RingCapacity - 1 ) ) == 0, "RingCapacity must be a power of two" );
+
+    std::string strTempPath = FileLogger::GetTemporaryDirectoryPath();
+    if( strTempPath.empty() )
+    {
+        throw std::runtime_error( "no temporary directory for the log file" );
+    }
+    std::string strFileName = strTempPath.append( pFileName );
+    if( true == bAppend )
+    {
+        m_File.open( strFileName.c_str(), std::fstream::app );
+    }
+    else
+    {
+        m_File.open( strFileName.c_str() );
+    }
+
+    for( std::size_t i = 0; i < RingCapacity; ++i )
+    {
+        m_pSlots[i].sequence.store( i, std::memory_order_relaxed );
+    }
+
+    if( m_File.is_open() )
+    {
+        // Maps the relative time stamps of this session to the wall clock.
+        time_t nTime = time( nullptr );
+        tm timeInfo;
+        #ifdef _WIN32
+            localtime_s( &timeInfo, &nTime );
+        #else
+            localtime_r( &nTime, &timeInfo );
+        #endif
+        char strTime[64];
+        std::strftime( strTime, sizeof( strTime ), "%Y-%m-%d %H:%M:%S", &timeInfo );
+        m_File << "[     0.000000] log started at " << strTime << std::endl;
+    }
+
+    m_writer = std::thread( &AsyncFileLogger::WriterLoop, this );
+}
+
+AsyncFileLogger::~AsyncFileLogger()
+{
+    {
+        std::lock_guard<std::mutex> guard( m_wakeMutex );
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_writer.join();
+    if( m_File.is_open() )
+    {
+        m_File.close();
+    }
+}
+
+void AsyncFileLogger::Log( const std::string &rStrMessage )
+{
+    Log( LogLevel::Info, rStrMessage );
+}
+
+void AsyncFileLogger::Log( LogLevel level, const std::string &rStrMessage )
+{
+    if( !IsEnabled( level ) )
+    {
+        return;
+    }
+
+    // Bounded multi producer queue: a producer claims a position by advancing m_enqueuePos,
+    // the slot's sequence tells whether the writer has released it.
+    Slot *pSlot = nullptr;
+    std::size_t pos = m_enqueuePos.load( std::memory_order_relaxed );
+    for( ;; )
+    {
+        pSlot = &m_pSlots[pos & ( RingCapacity - 1 )];
+        const std::size_t seq = pSlot->sequence.load( std::memory_order_acquire );
+        const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>( seq ) - static_cast<std::ptrdiff_t>( pos );
+        if( diff == 0 )
+        {
+            if( m_enqueuePos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+            {
+                break;
+            }
+        }
+        else if( diff < 0 )
+        {
+            m_dropped.fetch_add( 1, std::memory_order_relaxed );
+            m_wake.notify_one();
+            return;
+        }
+        else
+        {
+            pos = m_enqueuePos.load( std::memory_order_relaxed );
+        }
+    }
+
+    pSlot->timeNs = GetMonotonicTimeNs();
+    pSlot->level = level;
+    pSlot->length = static_cast<VmbUint32_t>( std::min( rStrMessage.size(), MaxMessageLength ) );
+    std::memcpy( pSlot->text, rStrMessage.data(), pSlot->length );
+    pSlot->sequence.store( pos + 1, std::memory_order_release );
+
+    // Otherwise the writer picks the message up within FlushInterval.
+    if( ( ( pos + 1 ) & ( RingCapacity / 2 - 1 ) ) == 0 )
+    {
+        m_wake.notify_one();
+    }
+}
+
+void AsyncFileLogger::WriterLoop()
+{
+    std::string batch;
+    batch.reserve( RingCapacity * 64 );
+    VmbUint64_t reportedDrops = 0;
+
+    for( ;; )
+    {
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock( m_wakeMutex );
+            // Woken early once the ring is half full or messages get dropped.
+            m_wake.wait_for( lock, FlushInterval, [this, &reportedDrops] {
+                return m_stop
+                    || m_enqueuePos.load( std::memory_order_relaxed ) - m_dequeuePos >= RingCapacity / 2
+                    || m_dropped.load( std::memory_order_relaxed ) != reportedDrops;
+            } );
+            stop = m_stop;
+        }
+        while( WriteBatch( batch, reportedDrops ) )
+        {
+        }
+        if( stop )
+        {
+            return;
+        }
+    }
+}
+
+bool AsyncFileLogger::WriteBatch( std::string &batch, VmbUint64_t &reportedDrops )
+{
+    batch.clear();
+    for( ;; )
+    {
+        Slot &rSlot = m_pSlots[m_dequeuePos & ( RingCapacity - 1 )];
+        if( rSlot.sequence.load( std::memory_order_acquire ) != m_dequeuePos + 1 )
+        {
+            break;
+        }
+        AppendTime( batch, rSlot.timeNs - m_startTimeNs );
+        batch.append( LevelName( rSlot.level ) );
+        batch.append( ": " );
+        batch.append( rSlot.text, rSlot.length );
+        batch.push_back( '\n' );
+        rSlot.sequence.store( m_dequeuePos + RingCapacity, std::memory_order_release );
+        ++m_dequeuePos;
+    }
+
+    const VmbUint64_t dropped = m_dropped.load( std::memory_order_relaxed );
+    if( dropped != reportedDrops )
+    {
+        AppendTime( batch, GetMonotonicTimeNs() - m_startTimeNs );
+        batch.append( "WARNING: " );
+        batch.append( std::to_string( dropped - reportedDrops ) );
+        batch.append( " messages dropped, log ring full\n" );
+        reportedDrops = dropped;
+    }
+
+    if( batch.empty() )
+    {
+        return false;
+    }
+    if( m_File.is_open() )
+    {
+        m_File.write( batch.data(), static_cast<std::streamsize>( batch.size() ) );
+        m_File.flush();
+    }
+    return true;
+}
+
+}  // namespace VmbCPP
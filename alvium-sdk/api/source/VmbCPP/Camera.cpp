@@ -750,7 +750,7 @@ VmbErrorType Camera::AcquireMultipleImages( FramePtr *pFrames, VmbUint32_t nSize
             {
                 std::stringstream strMsg;
                 strMsg << "Could only successfully fill " << 
-                    (nFrameCount > 0 ? nFrameCount - 1 : 0)  << " of " << nSize << " frames. Will stop acquisition now.";
+                    nFrameCount << " of " << nSize << " frames. Will stop acquisition now.";
                 LOG_FREE_TEXT( strMsg.str() );
                 break;
             }
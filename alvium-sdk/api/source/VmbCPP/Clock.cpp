@@ -26,21 +26,13 @@
 
 =============================================================================*/
 
-#ifdef _WIN32
-    #include <sys/timeb.h>
-    #include <windows.h>
-#else
-    #include <sys/time.h>
-    #include <unistd.h>
-#endif
-
 #include "Clock.h"
 
 
 namespace VmbCPP {
 
 Clock::Clock()
-    :   m_dStartTime(0.0)
+    :   m_nStartTimeNs( 0 )
 {
 }
 
@@ -50,99 +42,64 @@ Clock::~Clock()
 
 void Clock::Reset()
 {
-    m_dStartTime = 0.0;
+    m_nStartTimeNs = 0;
 }
 
 void Clock::SetStartTime()
 {
-    m_dStartTime = GetAbsTime();
+    m_nStartTimeNs = GetAbsTimeNs();
 }
 
 void Clock::SetStartTime( double dStartTime )
 {
-    m_dStartTime = dStartTime;
+    m_nStartTimeNs = dStartTime > 0.0 ? (VmbUint64_t)( dStartTime * 1000000000.0 ) : 0;
 }
 
 double Clock::GetTime() const
 {
-    double dTime = 0.0;
-
-#ifdef _WIN32
-    _timeb currSysTime;
-
-    _ftime_s(&currSysTime);
-
-    dTime = (currSysTime.time + ((double)currSysTime.millitm) / 1000.0);
-#else
-    timeval now;
-
-    if(gettimeofday(&now, (struct timezone *)0)) return 0.0;
-
-    dTime = ((double)now.tv_sec) + ((double)(now.tv_usec) / 1000000.0);
-#endif
-
-    return dTime - m_dStartTime;
+    // Subtract in integer nanoseconds; a double only holds the difference, not the absolute time, exactly.
+    const VmbUint64_t nNow = GetAbsTimeNs();
+    if ( nNow >= m_nStartTimeNs )
+    {
+        return (double)( nNow - m_nStartTimeNs ) / 1000000000.0;
+    }
+    return -(double)( m_nStartTimeNs - nNow ) / 1000000000.0;
 }
 
 double Clock::GetAbsTime()
 {
-    double dAbsTime = 0.0;
-
-#ifdef _WIN32
-    _timeb currSysTime;
-
-    _ftime_s(&currSysTime);
-
-    dAbsTime = (currSysTime.time + ((double)currSysTime.millitm) / 1000.0);
-#else
-    timeval now;
-
-    if(gettimeofday(&now, (struct timezone *)0)) return 0.0;
-
-    dAbsTime = ((double)now.tv_sec) + ((double)(now.tv_usec) / 1000000.0);
-#endif
+    return (double)GetAbsTimeNs() / 1000000000.0;
+}
 
-    return dAbsTime;
+VmbUint64_t Clock::GetAbsTimeNs()
+{
+    return GetMonotonicTimeNs();
 }
 
 void Clock::Sleep(double dTime)
 {
-#ifdef _WIN32
-    ::Sleep((unsigned long)(dTime * 1000.0));
-#else
-    ::usleep((unsigned long)(dTime * 1000000.0));
-#endif
+    if ( dTime > 0.0 )
+    {
+        SleepAbsNs( GetAbsTimeNs() + (VmbUint64_t)( dTime * 1000000000.0 ) );
+    }
 }
 
 void Clock::SleepMS(unsigned long nTimeMS)
 {
-#ifdef _WIN32
-    ::Sleep(nTimeMS);
-#else
-    ::usleep(nTimeMS * 1000);
-#endif
+    SleepAbsNs( GetAbsTimeNs() + (VmbUint64_t)nTimeMS * 1000000ull );
 }
 
 void Clock::SleepAbs(double dAbsTime)
 {
-    Clock clock;
-    double dTimeDiff = dAbsTime - clock.GetTime();
-        
-#ifdef _WIN32
-    if(dTimeDiff > 4000000.0) dTimeDiff = 4000000.0;
-#else
-    if(dTimeDiff >= 4000.0) dTimeDiff = 4000.0;
-#endif
-    while(dTimeDiff > 0.0)
+    if ( dAbsTime > 0.0 )
     {
-        Sleep(dTimeDiff);
-        dTimeDiff = dAbsTime - clock.GetTime();
-#ifdef _WIN32
-        if(dTimeDiff > 4000000.0) dTimeDiff = 4000000.0;
-#else
-        if(dTimeDiff >= 4000.0) dTimeDiff = 4000.0;
-#endif
+        SleepAbsNs( (VmbUint64_t)( dAbsTime * 1000000000.0 ) );
     }
 }
 
+void Clock::SleepAbsNs( VmbUint64_t nAbsTimeNs )
+{
+    SleepUntilMonotonicNs( nAbsTimeNs );
+}
+
 }  // namespace VmbCPP
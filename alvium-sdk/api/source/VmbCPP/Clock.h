@@ -34,8 +34,13 @@
 *
 * \brief     Definition of a platform independent Sleep.
 *            Intended for use in the implementation of VmbCPP.
+*
+* All times are taken from the monotonic clock in VmbCPP/MonotonicClock.h;
+* the double variants are seconds on that clock, kept for existing callers.
 */
 
+#include <VmbCPP/MonotonicClock.h>
+
 
 namespace VmbCPP {
 
@@ -51,13 +56,15 @@ class Clock final
     double GetTime() const;
 
     static double GetAbsTime();
+    static VmbUint64_t GetAbsTimeNs();
 
     static void Sleep( double dTime );
     static void SleepMS( unsigned long nTimeMS );
     static void SleepAbs( double dAbsTime );
+    static void SleepAbsNs( VmbUint64_t nAbsTimeNs );
 
   protected:
-    double m_dStartTime;
+    VmbUint64_t m_nStartTimeNs;
 };
 
 }  // namespace VmbCPP
@@ -88,7 +88,10 @@ void FileLogger::Log( const std::string &rStrMessage )
             asctime_s( strTime, 100, &timeInfo );
         #else
             time_t nTime = time( nullptr );
-            std::string strTime = asctime( localtime( &nTime ) );
+            tm timeInfo;
+            localtime_r( &nTime, &timeInfo );
+            char strTime[100];
+            asctime_r( &timeInfo, strTime );
         #endif
 
         m_File << strTime << ": " << rStrMessage << std::endl;
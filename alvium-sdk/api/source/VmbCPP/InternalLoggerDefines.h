@@ -36,30 +36,48 @@
 * \brief       Definition of internal logging macros
 */
 
+#ifndef VMBCPP_LOGGER_HAS_LEVELS
+// User loggers without levels log everything.
+#define LOGGER_ENABLED( logger, level ) true
+#define LOGGER_LOG_LEVEL( logger, level, info ) LOGGER_LOG( logger, info )
+#endif
+
 /**
  * \brief Macro for logging the provided text.
  *
- * The function using the macro is logged too.
+ * The function using the macro is logged too. The message is only built,
+ * if the logger accepts level Info.
  *
  * \note May throw std::bad_alloc, if there is insufficient memory to create
  * log message string.
  */
 #define LOG_FREE_TEXT( txt )                                                \
 {                                                                           \
-    std::string strExc( txt );                                              \
-    strExc.append( " in function: " );                                      \
-    strExc.append( __FUNCTION__ );                                          \
-    LOGGER_LOG(VmbSystem::GetInstance().GetLogger(), std::move(strExc));    \
+    Logger* pMacroLogger = VmbSystem::GetInstance().GetLogger();            \
+    if( LOGGER_ENABLED( pMacroLogger, LogLevel::Info ) )                    \
+    {                                                                       \
+        std::string strExc( txt );                                          \
+        strExc.append( " in function: " );                                  \
+        strExc.append( __FUNCTION__ );                                      \
+        LOGGER_LOG_LEVEL(pMacroLogger, LogLevel::Info, std::move(strExc));  \
+    }                                                                       \
 }
 
+/**
+ * \brief Macro for logging the provided text and error code with level Error.
+ */
 #define LOG_ERROR( txt, errCode )                                           \
 {                                                                           \
-    std::string strExc( txt );                                              \
-    strExc.append( " in function: " );                                      \
-    strExc.append( __FUNCTION__ );                                          \
-    strExc.append( ", VmbErrorType: ");                                            \
-    strExc.append( std::to_string(errCode) );                               \
-    LOGGER_LOG(VmbSystem::GetInstance().GetLogger(), std::move(strExc));    \
+    Logger* pMacroLogger = VmbSystem::GetInstance().GetLogger();            \
+    if( LOGGER_ENABLED( pMacroLogger, LogLevel::Error ) )                   \
+    {                                                                       \
+        std::string strExc( txt );                                          \
+        strExc.append( " in function: " );                                  \
+        strExc.append( __FUNCTION__ );                                      \
+        strExc.append( ", VmbErrorType: " );                                \
+        strExc.append( std::to_string(errCode) );                           \
+        LOGGER_LOG_LEVEL(pMacroLogger, LogLevel::Error, std::move(strExc)); \
+    }                                                                       \
 }
 
 #endif
@@ -0,0 +1,60 @@
+#ifndef AUTOEXPOSURE_H
+#define AUTOEXPOSURE_H
+
+#include "FrameStats.h"
+
+#include <string>
+
+// Target and loop tuning of the host-side auto-exposure controller.
+struct AutoExposureSettings {
+	enum class Target { Mean, Percentile };
+
+	Target target = Target::Mean;
+	double percentile = 0.5;	// Fraction (0 - 1) used when target is Percentile
+	double level = 118.0;		// Desired mean or percentile level (0 - 255)
+	double tolerance = 0.03;	// Relative error below which the exposure is left alone
+	double damping = 0.85;		// Exponent applied to the correction ratio (1 = jump straight to the estimate)
+	double maxStep = 4.0;		// Largest factor the exposure may change by in one update
+	int latencyFrames = 2;		// Frames to skip after a change until frames with the new exposure arrive
+	uint32_t sampleStep = 8;	// Histogram sampling step
+};
+
+// Parse "mean:<level>" or "p<percent>:<level>", e.g. "mean:118" or "p99:230". Throws std::invalid_argument.
+AutoExposureSettings ParseAutoExposureTarget(const std::string& spec);
+
+// Result of feeding one frame to the controller.
+struct AutoExposureStep {
+	bool changed = false;
+	double measured = 0.0;
+	double previous = 0.0;
+	double exposure = 0.0;
+};
+
+// Closed-loop exposure controller working on frame histograms. The caller applies changed exposures to the camera.
+class AutoExposure {
+	public:
+
+		AutoExposure(const AutoExposureSettings& settings, double minExposure, double maxExposure, double increment);
+
+		// Set the exposure currently programmed into the camera.
+		void reset(double exposure);
+
+		// Update the controller with the statistics of one frame.
+		AutoExposureStep update(const FrameStats& stats);
+
+		double exposure() const { return current; }
+		const AutoExposureSettings& settings() const { return cfg; }
+
+	private:
+		AutoExposureSettings cfg;
+		double minExposure;
+		double maxExposure;
+		double increment;
+		double current = 0.0;
+		int holdFrames = 0;
+
+		double measure(const FrameStats& stats) const;
+		double quantize(double exposure) const;
+};
+
+#endif
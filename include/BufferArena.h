@@ -0,0 +1,48 @@
+#ifndef BUFFERARENA_H
+#define BUFFERARENA_H
+
+#include <cstddef>
+#include <cstdint>
+
+// One mapping holding a fixed number of equally sized, aligned frame buffers.
+//
+// The mapping tries explicit hugepages (MAP_HUGETLB, of the size /proc/meminfo reports) first, then
+// transparent hugepages (MADV_HUGEPAGE), then plain pages. It is locked into RAM when the memlock limit allows it, and every page is touched up
+// front so that the first frames of a session do not pay for page faults.
+class BufferArena {
+	public:
+
+		// Throws std::runtime_error if the memory cannot be mapped.
+		BufferArena(std::size_t count, std::size_t bufferBytes, std::size_t alignment);
+		~BufferArena();
+
+		BufferArena(const BufferArena&) = delete;
+		BufferArena& operator=(const BufferArena&) = delete;
+
+		uint8_t* buffer(std::size_t index) const { return base + index * stride; }
+		std::size_t count() const { return buffers; }
+		std::size_t bufferBytes() const { return bytes; }
+
+		// True if the arena can serve count buffers of bufferBytes with the given alignment.
+		bool fits(std::size_t count, std::size_t bufferBytes, std::size_t alignment) const;
+
+		// "explicit hugepages", "transparent hugepages" or "4 KiB pages"
+		const char* backing() const;
+		bool locked() const { return isLocked; }
+		std::size_t mappedBytes() const { return length; }
+
+	private:
+		enum class Backing { Explicit, Transparent, Pages };
+
+		uint8_t* mapping = nullptr;
+		uint8_t* base = nullptr;	// First buffer, mapping rounded up to the alignment
+		std::size_t length = 0;
+		std::size_t buffers = 0;
+		std::size_t bytes = 0;
+		std::size_t stride = 0;
+		std::size_t align = 1;
+		Backing kind = Backing::Pages;
+		bool isLocked = false;
+};
+
+#endif
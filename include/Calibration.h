@@ -0,0 +1,55 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include "ImageView.h"
+#include "PixelFormat.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class CalibrationKind {
+	Dark,
+	Flat
+};
+
+// Flat-field gains are stored in unsigned Q4.12 fixed point (4096 = 1.0).
+constexpr uint32_t kFlatGainShift = 12;
+
+// Master calibration frame. Darks hold the stacked dark level per sample, flats the Q4.12 gain per sample.
+struct CalibrationMaster {
+	CalibrationKind kind = CalibrationKind::Dark;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t channels = 1;
+	VmbPixelFormatType format = VmbPixelFormatLast;
+	uint32_t frames = 0;
+	double exposure = 0.0;		// ExposureTime in us
+	std::vector<uint16_t> data;
+};
+
+const char* CalibrationKindName(CalibrationKind kind);
+
+// File name of a master for one ExposureTime/ROI combination, e.g. "dark_100000us_4128x3008+0+0.cal".
+std::string CalibrationFileName(CalibrationKind kind, double exposure, const Rect& roi);
+
+// Write a master to path. Throws std::runtime_error if the file cannot be written.
+void SaveCalibrationMaster(const std::string& path, const CalibrationMaster& master);
+
+// Read a master from path. Returns false if the file is missing or not a valid master.
+bool LoadCalibrationMaster(const std::string& path, CalibrationMaster& master);
+
+// Turn a stacked flat into per-sample Q4.12 gains that scale every sample to the mean of its colour plane.
+// dark may be null. Single-channel data is normalised per 2x2 Bayer phase so that the flat does not
+// alter the colour balance.
+void BuildFlatGain(const uint16_t* flat, const uint16_t* dark, uint32_t width, uint32_t height, uint32_t channels,
+		   uint16_t* gain);
+
+// out = min((in - dark) * gain >> 12, maxValue), in place. dark or gain may be null.
+void CorrectSamples16(uint16_t* samples, std::size_t count, const uint16_t* dark, const uint16_t* gain, uint16_t maxValue);
+
+// 8-bit variant of CorrectSamples16 writing to dst.
+void CorrectSamples8(const uint8_t* src, std::size_t count, const uint16_t* dark, const uint16_t* gain, uint8_t* dst);
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef CAMERAPROFILE_H
+#define CAMERAPROFILE_H
+
+#include "FeatureTable.h"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace VmbCPP {
+namespace Examples {
+
+// Value of one camera feature, as read from the camera or wanted in a profile.
+struct FeatureValue
+{
+    enum class Kind { Bool, Int, Float, Enum };
+
+    Kind kind = Kind::Int;
+    bool boolValue = false;
+    VmbInt64_t intValue = 0;
+    double floatValue = 0.0;
+    std::string enumValue;
+
+    // Floats match within a relative 1e-6, so a value the camera rounded is not written again.
+    bool Matches(const FeatureValue& other) const;
+    std::string ToString() const;
+};
+
+struct FeatureSetting
+{
+    HotFeature feature;
+    FeatureValue value;
+    bool required;      // A failed write aborts the profile and rolls back what was written
+};
+
+// The camera state the driver wants, one value per feature.
+class CameraProfile
+{
+public:
+    // A later value for the same feature replaces the earlier one.
+    void SetBool(HotFeature feature, bool value, bool required = false);
+    void SetInt(HotFeature feature, VmbInt64_t value, bool required = false);
+    void SetFloat(HotFeature feature, double value, bool required = false);
+    void SetEnum(HotFeature feature, const std::string& value, bool required = false);
+
+    const std::vector<FeatureSetting>& Settings() const { return m_settings; }
+    bool Empty() const { return m_settings.empty(); }
+
+    // The driver's features from an XML file written by PersistableFeatureContainer::SaveSettings(), all required.
+    // Other features in the file are ignored, as are features stored once per selector value (TriggerMode
+    // and TriggerSource on most cameras); the driver features skipped are appended to skipped with the reason.
+    // Throws std::runtime_error if the file cannot be read.
+    static CameraProfile FromSettingsFile(const std::string& path, std::vector<std::string>& skipped);
+
+private:
+    void Set(HotFeature feature, FeatureValue value, bool required);
+
+    std::vector<FeatureSetting> m_settings;
+};
+
+struct ProfileResult
+{
+    std::size_t written = 0;
+    std::size_t unchanged = 0;
+    std::size_t missing = 0;                        // Features the camera lacks, skipped like before
+    std::vector<std::string> failed;                // Optional features whose write failed
+    HotFeature abortedAt = HotFeature::Count;       // Required feature whose write failed, Count if none
+    VmbErrorType err = VmbErrorSuccess;
+    std::chrono::microseconds elapsed{0};
+};
+
+// Bring the camera to profile with as few feature writes as possible.
+//
+// Selectors (TriggerSelector) are brought to their value first, since the features they select are read
+// through them. Every other feature in the profile is then read once, and only the ones that differ are
+// written, in dependency order: PixelFormat, the ROI (offsets before sizes when the window moves left or up,
+// after them otherwise), modes and autos, ExposureTime and Gain, and the frame rate last, since its limits
+// follow from the ROI and the exposure. If a required write fails, the features already written are set
+// back to the values read and the result names the feature.
+ProfileResult ApplyProfile(const FeatureTable& features, const CameraProfile& profile);
+
+}} // namespace VmbCPP
+
+#endif
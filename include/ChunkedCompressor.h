@@ -0,0 +1,92 @@
+#ifndef CHUNKEDCOMPRESSOR_H
+#define CHUNKEDCOMPRESSOR_H
+
+#include "ThreadPool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class CompressionCodec {
+	None = 0,
+	Zstd = 1,
+	Lz4 = 2
+};
+
+// Parse "zstd" or "lz4". Throws std::invalid_argument on anything else.
+CompressionCodec ParseCompressionCodec(const std::string& name);
+
+const char* CompressionCodecName(CompressionCodec codec);
+
+// True if the codec was found when the driver was built.
+bool CompressionCodecAvailable(CompressionCodec codec);
+
+// Frame description stored in the header of a .rawz file.
+struct RawzInfo {
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t channels = 1;
+	uint32_t bitDepth = 8;
+	std::string format;		// Storage format, e.g. "Mono12p" (see StorageFormatName)
+	uint32_t chunkRows = 0;
+	uint64_t frameId = 0;
+};
+
+// Compresses a frame as independent chunks of rows on a thread pool and writes them to a .rawz file.
+//
+// File layout (little endian):
+//   0   char[8]  "ALVRAWZ1"
+//   8   u32      codec (1 = zstd, 2 = lz4)
+//   12  u32      width
+//   16  u32      height
+//   20  u32      channels
+//   24  u32      bit depth
+//   28  u32      rows per chunk
+//   32  u32      chunk count
+//   36  u32      reserved
+//   40  u64      frame id
+//   48  char[16] storage format name, NUL padded
+//   64  chunk table: chunk count x { u64 file offset, u32 compressed bytes, u32 raw bytes }
+//   ... chunk data
+//
+// Each chunk decompresses on its own into rawBytes of the storage format, so readers can decompress in
+// parallel or only the chunks covering a sub-ROI.
+class ChunkedCompressor {
+	public:
+
+		// level is the zstd level or the lz4 acceleration factor. numThreads 0 uses every core.
+		ChunkedCompressor(CompressionCodec codec, int level, std::size_t numThreads = 0);
+		~ChunkedCompressor();
+
+		ChunkedCompressor(const ChunkedCompressor&) = delete;
+		ChunkedCompressor& operator=(const ChunkedCompressor&) = delete;
+
+		// Compress bytes of data in chunks of chunkBytes. Returns the total compressed size, 0 on failure.
+		std::size_t compress(const uint8_t* data, std::size_t bytes, std::size_t chunkBytes);
+
+		// Write the last compressed frame to path, and the CRC-32 of the file to crc if it is not null. Returns
+		// false if the file could not be written.
+		bool write(const std::string& path, const RawzInfo& info, uint32_t* crc = nullptr) const;
+
+		CompressionCodec codec() const { return method; }
+
+	private:
+		struct Chunk {
+			std::vector<uint8_t> data;
+			std::size_t compressedBytes = 0;
+			std::size_t rawBytes = 0;
+		};
+
+		CompressionCodec method;
+		int level;
+		ThreadPool pool;
+		std::vector<Chunk> chunks;
+		std::size_t chunkCount = 0;
+		std::vector<void*> contexts;	// One zstd context per chunk slot
+
+		bool compressChunk(std::size_t index, const uint8_t* src, std::size_t bytes);
+};
+
+#endif
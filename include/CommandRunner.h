@@ -0,0 +1,52 @@
+#ifndef COMMANDRUNNER_H
+#define COMMANDRUNNER_H
+
+#include "FeatureTable.h"
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace VmbCPP {
+namespace Examples {
+
+// Runs command features and waits, with a deadline, until the module reports them done.
+//
+// After the run, VmbFeatureCommandIsDone is checked at once and then after sleeps that double from 10 us to
+// 2 ms, so a command that completes immediately (TriggerSoftware, AcquisitionStart on most cameras) costs one
+// extra feature read, and one that takes a second (GVSPAdjustPacketSize) costs a few hundred wake-ups instead
+// of a busy core. The time from run to done is recorded per command name.
+class CommandRunner
+{
+public:
+    // Run the command name on handle (a camera, stream or interface) and wait up to timeout for it to complete.
+    // Returns VmbErrorTimeout if it did not.
+    VmbErrorType Execute(VmbHandle_t handle, const char* name, std::chrono::microseconds timeout);
+
+    // VmbErrorNotFound, not recorded, if the camera lacks the feature.
+    VmbErrorType Execute(const FeatureTable& features, HotFeature feature, std::chrono::microseconds timeout);
+
+    // One line per command run so far: runs, p50, p99 and max time to done, timeouts and failures.
+    std::vector<std::string> Report() const;
+
+private:
+    struct Stats
+    {
+        uint64_t runs = 0;
+        uint64_t timeouts = 0;
+        uint64_t failures = 0;
+        std::vector<uint32_t> latencyUs;    // Completed runs, the first 4096
+    };
+
+    void Record(const char* name, VmbErrorType err, uint32_t us);
+
+    mutable std::mutex m_mutex;
+    std::map<std::string, Stats> m_stats;
+};
+
+}} // namespace VmbCPP
+
+#endif
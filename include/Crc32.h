@@ -0,0 +1,15 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32 (IEEE, as zlib's crc32()) of bytes, continuing from crc, the CRC of the data before them (0 to
+// start). Slicing by 8, so a whole frame costs a few milliseconds.
+uint32_t Crc32(const void* data, std::size_t bytes, uint32_t crc = 0);
+
+// CRC-32 of everything from fd's current offset to the end of the file, and its length. Returns false if
+// the file cannot be read.
+bool FileCrc32(int fd, uint32_t& crc, uint64_t& bytes);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef DIRECTCAPTURE_H
+#define DIRECTCAPTURE_H
+
+#include "BufferArena.h"
+#include "FrameDescriptorRing.h"
+
+#include <VmbC/VmbC.h>
+#include <VmbCPP/VmbCPP.h>
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace VmbCPP {
+namespace Examples {
+
+// Frame delivery through the VmbC frame-done callback, bypassing VmbCPP's Frame/FrameHandler/IFrameObserver.
+//
+// VmbCPP's FrameHandler::FrameDoneCallback locks the handler's mutex, copies FramePtrs and makes a virtual
+// FrameReceived() call before the driver gets to queue the frame. Here the arena buffers are announced as plain
+// VmbFrame_t, and the callback copies the frame's descriptor into the ring and returns. The consumer owns the
+// buffer until it calls Requeue(), so a frame is never overwritten while it is being written out. Incomplete
+// frames are requeued from the callback and counted.
+class DirectCapture
+{
+public:
+    // Announce the first buffers of arena, each payloadSize bytes, on the opened camera. Throws std::runtime_error.
+    DirectCapture(const CameraPtr& camera, const BufferArena& arena, std::size_t buffers, std::size_t payloadSize, FrameDescriptorRing& ring);
+
+    // Stop()s capture and revokes the frames.
+    ~DirectCapture();
+
+    DirectCapture(const DirectCapture&) = delete;
+    DirectCapture& operator=(const DirectCapture&) = delete;
+
+    // Start the capture engine and queue every buffer. AcquisitionStart is left to the caller.
+    VmbErrorType Start();
+
+    // Hand the buffer of a popped descriptor back to the camera.
+    VmbErrorType Requeue(const FrameDescriptor& frame);
+
+    // End capture and flush the queue; descriptors still in the ring refer to buffers that are no longer queued.
+    void Stop();
+
+    uint64_t incomplete() const { return m_incomplete.load(std::memory_order_relaxed); }
+
+private:
+    static void VMB_CALL FrameDone(const VmbHandle_t cameraHandle, const VmbHandle_t streamHandle, VmbFrame_t* frame);
+
+    VmbHandle_t m_handle;
+    std::vector<VmbFrame_t> m_frames;
+    FrameDescriptorRing& m_ring;
+    std::atomic<bool> m_capturing{false};
+    std::atomic<uint64_t> m_incomplete{0};
+};
+
+}} // namespace VmbCPP
+
+#endif
@@ -7,12 +7,31 @@
 #define DRIVER_H
 
 #include "Logger.h"
+#include "FocusMetrics.h"
+#include "FrameStats.h"
+#include "PreviewTap.h"
+#include "AutoExposure.h"
+#include "FrameWriter.h"
+#include "StripedWriter.h"
+#include "VideoRecorder.h"
+#include "Calibration.h"
+#include "Stacking.h"
+#include "FrameRing.h"
+#include "FrameRecordStore.h"
+#include "BufferArena.h"
+#include "FeatureTable.h"
+#include "CameraProfile.h"
+#include "CommandRunner.h"
+#include "DirectCapture.h"
+#include "FrameDescriptorRing.h"
 #include <VmbCPP/VmbCPP.h>
 #include <memory>
 #include <thread>
 #include <queue>
 #include <condition_variable>
 #include <atomic>
+#include <fstream>
+#include <chrono>
 
 namespace VmbCPP {
 namespace Examples {
@@ -28,13 +47,19 @@ struct ROI {
 class FrameQueue
 {
     private:
-        std::queue<FramePtr> q;
+        struct Entry {
+            FramePtr frame;
+            int64_t receivedNs;     // Host receive time in ns since the epoch
+            int64_t deliveredNs;    // steady_clock ns at push(), for latency tracing
+        };
+        std::queue<Entry> q;
         std::mutex mtx;
         std::condition_variable cv;
     public:
         void push(const FramePtr& f);
 
-        FramePtr pop();
+        // Wait for the next frame; also returns when it was pushed and how many frames are still queued.
+        FramePtr pop(int64_t& receivedNs, int64_t& deliveredNs, std::size_t& depth);
 }; 
 
 		
@@ -44,6 +69,8 @@ class Driver
 private:
     VmbSystem&  m_vmbSystem;
     CameraPtr   m_camera;
+    FeatureTable m_features;
+    CommandRunner m_commands;
 
     std::string cameraId;
     std::string m_saveDir;
@@ -56,41 +83,334 @@ private:
     int		m_coreid;
     ROI     m_roi;
     std::shared_ptr<FrameQueue> m_queue;
+    std::unique_ptr<BufferArena> m_arena;
+    FramePtrVector m_frames;
+    IFrameObserverPtr m_observer;
+    bool    m_directDelivery = false;
+    std::unique_ptr<FrameDescriptorRing> m_descriptors;
+    std::unique_ptr<DirectCapture> m_direct;
+    std::vector<uint32_t> m_deliveryUs;     // Delivery-to-worker latency of the first frames of the session
     std::thread m_workerThread;
     std::atomic<bool> m_running;
+    std::unique_ptr<FocusScorer> m_focusScorer;
+    FocusMetric m_focusMetric = FocusMetric::LaplacianVariance;
+    double  m_bestFocus = -1.0;
+    uint64_t m_bestFocusFrame = 0;
+    bool    m_statsEnabled = false;
+    FrameStatsSettings m_statsSettings;
+    std::unique_ptr<PreviewTap> m_preview;
+    int     m_previewEvery = 1;
+    std::unique_ptr<AutoExposure> m_autoExposure;
+    std::unique_ptr<FrameWriter> m_writer;
+    std::unique_ptr<StripedWriter> m_striped;
+    std::unique_ptr<SessionJournal> m_journal;
+    std::unique_ptr<VideoRecorder> m_video;
+    bool    m_videoEnabled = false;
+    VideoSettings m_videoSettings;
+    std::chrono::milliseconds m_journalInterval{100};
+    std::vector<std::string> m_stripeDirs;
+    StripePolicy m_stripePolicy = StripePolicy::RoundRobin;
+    std::string m_imageFormat = "png";
+    bool    m_tiffDeflate = false;
+    FrameMetadata m_frameMetadata;
+    uint64_t m_tickFrequency = 1000000000ull;
+    std::unique_ptr<FrameRecordStore> m_records;
+    std::unique_ptr<FrameRing> m_ring;
+    std::thread m_flushThread;
+    std::chrono::duration<double> m_preEvent{0.0};
+    std::chrono::duration<double> m_postEvent{0.0};
+    std::atomic<uint64_t> m_events{0};
+    FeaturePtr m_lineEventFeature;
+    IFeatureObserverPtr m_lineEventObserver;
+    std::vector<uint16_t> m_analysisUnpacked;
+    std::vector<uint8_t> m_analysisScratch;
+    std::unique_ptr<ThreadPool> m_stackPool;
+    std::unique_ptr<FrameStacker> m_calibrationStacker;
+    CalibrationMaster m_calibrationMaster;
+    std::string m_calibrationPath;
+    std::atomic<bool> m_calibrationDone{false};
+    std::vector<uint16_t> m_calibrationSamples;
+    bool    m_correction = false;
+    bool    m_correctionMismatch = false;
+    CalibrationMaster m_dark;
+    CalibrationMaster m_flat;
+    std::vector<uint16_t> m_correctedSamples;
+    std::vector<uint8_t> m_corrected8;
+    std::unique_ptr<FrameStacker> m_stacker;
+    uint64_t m_stackedFrames = 0;
+    std::vector<uint16_t> m_stackSamples;
+    std::vector<uint16_t> m_stacked;
+    std::vector<uint8_t> m_stacked8;
+    CompressionCodec m_compression = CompressionCodec::None;
+    int     m_compressionLevel = 1;
+    uint32_t m_chunkRows = 64;
+    std::size_t m_dirtyBudget = 64u << 20;
+    std::chrono::steady_clock::time_point m_startupBegin;  // Start of the constructor, for the startup-to-first-frame time
+    std::chrono::steady_clock::time_point m_phaseMark;
+    std::vector<std::pair<const char*, double>> m_startupPhases;   // Name and ms of each startup phase
+    bool    m_startupLogged = false;
 
-	// Configure trigger settings if --mode "trigger" is selected.
-    void ConfigureTriggerMode();
+	// Add the trigger settings to the profile if --mode "trigger" is selected.
+    void ConfigureTriggerMode(CameraProfile& profile);
 
-	// Configure fixed frame rate settings if --mode "fixed" is selected.
-    void ConfigureFixedFrameRate();
+	// Add the fixed frame rate settings to the profile if --mode "fixed" is selected.
+    void ConfigureFixedFrameRate(CameraProfile& profile);
 
-	// Set custom and fixed exposure time if --mode "exposure" is selected. Set exposure time with --exposure, otherwise default 100000 us is used.
-    void ConfigureExposureMode();
+	// Add a custom and fixed exposure time to the profile if --mode "exposure" is selected. Set exposure time with --exposure, otherwise default 100000 us is used.
+    void ConfigureExposureMode(CameraProfile& profile);
+
+	// Add the free-running settings to the profile if --mode "burst" is selected.
+    void ConfigureBurstMode(CameraProfile& profile);
 
 	// Configure CPU for core locking based on input argument --core.
     void SetCpuAffinity();
 
-    void SetROI();
+    void SetROI(CameraProfile& profile);
+
+    // Write the features of profile that differ from the camera; throws if a required one cannot be set.
+    void ApplyConfiguration(const CameraProfile& profile, const std::string& what);
+
+    // FrameWriter for dir with the configured format, compression and dirty budget.
+    std::unique_ptr<FrameWriter> CreateWriter(const std::string& dir);
+
+    // Hand a frame to the striped writer if there is one, otherwise write it; returns the path written, if known.
+    std::string WriteFrame(const uint8_t* buffer, VmbUint32_t bufferSize, const PixelLayout& layout, VmbUint32_t width, VmbUint32_t height, uint64_t frameCounter, const FrameMetadata& meta);
+
+    // Announce the frame buffers from the driver's arena, (re)allocating it if the payload no longer fits.
+    void AnnounceFrames();
+
+    // End capture, revoke the announced frames and drop their observers.
+    void RevokeFrames();
+
+    // Everything the worker does with one frame, from metadata to analysis.
+    void HandleFrame(const FrameDescriptor& frame, std::size_t queueDepth, uint64_t frameCounter);
+
+    // Close the current startup phase; LogStartupPhases() prints them once the first frame is in.
+    void MarkStartupPhase(const char* name);
+    void LogStartupPhases();
+
+    // Log the percentiles of m_deliveryUs.
+    void LogDeliveryLatency();
+
+    // Write the frames marked by black-box events to disk.
+    void FlushLoop();
+
+    // Read the exposure and gain recorded with every frame.
+    void ReadFrameMetadata();
+
+    // ExposureTime and ROI currently set on the camera (the camera may have rounded the requested ROI), and the
+    // master file for them.
+    double CurrentExposure();
+    Rect CurrentRoi();
+    std::string CalibrationPath(const std::string& directory, CalibrationKind kind, double exposure, const Rect& roi) const;
+
+    // Throw if a median or sigma-clipped stack of frames frames of the current ROI and pixel format would hold
+    // more than half the physical memory.
+    void CheckStackMemory(StackMethod method, size_t frames, const Rect& roi);
+
+    // Add a frame to the master being captured and save the master once enough frames are stacked.
+    void AddCalibrationFrame(const uint8_t* buffer, const PixelLayout& layout, uint32_t width, uint32_t height);
+
+    // Apply the loaded dark/flat masters. Returns the corrected buffer and updates layout and bufferSize to match it.
+    const uint8_t* CorrectFrame(const uint8_t* buffer, PixelLayout& layout, uint32_t width, uint32_t height, VmbUint32_t& bufferSize);
+
+    // Accumulate a frame into the running stack. Returns the stacked frame once K frames are in, otherwise null;
+    // layout and bufferSize are updated to describe the returned buffer.
+    const uint8_t* StackFrame(const uint8_t* buffer, PixelLayout& layout, uint32_t width, uint32_t height, VmbUint32_t& bufferSize);
+
+    // Score the focus of a saved frame and print the running best score.
+    void ScoreFocus(const ImageView& img, uint64_t frameCounter);
+
+    // Store a frame's decimated quality statistics in its frames.meta record.
+    void RecordFrameStats(const FrameStats& stats, std::chrono::microseconds elapsed, FrameRecord& record);
+
+    // Feed a frame's histogram to the auto-exposure controller and apply its correction.
+    void UpdateAutoExposure(const FrameStats& stats, uint64_t frameCounter);
 
 public:
     /**
      * \brief The constructor will initialize the API and open the given camera
      *
-     * \param[in] pCameraId  zero terminated C string with the camera id for the camera to be used
+     * \param[in] pCameraId         zero terminated C string with the camera id or serial number of the camera to be used;
+     *                              null opens the first camera found after enumerating all of them
+     * \param[in] transportLayers   .cti files or directories to load (':' separated); null loads the configured ones
      */
-    Driver(const char* cameraId, const std::string& saveDirectory, std::shared_ptr<::Logger> logger, int frameRate, const std::string& mode, int exposureTime, bool processing, bool timing, int core_id, const ROI& roi);
+    Driver(const char* cameraId, const std::string& saveDirectory, std::shared_ptr<::Logger> logger, int frameRate, const std::string& mode, int exposureTime, bool processing, bool timing, int core_id, const ROI& roi, const char* transportLayers = nullptr);
 
     /**
      * \brief The destructor will stop the acquisition and shutdown the API
      */
     ~Driver();
 
+    /**
+     * \brief Select the camera pixel format (e.g. "RGB8", "Mono12", "Mono12p").
+     */
+    void SetPixelFormat(const std::string& pixelFormat);
+
+    /**
+     * \brief Bring the camera to the driver's features saved in a settings file; only differing features are written.
+     *
+     * \param[in] path  XML file written by SaveProfile() or the Vimba tools
+     */
+    void LoadProfile(const std::string& path);
+
+    /**
+     * \brief Save the camera's features with PersistableFeatureContainer::SaveSettings() for LoadProfile().
+     */
+    void SaveProfile(const std::string& path);
+
+    /**
+     * \brief Select the image file format written with --processing ("png", "tiff" or "dng"). Must be called before Start().
+     *
+     * \param[in] imageFormat  file format
+     * \param[in] deflate      compress TIFF/DNG strips with Deflate and the horizontal predictor
+     */
+    void SetImageFormat(const std::string& imageFormat, bool deflate = false);
+
+    /**
+     * \brief Score every frame for manual focusing. Must be called before Start().
+     *
+     * \param[in] roi     region of the frame to score (empty = full frame)
+     * \param[in] metric  metric used to track the best frame
+     */
+    void EnableFocusScoring(const Rect& roi, FocusMetric metric);
+
+    /**
+     * \brief Record per-frame quality statistics in frames.meta. Must be called before Start().
+     *
+     * \param[in] settings  sampling step and black/saturation levels
+     */
+    void EnableFrameStats(const FrameStatsSettings& settings);
+
+    /**
+     * \brief Publish a downsampled copy of every Nth frame to shared memory for a live viewer. Must be called before Start().
+     *
+     * \param[in] everyN  publish one frame out of everyN
+     * \param[in] scale   box-downsampling factor (e.g. 8 for 1/8 scale)
+     */
+    void EnablePreview(int everyN, uint32_t scale);
+
+    /**
+     * \brief Run the host-side auto-exposure loop on incoming frames. Must be called before Start().
+     *
+     * \param[in] settings  target level and loop tuning
+     */
+    void EnableAutoExposure(const AutoExposureSettings& settings);
+
+    /**
+     * \brief Capture a master dark or flat instead of saving frames. Must be called before Start(). The master is
+     * keyed by the ROI read back from the camera. Throws std::runtime_error if a median stack would not fit in memory.
+     *
+     * \param[in] kind       master to build (flats use the dark for the same exposure and ROI if present)
+     * \param[in] frames     number of frames to stack
+     * \param[in] method     mean or median stacking
+     * \param[in] directory  calibration directory the master is saved to
+     */
+    void EnableCalibrationCapture(CalibrationKind kind, size_t frames, StackMethod method, const std::string& directory);
+
+    /**
+     * \brief True once the master requested with EnableCalibrationCapture() has been saved.
+     */
+    bool CalibrationDone() const { return m_calibrationDone; }
+
+    /**
+     * \brief Subtract the master dark and divide by the master flat saved for the current exposure and ROI
+     * before frames are written. Must be called before Start().
+     *
+     * \param[in] directory  calibration directory holding the masters
+     */
+    void EnableCorrection(const std::string& directory);
+
+    /**
+     * \brief Save one stacked frame per K received frames instead of every frame. Must be called before Start().
+     * Stacks of 8-bit frames are saved in the matching 16-bit format as 8.8 fixed point. Throws
+     * std::runtime_error if a median or sigma-clipped stack would not fit in memory.
+     *
+     * \param[in] frames  number of consecutive frames per stack (K)
+     * \param[in] method  running mean, median or sigma-clipped mean
+     * \param[in] kappa   clipping threshold in standard deviations for the sigma-clipped mean
+     */
+    void EnableStacking(size_t frames, StackMethod method, double kappa);
+
+    /**
+     * \brief Compress raw frames in parallel row chunks into .rawz files. Must be called before Start().
+     *
+     * \param[in] codec      zstd or lz4 (must have been found at build time)
+     * \param[in] level      zstd level or lz4 acceleration
+     * \param[in] chunkRows  rows per independently compressed chunk
+     */
+    void EnableCompression(CompressionCodec codec, int level, uint32_t chunkRows);
+
+    /**
+     * \brief Stripe frames over several directories, each written by its own thread. Must be called before Start().
+     *
+     * \param[in] directories  output directories, usually on different disks; the session index goes to the save directory
+     * \param[in] policy       round-robin or by measured per-target bandwidth
+     */
+    void SetStripeTargets(const std::vector<std::string>& directories, StripePolicy policy);
+
+    /**
+     * \brief Encode frames into segmented video files instead of writing images. Must be called before Start().
+     *
+     * \param[in] settings  codec, quality/bitrate, segment length and encoder threads; the frame rate is taken from the driver
+     */
+    void EnableVideo(const VideoSettings& settings);
+
+    /**
+     * \brief Record every written frame in session.journal once its file is synced; committed with fdatasync() once per interval. Must be called before Start().
+     *
+     * \param[in] interval  commit interval; 0 disables the journal
+     */
+    void SetJournalInterval(std::chrono::milliseconds interval);
+
+    /**
+     * \brief Deliver frames from the VmbC frame-done callback through a lock-free ring instead of VmbCPP frame observers.
+     *        Needs the driver's frame arena; falls back to observers without it. Must be called before Start().
+     */
+    void EnableDirectDelivery();
+
+    /**
+     * \brief Limit how much written raw frame data may wait in the page cache. Must be called before Start().
+     *
+     * \param[in] budgetBytes  dirty bytes allowed before the writer waits for older frames; 0 leaves writeback to the kernel
+     */
+    void SetDirtyBudget(std::size_t budgetBytes);
+
+    /**
+     * \brief Keep frames in a RAM ring and only write the windows around events (TriggerEvent()). Must be called before Start().
+     *
+     * \param[in] preSeconds     seconds kept before an event
+     * \param[in] postSeconds    seconds recorded after an event
+     * \param[in] ringMegabytes  memory reserved for the ring
+     */
+    void EnableBlackbox(double preSeconds, double postSeconds, size_t ringMegabytes);
+
+    /**
+     * \brief Also raise black-box events on rising edges of a camera I/O line (e.g. "Line0").
+     */
+    void EnableLineEvent(const std::string& line);
+
+    /**
+     * \brief Flush the pre-event window and record the post-event window in the background.
+     */
+    void TriggerEvent();
+
     /**
      * \brief Start the acquisition.
      */
     void Start();
 
+    /**
+     * \brief Capture a burst of frames at the highest rate the camera allows, then write them all to disk.
+     *
+     * Every frame gets its own preallocated buffer, announced before the burst starts, so the burst costs
+     * frames x PayloadSize bytes of memory. Nothing is written until the last frame is in; the frames are
+     * then drained by up to four writer threads. Used instead of Start() with --mode burst.
+     *
+     * \param[in] frames  number of frames in the burst; raised to the stream's StreamAnnounceBufferMinimum if below it
+     */
+    void CaptureBurst(size_t frames);
+
 	// Start the triggered acquisition loop.
 	void TriggerFrame();
 
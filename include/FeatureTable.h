@@ -0,0 +1,85 @@
+#ifndef FEATURETABLE_H
+#define FEATURETABLE_H
+
+#include <VmbCPP/VmbCPP.h>
+
+#include <array>
+#include <cstddef>
+
+namespace VmbCPP {
+namespace Examples {
+
+// Camera features the driver reads or writes.
+enum class HotFeature {
+    TriggerSoftware,
+    TriggerSelector,
+    TriggerMode,
+    TriggerSource,
+    AcquisitionMode,
+    AcquisitionStart,
+    AcquisitionStop,
+    AcquisitionFrameRateEnable,
+    AcquisitionFrameRate,
+    ExposureMode,
+    ExposureAuto,
+    ExposureTime,
+    GainAuto,
+    Gain,
+    GammaEnable,
+    Width,
+    Height,
+    OffsetX,
+    OffsetY,
+    PayloadSize,
+    PixelFormat,
+    TimestampLatch,
+    TimestampLatchValue,
+    Count
+};
+
+const char* HotFeatureName(HotFeature feature);
+
+// The driver's features, looked up once after the camera is opened.
+//
+// FeatureContainer::GetFeatureByName builds a std::string and searches a std::map on every call, then hands
+// back a FeaturePtr copy; doing that per trigger or per auto-exposure step adds up. Resolve() does the lookups
+// once and records which features the camera has. The accessors below go straight to the VmbC feature calls on
+// the camera handle with a static name, and return VmbErrorNotFound for a feature the camera lacks, so callers
+// that ignored a missing feature before can keep ignoring the result. Get() gives the FeaturePtr for the rest
+// of the VmbCPP API (ranges, increments).
+class FeatureTable
+{
+public:
+    // Look up every HotFeature on camera, which must be open. Features the camera lacks are left empty.
+    void Resolve(const CameraPtr& camera);
+
+    bool Has(HotFeature feature) const { return static_cast<bool>(m_features[Index(feature)]); }
+
+    // Null if the camera lacks the feature.
+    const FeaturePtr& Get(HotFeature feature) const { return m_features[Index(feature)]; }
+
+    // The camera handle the features are accessed through, for VmbC calls such as the command waits in CommandRunner.
+    VmbHandle_t Handle() const { return m_handle; }
+
+    VmbErrorType RunCommand(HotFeature feature) const;
+    VmbErrorType IsCommandDone(HotFeature feature, bool& done) const;
+    VmbErrorType GetFloat(HotFeature feature, double& value) const;
+    VmbErrorType SetFloat(HotFeature feature, double value) const;
+    VmbErrorType GetInt(HotFeature feature, VmbInt64_t& value) const;
+    VmbErrorType SetInt(HotFeature feature, VmbInt64_t value) const;
+    VmbErrorType GetBool(HotFeature feature, bool& value) const;
+    VmbErrorType SetBool(HotFeature feature, bool value) const;
+    // value points to a string owned by the SDK that stays valid while the camera is open.
+    VmbErrorType GetEnum(HotFeature feature, const char*& value) const;
+    VmbErrorType SetEnum(HotFeature feature, const char* value) const;
+
+private:
+    static constexpr std::size_t Index(HotFeature feature) { return static_cast<std::size_t>(feature); }
+
+    VmbHandle_t m_handle = nullptr;
+    std::array<FeaturePtr, static_cast<std::size_t>(HotFeature::Count)> m_features;
+};
+
+}} // namespace VmbCPP
+
+#endif
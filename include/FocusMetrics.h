@@ -0,0 +1,50 @@
+#ifndef FOCUSMETRICS_H
+#define FOCUSMETRICS_H
+
+#include "ImageView.h"
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Sharpness scores of one frame. Larger is sharper for all three metrics.
+struct FocusScores {
+	double laplacianVariance = 0.0;		// Variance of the 4-neighbour Laplacian
+	double tenengrad = 0.0;			// Mean squared 3x3 Sobel gradient magnitude
+	double normalizedGradientEnergy = 0.0;	// Mean squared first difference, divided by mean luma squared
+	double meanLuma = 0.0;
+};
+
+enum class FocusMetric {
+	LaplacianVariance,
+	Tenengrad,
+	NormalizedGradientEnergy
+};
+
+// Parse "laplacian", "tenengrad" or "nge". Throws std::invalid_argument on anything else.
+FocusMetric ParseFocusMetric(const std::string& name);
+
+// Short name of a metric as accepted by ParseFocusMetric.
+const char* FocusMetricName(FocusMetric metric);
+
+// Pick the score belonging to metric.
+double FocusScore(const FocusScores& scores, FocusMetric metric);
+
+// Computes FocusScores on a region of interest, split into row bands across a thread pool.
+class FocusScorer {
+	public:
+
+		// roi selects the scored region (empty = full frame). numThreads = 0 uses all cores.
+		FocusScorer(const Rect& roi, std::size_t numThreads);
+
+		// Score one image. Images smaller than 3x3 inside the ROI score zero.
+		FocusScores score(const ImageView& img);
+
+	private:
+		Rect roi;
+		ThreadPool pool;
+		std::vector<std::vector<uint8_t>> scratch;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef FRAMEDESCRIPTORRING_H
+#define FRAMEDESCRIPTORRING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// What the capture callback knows about a completed frame; the pixels stay in the announced buffer.
+struct FrameDescriptor {
+	uint8_t* buffer = nullptr;
+	uint32_t bufferSize = 0;
+	uint32_t index = 0;		// Announced buffer the frame was captured into
+	uint64_t frameId = 0;
+	uint64_t timestamp = 0;		// Device ticks
+	uint32_t pixelFormat = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t offsetX = 0;
+	uint32_t offsetY = 0;
+	int32_t status = 0;
+	int64_t receivedNs = 0;		// Host time since the epoch, for frames.meta
+	int64_t deliveredNs = 0;	// steady_clock time the frame reached the driver, for latency tracing
+};
+
+// Single-producer, single-consumer ring of frame descriptors.
+//
+// push() never blocks or takes a lock: it copies the descriptor into the next slot and publishes it with one
+// release store, so it is safe to call from the SDK's frame-done callback. pop() spins briefly and then sleeps
+// on a futex; push() only makes the wake-up system call when the consumer is actually asleep.
+class FrameDescriptorRing {
+	public:
+
+		// capacity is rounded up to a power of two.
+		explicit FrameDescriptorRing(std::size_t capacity);
+
+		FrameDescriptorRing(const FrameDescriptorRing&) = delete;
+		FrameDescriptorRing& operator=(const FrameDescriptorRing&) = delete;
+
+		// Producer side. False if the ring is full; the descriptor is then counted as dropped.
+		bool push(const FrameDescriptor& frame);
+
+		// Consumer side. False if nothing arrived within timeout or the ring is closed and empty.
+		bool pop(FrameDescriptor& frame, std::chrono::milliseconds timeout);
+
+		// Wake the consumer; pop() returns the remaining descriptors and then false.
+		void close();
+
+		std::size_t size() const;
+		uint64_t dropped() const { return drops.load(std::memory_order_relaxed); }
+
+	private:
+		void wake();
+
+		std::vector<FrameDescriptor> slots;
+		std::size_t mask = 0;
+		alignas(64) std::atomic<uint64_t> head{0};	// Next slot to write, owned by the producer
+		alignas(64) std::atomic<uint64_t> tail{0};	// Next slot to read, owned by the consumer
+		alignas(64) std::atomic<uint32_t> signal{0};	// Futex word, bumped on every push
+		std::atomic<bool> sleeping{false};
+		std::atomic<bool> closed{false};
+		std::atomic<uint64_t> drops{0};
+};
+
+#endif
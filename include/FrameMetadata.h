@@ -0,0 +1,16 @@
+#ifndef FRAMEMETADATA_H
+#define FRAMEMETADATA_H
+
+#include <cstdint>
+
+// Acquisition metadata of one frame, carried next to its image data.
+struct FrameMetadata {
+	uint64_t frameId = 0;		// Camera frame ID
+	uint64_t timestamp = 0;		// Camera timestamp in device ticks
+	double exposure = 0.0;		// ExposureTime in us
+	double gain = 0.0;		// Gain in dB
+	uint32_t offsetX = 0;		// ROI offset on the sensor
+	uint32_t offsetY = 0;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef FRAMERECORDSTORE_H
+#define FRAMERECORDSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// What became of a frame, stored in FrameRecord::status.
+enum class FrameRecordStatus : uint16_t {
+	NotWritten = 0,		// Consumed by calibration or stacking, or only held in the black-box ring
+	Written = 1,
+	WriteFailed = 2,
+	Handed = 3		// Passed to an asynchronous writer (striped targets, video)
+};
+
+// Timing and provenance of one frame handled by the worker.
+struct FrameRecord {
+	uint64_t frameCounter;
+	uint64_t frameId;		// Camera frame ID
+	uint64_t deviceTimestamp;	// Camera timestamp in device ticks (see the header's tick frequency)
+	int64_t hostTimestamp;		// Host time the frame was received, ns since the epoch
+	float exposure;			// ExposureTime in us
+	float gain;			// Gain in dB
+	uint32_t writeLatency;		// us spent writing or handing over the frame
+	uint16_t status;		// FrameRecordStatus
+	uint16_t queueDepth;		// Frames still waiting in the queue when this one was taken
+	// Decimated quality statistics (--stats, see FrameStats); zero unless hasStats is set.
+	float meanLevel;
+	float saturatedPercent;
+	float blackPercent;
+	float sharpness;
+	uint32_t statsLatency;		// us spent computing the statistics
+	uint8_t p1;
+	uint8_t p50;
+	uint8_t p99;
+	uint8_t hasStats;
+};
+static_assert(sizeof(FrameRecord) == 72, "frame records are 72 bytes");
+
+// Binary per-frame metadata file (frames.meta), replacing the per-frame lines of alvium_log.txt.
+//
+// File layout (little endian):
+//   0   char[8]  "ALVMETA1"
+//   8   u32      record size (72; 48 before the statistics were added)
+//   12  u32      reserved
+//   16  u64      device timestamp ticks per second
+//   24  i64      creation time, ns since the epoch
+//   32  FrameRecord[]
+//
+// Records are collected by the worker and written in batches, so the file can be read with a single
+// fixed-width structured read (see test/frame_metadata.py).
+class FrameRecordStore {
+	public:
+
+		// Create path. Throws std::runtime_error on failure.
+		FrameRecordStore(const std::string& path, uint64_t tickFrequency, std::size_t batchRecords = 256);
+
+		// Writes the last batch.
+		~FrameRecordStore();
+
+		FrameRecordStore(const FrameRecordStore&) = delete;
+		FrameRecordStore& operator=(const FrameRecordStore&) = delete;
+
+		void add(const FrameRecord& record);
+
+		// Write out the current batch. Returns false if the file could not be written.
+		bool flush();
+
+		uint64_t records() const { return written + batch.size(); }
+
+		static const std::size_t kHeaderBytes = 32;
+
+	private:
+		std::ofstream file;
+		std::vector<FrameRecord> batch;
+		std::size_t batchSize;
+		uint64_t written = 0;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef FRAMERING_H
+#define FRAMERING_H
+
+#include "FrameMetadata.h"
+#include "PixelFormat.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// Description of a frame held in a FrameRing slot.
+struct RingFrame {
+	const uint8_t* data = nullptr;
+	std::size_t bytes = 0;
+	PixelLayout layout;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint64_t frameCounter = 0;
+	FrameMetadata meta;
+	std::chrono::steady_clock::time_point received;
+};
+
+// Fixed RAM ring holding the most recent frames for black-box recording.
+//
+// The capture side copies every frame into the next slot. trigger() marks the frames of the pre-event window
+// and every frame of the post-event window for flushing; a flusher thread takes them in order with next()
+// and hands each slot back with release(). Slots waiting to be flushed are never overwritten: if the ring
+// wraps onto one, the new frame is dropped instead. Frames between two windows are not flushed, even when
+// the second trigger arrives before the flusher has caught up with the first window.
+class FrameRing {
+	public:
+
+		// Allocate and prefault slots x slotBytes bytes.
+		FrameRing(std::size_t slots, std::size_t slotBytes);
+
+		FrameRing(const FrameRing&) = delete;
+		FrameRing& operator=(const FrameRing&) = delete;
+
+		// Copy a frame into the ring. Returns false if it was dropped.
+		bool push(const uint8_t* data, const RingFrame& frame);
+
+		// Flush the frames received in the last pre, and all frames received in the next post. A trigger during
+		// the post window extends it.
+		void trigger(std::chrono::steady_clock::duration pre, std::chrono::steady_clock::duration post);
+
+		// Wait for the next frame to flush. Returns false once the ring is closed and nothing is left to flush.
+		bool next(RingFrame& frame);
+
+		// Return the slot handed out by next().
+		void release();
+
+		// Stop accepting frames and let next() drain what is already marked.
+		void close();
+
+		std::size_t slots() const { return slotCount; }
+		std::size_t slotBytes() const { return slotSize; }
+		uint64_t dropped() const;
+
+	private:
+		// Frames [begin, end) marked for flushing.
+		struct Window {
+			uint64_t begin;
+			uint64_t end;
+		};
+
+		std::size_t slotCount;
+		std::size_t slotSize;
+		std::vector<uint8_t> memory;
+		std::vector<RingFrame> frames;
+
+		mutable std::mutex mtx;
+		std::condition_variable cv;
+		uint64_t written = 0;		// Frames pushed so far; frame n lives in slot n % slotCount
+		std::deque<Window> pending;	// Marked frames not yet released, oldest first; the flusher is at the front
+		uint64_t flushEnd = 0;		// End of the last window; earlier frames are never marked again
+		uint64_t droppedFrames = 0;
+		std::chrono::steady_clock::time_point postDeadline;
+		bool closed = false;
+
+		bool isPending(uint64_t frame) const;
+		void mark(uint64_t begin, uint64_t end);
+};
+
+#endif
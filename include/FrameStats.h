@@ -0,0 +1,35 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#include "ImageView.h"
+
+#include <array>
+#include <cstdint>
+
+// Settings for the decimated per-frame statistics.
+struct FrameStatsSettings {
+	uint32_t step = 8;		// Sample every step-th pixel of every step-th row
+	uint8_t blackLevel = 5;		// Samples at or below this level count as black
+	uint8_t saturatedLevel = 250;	// Samples at or above this level count as saturated
+};
+
+// Cheap quality statistics of one frame, computed on a decimated grid.
+struct FrameStats {
+	double mean = 0.0;
+	uint8_t p1 = 0;
+	uint8_t p50 = 0;
+	uint8_t p99 = 0;
+	double saturatedPercent = 0.0;
+	double blackPercent = 0.0;
+	double sharpness = 0.0;		// Mean absolute horizontal difference to the full-resolution neighbour
+	uint64_t samples = 0;
+	std::array<uint32_t, 256> histogram{};
+};
+
+// Compute FrameStats on the green channel (or the only channel) of img.
+FrameStats ComputeFrameStats(const ImageView& img, const FrameStatsSettings& settings);
+
+// Smallest level with at least fraction (0 - 1) of the histogram samples at or below it.
+uint8_t HistogramPercentile(const std::array<uint32_t, 256>& histogram, uint64_t samples, double fraction);
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef FRAMEWRITER_H
+#define FRAMEWRITER_H
+
+#include "Logger.h"
+#include "PixelFormat.h"
+#include "ChunkedCompressor.h"
+#include "FrameMetadata.h"
+#include "TiffWriter.h"
+#include "WriteBehind.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace VmbCPP {
+namespace Examples {
+
+// Writes frames to disk according to their pixel format.
+//
+// Raw mode stores the image bytes of the frame; 10/12-bit formats delivered in 16-bit containers are packed
+// to 10p/12p first. Processing mode writes an 8-bit or 16-bit PNG/TIFF (deeper formats are MSB-aligned to
+// 16 bits, colour is converted to OpenCV's BGR order); TIFF and DNG go through TiffWriter instead and carry
+// the frame metadata. Raw frames can be compressed in parallel row chunks
+// into .rawz files instead (see ChunkedCompressor). Uncompressed raw frames go through WriteBehind so that
+// the page cache never holds more than a bounded amount of unwritten frame data.
+class FrameWriter
+{
+public:
+    FrameWriter(const std::string& saveDir, bool processing, const std::string& imageFormat, std::shared_ptr<::Logger> logger, bool timing);
+
+    // Write one frame and return the path of the file written (empty on failure).
+    std::string Write(const uint8_t* buffer, VmbUint32_t bufferSize, const PixelLayout& layout, VmbUint32_t width, VmbUint32_t height, uint64_t frameCounter, const FrameMetadata& meta);
+
+    // Compress raw frames with codec in chunks of chunkRows rows. Throws std::runtime_error if the codec is not built in.
+    void SetCompression(CompressionCodec codec, int level, uint32_t chunkRows);
+
+    // Compress TIFF/DNG strips with Deflate and the horizontal predictor.
+    void SetTiffCompression(bool deflate);
+
+    // Camera model written to TIFF/DNG files.
+    void SetCameraModel(const std::string& model);
+
+    // Bound the raw frame data left in the page cache to budgetBytes; 0 writes through std::ofstream instead.
+    void SetDirtyBudget(std::size_t budgetBytes);
+
+    // Wait until every raw frame written so far is on disk.
+    void Flush();
+
+    // Compute the CRC-32 of every file from the data as it is written (for the session journal).
+    void SetChecksums(bool enable) { m_checksums = enable; }
+
+    // Size and CRC-32 (0 without SetChecksums()) of the file written by the last successful Write().
+    uint64_t LastBytes() const { return m_lastBytes; }
+    uint32_t LastCrc() const { return m_lastCrc; }
+
+    // Log bytes, compression ratio and time spent per frame, and the rate write() accepted data at.
+    void LogThroughput() const;
+
+private:
+    std::string m_saveDir;
+    bool        m_processing;
+    std::string m_imageFormat;
+    std::shared_ptr<::Logger> m_logger;
+    bool        m_timing;
+    bool        m_formatLogged = false;
+    std::vector<uint16_t> m_unpacked;
+    std::vector<uint8_t>  m_packed;
+    std::unique_ptr<ChunkedCompressor> m_compressor;
+    std::unique_ptr<TiffWriter> m_tiff;
+    std::unique_ptr<WriteBehind> m_writeBehind;
+    std::vector<uint8_t>  m_swapped;
+    std::vector<uint8_t>  m_encoded;
+    uint32_t    m_chunkRows = 64;
+    bool        m_checksums = false;
+    uint64_t    m_lastBytes = 0;
+    uint32_t    m_lastCrc = 0;
+
+    // Totals for LogThroughput()
+    uint64_t    m_framesWritten = 0;
+    uint64_t    m_rawBytes = 0;
+    uint64_t    m_storedBytes = 0;
+    double      m_compressSeconds = 0.0;
+    double      m_writeSeconds = 0.0;
+    double      m_maxWriteSeconds = 0.0;
+
+    std::string WriteCompressed(const uint8_t* data, std::size_t bytes, const PixelLayout& layout, PixelPacking storage, VmbUint32_t width, VmbUint32_t height, uint64_t frameCounter);
+
+    std::string WriteRaw(const uint8_t* buffer, VmbUint32_t bufferSize, const PixelLayout& layout, VmbUint32_t width, VmbUint32_t height, uint64_t frameCounter);
+    std::string WriteImage(const uint8_t* buffer, VmbUint32_t bufferSize, const PixelLayout& layout, VmbUint32_t width, VmbUint32_t height, uint64_t frameCounter);
+    std::string WriteTiff(const uint8_t* buffer, VmbUint32_t bufferSize, const PixelLayout& layout, VmbUint32_t width, VmbUint32_t height, uint64_t frameCounter, const FrameMetadata& meta);
+    std::string FramePath(uint64_t frameCounter, const std::string& extension) const;
+    void SetLastFile(const std::string& path, uint32_t crc);
+    void LogRetireFailures();
+};
+
+}} // namespace VmbCPP
+
+#endif
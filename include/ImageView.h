@@ -0,0 +1,33 @@
+#ifndef IMAGEVIEW_H
+#define IMAGEVIEW_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Non-owning view of an interleaved 8-bit image, e.g. the buffer of a received frame.
+struct ImageView {
+	const uint8_t* data = nullptr;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t channels = 1;
+	std::size_t stride = 0;		// Bytes per row
+
+	const uint8_t* row(uint32_t y) const { return data + y * stride; }
+	bool empty() const { return data == nullptr || width == 0 || height == 0; }
+};
+
+// Rectangle inside an image. A zero width or height means "the whole image".
+struct Rect {
+	uint32_t x = 0;
+	uint32_t y = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
+};
+
+// Clip rect to the bounds of img, expanding an empty rect to the full image.
+Rect ClipRect(const Rect& rect, const ImageView& img);
+
+// Convert count pixels of row y starting at column x0 to 8-bit luma ((R + 2G + B) / 4 for 3-channel data).
+void LumaRow(const ImageView& img, uint32_t y, uint32_t x0, uint32_t count, uint8_t* dst);
+
+#endif
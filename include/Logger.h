@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
 
 class Logger {
 	public:
@@ -33,9 +34,13 @@ class Logger {
 		std::size_t maxBufferSize;
 
 		std::vector<std::string> buffer;
+		std::mutex mtx;		// Frames are logged from the SDK callback, worker and flush threads
 
 		std::string timestamp();
 		void addToBuffer(const std::string& message);
+
+		// Write out and clear the buffer; mtx must be held.
+		void writeBuffer();
 };
 
 #endif
@@ -0,0 +1,70 @@
+#ifndef PIXELFORMAT_H
+#define PIXELFORMAT_H
+
+#include "ImageView.h"
+
+#include <VmbC/VmbCommonTypes.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// How samples are laid out in a frame buffer.
+enum class PixelPacking {
+	Bits8,		// One byte per sample
+	Bits16,		// Little-endian 16-bit container per sample (Mono10/12/14/16, RGB12, ...)
+	Packed10p,	// PFNC 10p: four 10-bit samples in 5 bytes, LSB first
+	Packed12p,	// PFNC 12p: two 12-bit samples in 3 bytes, LSB first
+	Packed12Gev	// GigE Vision Mono12Packed/BayerXX12Packed
+};
+
+// Memory layout of a camera pixel format.
+struct PixelLayout {
+	VmbPixelFormatType format = VmbPixelFormatLast;
+	PixelPacking packing = PixelPacking::Bits8;
+	uint32_t channels = 1;
+	uint32_t bitDepth = 8;		// Significant bits per sample
+	bool bgr = false;		// Colour samples are in BGR order
+	bool known = false;
+};
+
+// Look up the layout of a pixel format. Unsupported formats return known == false.
+PixelLayout DescribePixelFormat(VmbPixelFormatType pixelFormat);
+
+// 16-bit format with the same channels and colour layout (Mono8 -> Mono16, BayerGR8 -> BayerGR16, BGR8 -> BGR16);
+// VmbPixelFormatLast if there is none.
+VmbPixelFormatType SixteenBitFormat(VmbPixelFormatType pixelFormat);
+
+// Bytes occupied by a width x height image with the given packing and channel count.
+std::size_t ImageBytes(PixelPacking packing, uint32_t channels, uint32_t width, uint32_t height);
+
+// Most compact packing that holds every bit of layout (Bits16 with 10 or 12 significant bits becomes 10p/12p).
+PixelPacking CompactPacking(const PixelLayout& layout);
+
+// PFNC-style name of a layout stored with the given packing, e.g. "Mono12p" or "RGB8".
+std::string StorageFormatName(const PixelLayout& layout, PixelPacking packing);
+
+// Layout of frames stored under name by the driver (the inverse of StorageFormatName), with packing set to the
+// stored packing. Names it never produces return known == false.
+PixelLayout ParseStorageFormat(const std::string& name);
+
+// Colour filter layout of a Bayer format as the colours of its 2x2 tile in row order ("RGGB", "GRBG", ...),
+// empty for other formats.
+std::string BayerPattern(VmbPixelFormatType pixelFormat);
+
+// Expand count samples of src into one 16-bit value per sample (values keep their bit depth, not rescaled).
+void UnpackTo16(const uint8_t* src, PixelPacking packing, std::size_t count, uint16_t* dst);
+
+// Pack count 16-bit samples into dst using packing (Bits16, Packed10p or Packed12p). Returns bytes written.
+std::size_t PackFrom16(const uint16_t* src, std::size_t count, PixelPacking packing, uint8_t* dst);
+
+// dst[i] = src[i] >> shift, saturated to 8 bits.
+void NarrowTo8(const uint16_t* src, std::size_t count, uint32_t shift, uint8_t* dst);
+
+// 8-bit view of a frame for the analysis stages. 8-bit formats are viewed in place, deeper formats are
+// unpacked and narrowed into scratch.
+ImageView AnalysisView(const uint8_t* buffer, const PixelLayout& layout, uint32_t width, uint32_t height,
+		       std::vector<uint16_t>& unpacked, std::vector<uint8_t>& scratch);
+
+#endif
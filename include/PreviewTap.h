@@ -0,0 +1,53 @@
+#ifndef PREVIEWTAP_H
+#define PREVIEWTAP_H
+
+#include "ImageView.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Publishes box-downsampled frames into a POSIX shared-memory triple buffer for an external viewer.
+//
+// Layout of the shared memory object (all integers little endian):
+//   0    char[8]  magic "ALVPREV1"
+//   8    uint32   slot count (3)
+//   12   uint32   bytes reserved per slot
+//   16   uint64   number of frames published; the newest is in slot (published - 1) % 3
+//   64   3 x 64 byte slot headers: uint64 seq, uint32 width, uint32 height, uint32 channels, uint32 pad, uint64 frame id
+//   256  slot data, slot i at 256 + i * slot bytes
+//
+// Each slot is guarded by a sequence counter that is odd while the slot is written. A reader copies
+// the slot and retries if the counter was odd or changed, so the writer never waits for a reader.
+class PreviewTap {
+	public:
+
+		// Create (or replace) the shared memory object name, sized for frames up to maxWidth x maxHeight x maxChannels.
+		PreviewTap(const std::string& name, uint32_t scale, uint32_t maxWidth, uint32_t maxHeight, uint32_t maxChannels);
+
+		// Unmap and unlink the shared memory object.
+		~PreviewTap();
+
+		PreviewTap(const PreviewTap&) = delete;
+		PreviewTap& operator=(const PreviewTap&) = delete;
+
+		// Downsample img by the configured scale and publish it as the newest preview frame.
+		void publish(const ImageView& img, uint64_t frameId);
+
+		uint32_t scale() const { return factor; }
+
+	private:
+		std::string shmName;
+		uint32_t factor;
+		std::size_t slotBytes;
+		std::size_t mappedBytes = 0;
+		uint8_t* base = nullptr;
+		std::vector<uint16_t> rowSums;
+};
+
+// Box-downsample img by factor (1 - 16) into dst, which must hold (width / factor) * (height / factor) * channels bytes.
+// rowSums is scratch space reused between calls.
+void BoxDownsample(const ImageView& img, uint32_t factor, uint8_t* dst, std::vector<uint16_t>& rowSums);
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef SESSIONJOURNAL_H
+#define SESSIONJOURNAL_H
+
+#include "FrameMetadata.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One frame whose file reached the disk. Records are appended in the order frames finish writing.
+struct JournalRecord {
+	uint64_t frameCounter;
+	uint64_t frameId;		// Camera frame ID
+	uint64_t timestamp;		// Camera timestamp in device ticks
+	uint64_t bytes;			// File size
+	uint32_t target;		// Index into the journal's directories
+	uint32_t dataCrc;		// CRC-32 of the file's contents
+	char name[20];			// File name inside the target directory, NUL padded
+	uint32_t crc;			// CRC-32 of the bytes above
+};
+static_assert(sizeof(JournalRecord) == 64, "journal records are 64 bytes");
+
+// Append-only record of the frames of a session that reached their files.
+//
+// File layout (little endian):
+//   0     char[8]  "ALVJRNL2"
+//   8     u32      record size (64)
+//   12    u32      directory count
+//   16    u64      creation time, ns since the epoch
+//   24    text     directories, one per line, NUL padded to 4096 bytes
+//   4096  JournalRecord[]
+//
+// append() only queues the frame, with the size and CRC the writer computed from its buffer. Every commit
+// interval, a commit thread fdatasync()s each queued frame file and the directories holding them, and only
+// then writes the records and fdatasync()s the journal. A record therefore never vouches for a frame that is
+// still in the page cache, and at most one interval of frames is lost on power failure. The frame files are
+// never read back. A record torn by a crash fails its CRC and ends the journal when it is read back.
+class SessionJournal {
+	public:
+
+		// Create path, replacing any previous journal. Throws std::runtime_error on failure.
+		SessionJournal(const std::string& path, const std::vector<std::string>& directories, std::chrono::milliseconds commitInterval);
+
+		// Commits what is queued.
+		~SessionJournal();
+
+		SessionJournal(const SessionJournal&) = delete;
+		SessionJournal& operator=(const SessionJournal&) = delete;
+
+		// Queue the frame just written to path in directory target, bytes long with CRC-32 dataCrc; it is
+		// recorded once its file is synced.
+		void append(uint64_t frameCounter, uint32_t target, const std::string& path, uint64_t bytes, uint32_t dataCrc, const FrameMetadata& meta);
+
+		// Commit what is queued and stop the commit thread. Returns false if any write or sync failed.
+		bool close();
+
+		uint64_t records() const { return recordCount; }
+		uint64_t commits() const { return commitCount; }
+		double maxCommitSeconds() const { return maxCommit; }
+
+		static const std::size_t kHeaderBytes = 4096;
+
+	private:
+		struct Pending {
+			JournalRecord record;
+			std::string path;
+		};
+
+		int fd = -1;
+		std::chrono::milliseconds interval;
+		std::vector<std::string> dirs;
+		std::mutex mtx;
+		std::condition_variable cv;
+		std::vector<Pending> queued;
+		std::thread committer;
+		bool stopping = false;
+		bool failed = false;
+		uint64_t recordCount = 0;
+		uint64_t commitCount = 0;
+		double maxCommit = 0.0;
+
+		void commitLoop();
+		bool seal(Pending& frame) const;
+};
+
+// Read a journal back. Records after the first torn or corrupt one are ignored; validBytes is the length of
+// the intact prefix of the file. Returns false if path is not a journal.
+bool ReadSessionJournal(const std::string& path, std::vector<std::string>& directories, std::vector<JournalRecord>& records, uint64_t& validBytes);
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef STACKING_H
+#define STACKING_H
+
+#include "ThreadPool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class StackMethod {
+	Mean,
+	Median,
+	SigmaClippedMean
+};
+
+// Parse "mean", "median" or "sigma". Throws std::invalid_argument on anything else.
+StackMethod ParseStackMethod(const std::string& name);
+
+const char* StackMethodName(StackMethod method);
+
+// Combines a fixed number of frames of 8- or 16-bit samples into one 16-bit frame.
+//
+// Mean keeps one running sum per sample: 16 bits for 8-bit frames of up to 257 frames, 32 bits otherwise.
+// Median and sigma-clipped mean have to keep every frame, so they cost depth x 2 bytes per sample.
+class FrameStacker {
+	public:
+
+		// pool may be null, in which case the final reduction runs on the calling thread.
+		FrameStacker(StackMethod method, std::size_t depth, ThreadPool* pool = nullptr);
+
+		// Add one frame of count samples. The first frame fixes count; frames of a different size are rejected.
+		bool add(const uint16_t* samples, std::size_t count);
+		bool add(const uint8_t* samples, std::size_t count);
+
+		// Sigma-clipped mean drops samples further than kappa standard deviations from the per-sample mean.
+		void setSigmaClip(double kappa) { this->kappa = kappa; }
+
+		// Write the stacked frame to out and start over. The result keeps fractionBits bits below the input's
+		// least significant bit (8 turns a stack of 8-bit frames into 8.8 fixed point) and is rounded below that.
+		void finish(std::vector<uint16_t>& out, uint32_t fractionBits = 0);
+
+		std::size_t frames() const { return added; }
+		bool full() const { return added >= depth; }
+		std::size_t samples() const { return count; }
+
+	private:
+		StackMethod method;
+		std::size_t depth;
+		ThreadPool* pool;
+		std::size_t count = 0;
+		std::size_t added = 0;
+		double kappa = 2.5;
+		std::vector<uint16_t> sums16;
+		std::vector<uint32_t> sums;
+		std::vector<uint16_t> widened;
+
+		// Check the size of a new frame, resetting the accumulators on the first one.
+		bool begin(std::size_t count);
+		std::vector<uint16_t> history;
+};
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef STRIPEDWRITER_H
+#define STRIPEDWRITER_H
+
+#include "FrameWriter.h"
+#include "Logger.h"
+#include "SessionJournal.h"
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace VmbCPP {
+namespace Examples {
+
+enum class StripePolicy {
+    RoundRobin,     // frame n goes to target n % targets
+    Bandwidth       // each frame goes to the target expected to finish it first, from its measured write rate
+};
+
+// Parse "rr" or "bandwidth". Throws std::invalid_argument otherwise.
+StripePolicy ParseStripePolicy(const std::string& name);
+const char* StripePolicyName(StripePolicy policy);
+
+// Spreads frames over several output directories, each written by its own FrameWriter on its own thread.
+//
+// Write() copies the frame into a buffer recycled by the chosen target and returns; it only blocks while
+// every eligible target already holds queueDepth frames. Each written frame is recorded in a session index
+// (CSV: sequence,frame,target,path) in submission order, whichever target finishes first, so that readers
+// can walk the session as one ordered sequence. Frames that failed to write are listed with an empty path.
+class StripedWriter
+{
+public:
+    StripedWriter(std::vector<std::unique_ptr<FrameWriter>> writers, const std::vector<std::string>& directories, StripePolicy policy,
+                  const std::string& indexPath, std::shared_ptr<::Logger> logger, bool timing, std::size_t queueDepth = 4);
+
+    // Close()s the writer.
+    ~StripedWriter();
+
+    StripedWriter(const StripedWriter&) = delete;
+    StripedWriter& operator=(const StripedWriter&) = delete;
+
+    // Record every written frame in journal as well (must outlive Close()).
+    void SetJournal(SessionJournal* journal) { m_journal = journal; }
+
+    void Write(const uint8_t* buffer, VmbUint32_t bufferSize, const PixelLayout& layout, VmbUint32_t width, VmbUint32_t height, uint64_t frameCounter, const FrameMetadata& meta);
+
+    // Write out every queued frame, stop the target threads and log per-target throughput.
+    void Close();
+
+private:
+    struct Job
+    {
+        std::vector<uint8_t> data;
+        PixelLayout layout;
+        VmbUint32_t width = 0;
+        VmbUint32_t height = 0;
+        uint64_t frameCounter = 0;
+        FrameMetadata meta;
+        uint64_t sequence = 0;
+    };
+
+    struct Target
+    {
+        std::unique_ptr<FrameWriter> writer;
+        std::string directory;
+        std::deque<Job> jobs;
+        std::vector<std::vector<uint8_t>> spare;    // Buffers of written jobs, reused by Write()
+        std::size_t queuedBytes = 0;
+        double bandwidth = 0.0;                     // Smoothed bytes/s, 0 until the first frame is written
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        std::condition_variable work;
+        std::thread thread;
+    };
+
+    struct IndexEntry
+    {
+        uint64_t frameCounter;
+        std::size_t target;
+        std::string path;
+    };
+
+    std::vector<std::unique_ptr<Target>> m_targets;
+    StripePolicy m_policy;
+    std::shared_ptr<::Logger> m_logger;
+    bool m_timing;
+    SessionJournal* m_journal = nullptr;
+    std::size_t m_queueDepth;
+    bool m_closing = false;
+    bool m_closed = false;
+
+    std::mutex m_mutex;
+    std::condition_variable m_space;
+    uint64_t m_nextSequence = 0;
+
+    // Entries that finished ahead of an earlier frame wait here until the index can be written in order.
+    std::ofstream m_index;
+    std::map<uint64_t, IndexEntry> m_finished;
+    uint64_t m_nextIndexed = 0;
+
+    // Target for a frame of bytes, or -1 if every eligible target is full. m_mutex must be held.
+    int Pick(uint64_t sequence, std::size_t bytes) const;
+
+    void Run(std::size_t index);
+};
+
+}} // namespace VmbCPP
+
+#endif
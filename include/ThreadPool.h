@@ -0,0 +1,46 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads used to split per-frame image work into bands.
+class ThreadPool {
+	public:
+
+		// Start numThreads workers. 0 selects std::thread::hardware_concurrency().
+		explicit ThreadPool(std::size_t numThreads = 0);
+
+		// Join all workers.
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// Run task(i) for every i in [0, count) and block until all have finished. The calling thread takes part.
+		void parallelFor(std::size_t count, const std::function<void(std::size_t)>& task);
+
+		std::size_t size() const { return workers.size() + 1; }
+
+	private:
+		std::vector<std::thread> workers;
+		std::mutex mtx;
+		std::condition_variable cvWork;
+		std::condition_variable cvDone;
+
+		const std::function<void(std::size_t)>* job = nullptr;
+		std::size_t jobCount = 0;
+		std::size_t nextIndex = 0;
+		std::size_t pending = 0;
+		std::size_t generation = 0;
+		bool stopping = false;
+
+		void workerLoop();
+		void runTasks(std::unique_lock<std::mutex>& lock);
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef TIFFWRITER_H
+#define TIFFWRITER_H
+
+#include "FrameMetadata.h"
+#include "ThreadPool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Streams frames to little-endian TIFF or DNG files with their acquisition metadata.
+//
+// The image is written as strips of rowsPerStrip rows. Uncompressed strips are written straight from the
+// caller's buffer in a single writev(); with Deflate each strip is run through the horizontal predictor and
+// compressed on a thread pool. ExposureTime uses the standard EXIF tag; frame ID, timestamp, ROI offset and
+// gain go into private tags 65000-65003 and a JSON ImageDescription. Single-channel images are written as
+// DNG (CFA for Bayer data, LinearRaw for mono) when requested; colour images are always plain TIFF.
+class TiffWriter {
+	public:
+
+		TiffWriter(bool dng, bool deflate, uint32_t rowsPerStrip = 64, std::size_t numThreads = 0);
+
+		// Camera model stored in the Model and UniqueCameraModel tags.
+		void setModel(const std::string& model) { this->model = model; }
+
+		// Write width x height pixels of channels interleaved 8- or 16-bit samples (16-bit in host little-endian
+		// order). significantBits is the bit depth of the data, cfa the Bayer tile ("RGGB", ...) or empty.
+		// Returns false if the file could not be written. If crc is not null it receives the CRC-32 of the file.
+		bool write(const std::string& path, const uint8_t* data, uint32_t width, uint32_t height, uint32_t channels,
+			   uint32_t bitsPerSample, uint32_t significantBits, const std::string& cfa, const FrameMetadata& meta,
+			   uint32_t* crc = nullptr);
+
+		bool compressed() const { return deflate; }
+
+	private:
+		bool dng;
+		bool deflate;
+		uint32_t rowsPerStrip;
+		std::string model;
+		std::unique_ptr<ThreadPool> pool;
+		std::vector<std::vector<uint8_t>> strips;	// Compressed strips
+		std::vector<std::vector<uint8_t>> predicted;	// Predictor output per strip
+
+		bool compressStrip(std::size_t index, const uint8_t* src, uint32_t rows, uint32_t width, uint32_t channels, uint32_t bytesPerSample);
+};
+
+#endif
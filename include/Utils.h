@@ -13,6 +13,9 @@ void SetupSignalHandler();
 // Ends the loop if CTRL+C pressed
 bool StopRequested();
 
+// True once per SIGUSR1 received (black-box event)
+bool EventRequested();
+
 // Initialize new terminal I/O settings
 void initTermios();
 
@@ -0,0 +1,108 @@
+#ifndef VIDEORECORDER_H
+#define VIDEORECORDER_H
+
+#include "Logger.h"
+#include "PixelFormat.h"
+#include "FrameMetadata.h"
+
+#include <opencv2/opencv.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace VmbCPP {
+namespace Examples {
+
+enum class VideoCodec {
+    Mjpeg,      // OpenCV's built-in MJPEG encoder into .avi, JPEG stripes encoded in parallel
+    H264        // FFmpeg backend into .mkv
+};
+
+// Parse "mjpg" or "h264". Throws std::invalid_argument otherwise.
+VideoCodec ParseVideoCodec(const std::string& name);
+const char* VideoCodecName(VideoCodec codec);
+
+struct VideoSettings {
+    VideoCodec codec = VideoCodec::Mjpeg;
+    int quality = 90;               // JPEG quality for MJPEG, 0-100
+    int bitrateKbps = 0;            // H.264 target bitrate, 0 leaves it to FFmpeg
+    double segmentSeconds = 600.0;  // Length of each video file
+    int threads = 3;                // Encoder threads; one core stays with capture on the 4-core board
+    double fps = 30.0;              // Frame rate written into the container
+};
+
+// Encodes frames into segmented video files on its own thread.
+//
+// Write() converts the frame to 8-bit (Bayer is demosaiced, deeper formats keep their top 8 bits) into a
+// recycled buffer and queues it; if the encoder falls more than queueDepth frames behind, the frame is
+// dropped and counted rather than stalling capture. Every segment video_NNNN.{avi,mkv} has a
+// video_NNNN.csv sidecar with one line per encoded frame: index,frame,frame_id,timestamp,exposure_us.
+class VideoRecorder
+{
+public:
+    VideoRecorder(const std::string& saveDir, const VideoSettings& settings, std::shared_ptr<::Logger> logger, bool timing, std::size_t queueDepth = 8);
+
+    // Close()s the recorder.
+    ~VideoRecorder();
+
+    VideoRecorder(const VideoRecorder&) = delete;
+    VideoRecorder& operator=(const VideoRecorder&) = delete;
+
+    // Queue a frame. Returns false if it was dropped.
+    bool Write(const uint8_t* buffer, VmbUint32_t bufferSize, const PixelLayout& layout, VmbUint32_t width, VmbUint32_t height, uint64_t frameCounter, const FrameMetadata& meta);
+
+    // Encode what is queued, close the current segment and log the encode rate.
+    void Close();
+
+private:
+    struct Job
+    {
+        cv::Mat image;
+        uint64_t frameCounter = 0;
+        FrameMetadata meta;
+    };
+
+    std::string m_saveDir;
+    VideoSettings m_settings;
+    std::shared_ptr<::Logger> m_logger;
+    bool m_timing;
+    std::size_t m_queueDepth;
+
+    std::mutex m_mutex;
+    std::condition_variable m_work;
+    std::deque<Job> m_jobs;
+    std::vector<cv::Mat> m_spare;
+    bool m_closing = false;
+    bool m_closed = false;
+    std::thread m_thread;
+
+    // Conversion scratch, only used by Write()
+    std::vector<uint16_t> m_unpacked;
+    cv::Mat m_scaled;
+
+    // Encoder state, only used by the encoder thread
+    cv::VideoWriter m_video;
+    std::ofstream m_sidecar;
+    std::size_t m_segment = 0;
+    uint64_t m_segmentFrames = 0;
+    std::chrono::steady_clock::time_point m_segmentStart;
+    uint64_t m_encoded = 0;
+    uint64_t m_dropped = 0;
+    double m_encodeSeconds = 0.0;
+
+    bool Convert(const uint8_t* buffer, VmbUint32_t bufferSize, const PixelLayout& layout, VmbUint32_t width, VmbUint32_t height, cv::Mat& out);
+    bool OpenSegment(const cv::Mat& image);
+    void CloseSegment();
+    void Run();
+};
+
+}} // namespace VmbCPP
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef WRITEBEHIND_H
+#define WRITEBEHIND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Writes whole files while keeping the amount of their data in the page cache bounded.
+//
+// Each file is preallocated, written, and its writeback started straight away with sync_file_range(). Once
+// more than the dirty-byte budget has been written without being retired, the oldest files are waited on,
+// dropped from the page cache with posix_fadvise(DONTNEED) and closed. The kernel therefore never builds
+// up a large backlog of dirty pages to flush at once, which on small-RAM boards stalls the whole process.
+class WriteBehind {
+	public:
+
+		explicit WriteBehind(std::size_t budgetBytes);
+
+		// Retires every pending file.
+		~WriteBehind();
+
+		WriteBehind(const WriteBehind&) = delete;
+		WriteBehind& operator=(const WriteBehind&) = delete;
+
+		// A file that failed after write() had accepted it, while waiting for it to reach the disk.
+		struct Failure {
+			uint64_t id;
+			std::string message;
+		};
+
+		// Create or truncate path and write bytes to it; id (the frame counter) tags the file in failures().
+		// Returns false if this file could not be written, see error(). Older files retired on the way are
+		// reported through failures(), not here.
+		bool write(const std::string& path, const void* data, std::size_t bytes, uint64_t id = 0);
+
+		// Wait for every pending file to reach the disk. Returns false if any of them failed.
+		bool drain();
+
+		// Description of the last failure.
+		const std::string& error() const { return lastError; }
+
+		// Files that failed while being retired since the last call, oldest first.
+		std::vector<Failure> failures();
+
+		std::size_t budget() const { return budgetBytes; }
+
+		// Times write() had to wait for older files, and the total time spent waiting.
+		uint64_t waits() const { return waitCount; }
+		double waitSeconds() const { return waited; }
+
+	private:
+		struct Pending {
+			int fd;
+			std::size_t bytes;
+			std::string path;
+			uint64_t id;
+		};
+
+		std::size_t budgetBytes;
+		std::size_t dirtyBytes = 0;
+		std::deque<Pending> pending;
+		std::vector<Failure> failed;
+		std::string lastError;
+		uint64_t waitCount = 0;
+		double waited = 0.0;
+
+		bool retire();
+		bool fail(const std::string& what, const std::string& path);
+};
+
+#endif
@@ -0,0 +1,97 @@
+#include "AutoExposure.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+
+AutoExposureSettings ParseAutoExposureTarget(const std::string& spec)
+{
+	AutoExposureSettings settings;
+
+	auto colon = spec.find(':');
+	if (colon == std::string::npos) {
+		throw std::invalid_argument("Auto-exposure target must look like mean:<level> or p<percent>:<level>");
+	}
+	std::string kind = spec.substr(0, colon);
+	settings.level = std::stod(spec.substr(colon + 1));
+
+	if (kind == "mean") {
+		settings.target = AutoExposureSettings::Target::Mean;
+	}
+	else if (kind.size() > 1 && kind[0] == 'p') {
+		settings.target = AutoExposureSettings::Target::Percentile;
+		settings.percentile = std::stod(kind.substr(1)) / 100.0;
+	}
+	else {
+		throw std::invalid_argument("Unknown auto-exposure target: " + kind);
+	}
+
+	if (settings.level <= 0.0 || settings.level >= 255.0 || settings.percentile <= 0.0 || settings.percentile > 1.0) {
+		throw std::invalid_argument("Auto-exposure level must be within (0, 255) and the percentile within (0, 100]");
+	}
+	return settings;
+}
+
+
+AutoExposure::AutoExposure(const AutoExposureSettings& settings, double minExposure, double maxExposure, double increment)
+	: cfg(settings), minExposure(minExposure), maxExposure(maxExposure), increment(increment)
+{
+}
+
+void AutoExposure::reset(double exposure)
+{
+	current = exposure;
+	holdFrames = cfg.latencyFrames;
+}
+
+double AutoExposure::measure(const FrameStats& stats) const
+{
+	if (cfg.target == AutoExposureSettings::Target::Mean) {
+		return stats.mean;
+	}
+	return HistogramPercentile(stats.histogram, stats.samples, cfg.percentile);
+}
+
+double AutoExposure::quantize(double exposure) const
+{
+	exposure = std::clamp(exposure, minExposure, maxExposure);
+	if (increment > 0.0) {
+		exposure = minExposure + std::round((exposure - minExposure) / increment) * increment;
+	}
+	return std::min(exposure, maxExposure);
+}
+
+AutoExposureStep AutoExposure::update(const FrameStats& stats)
+{
+	AutoExposureStep step;
+	step.measured = measure(stats);
+	step.previous = current;
+	step.exposure = current;
+
+	// Frames already in flight were exposed with the old setting.
+	if (holdFrames > 0) {
+		--holdFrames;
+		return step;
+	}
+
+	if (std::abs(step.measured - cfg.level) <= cfg.tolerance * cfg.level) {
+		return step;
+	}
+
+	// Work on the ratio: image level is roughly proportional to exposure time below saturation.
+	double ratio = step.measured < 0.5 ? cfg.maxStep : cfg.level / step.measured;
+	ratio = std::pow(ratio, cfg.damping);
+	ratio = std::clamp(ratio, 1.0 / cfg.maxStep, cfg.maxStep);
+
+	double next = quantize(current * ratio);
+	if (next == current) {
+		return step;
+	}
+
+	current = next;
+	holdFrames = cfg.latencyFrames;
+	step.changed = true;
+	step.exposure = next;
+	return step;
+}
@@ -0,0 +1,96 @@
+#include "BufferArena.h"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+namespace {
+
+	// Default hugepage size (the one MAP_HUGETLB maps) from /proc/meminfo, 0 if the kernel has none.
+	std::size_t HugePageSize()
+	{
+		// Lines such as "HugePages_Total:       0" have no unit, so match line by line.
+		std::ifstream in("/proc/meminfo");
+		std::string line;
+		while (std::getline(in, line)) {
+			std::size_t kb = 0;
+			if (std::sscanf(line.c_str(), "Hugepagesize: %zu kB", &kb) == 1) {
+				return kb * 1024;
+			}
+		}
+		return 0;
+	}
+
+	std::size_t RoundUp(std::size_t value, std::size_t multiple)
+	{
+		return (value + multiple - 1) / multiple * multiple;
+	}
+}
+
+
+BufferArena::BufferArena(std::size_t count, std::size_t bufferBytes, std::size_t alignment)
+	: buffers(count), bytes(bufferBytes), align(alignment ? alignment : 1)
+{
+	const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+	// Start every buffer on its own page (and the stream's alignment) so that buffers never share a page.
+	stride = RoundUp(bufferBytes, align > page ? align : page);
+	const std::size_t wanted = stride * count + (align > page ? align : 0);
+
+	// Explicit hugepages need a whole number of them; transparent ones are used wherever they fit.
+	void* mem = MAP_FAILED;
+	const std::size_t hugePage = HugePageSize();
+	if (hugePage > 0) {
+		length = RoundUp(wanted, hugePage);
+		mem = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	}
+	if (mem != MAP_FAILED) {
+		kind = Backing::Explicit;
+	}
+	else {
+		length = RoundUp(wanted, page);
+		mem = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mem == MAP_FAILED) {
+			throw std::runtime_error("Could not map " + std::to_string(length) + " bytes of frame buffers");
+		}
+		kind = ::madvise(mem, length, MADV_HUGEPAGE) == 0 ? Backing::Transparent : Backing::Pages;
+	}
+	mapping = static_cast<uint8_t*>(mem);
+	base = mapping + (align - reinterpret_cast<uintptr_t>(mapping) % align) % align;
+
+	// mlock also faults the pages in; touch them anyway in case the memlock limit is too small.
+	isLocked = ::mlock(mapping, length) == 0;
+	for (std::size_t offset = 0; offset < length; offset += page) {
+		mapping[offset] = 0;
+	}
+}
+
+BufferArena::~BufferArena()
+{
+	if (mapping) {
+		if (isLocked) {
+			::munlock(mapping, length);
+		}
+		::munmap(mapping, length);
+	}
+}
+
+bool BufferArena::fits(std::size_t count, std::size_t bufferBytes, std::size_t alignment) const
+{
+	const std::size_t wanted = alignment ? alignment : 1;
+	return count <= buffers && bufferBytes <= stride && stride % wanted == 0
+		&& reinterpret_cast<uintptr_t>(base) % wanted == 0;
+}
+
+const char* BufferArena::backing() const
+{
+	switch (kind) {
+		case Backing::Explicit: return "explicit hugepages";
+		case Backing::Transparent: return "transparent hugepages";
+		default: return "4 KiB pages";
+	}
+}
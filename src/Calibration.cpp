@@ -0,0 +1,196 @@
+#include "Calibration.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+
+namespace {
+
+	const char kMagic[8] = { 'A', 'L', 'V', 'C', 'A', 'L', '0', '1' };
+
+	// Fixed-size file header, followed by width * height * channels little-endian uint16 samples.
+	struct MasterHeader {
+		char magic[8];
+		uint32_t kind;
+		uint32_t width;
+		uint32_t height;
+		uint32_t channels;
+		uint32_t format;
+		uint32_t frames;
+		double exposure;
+	};
+
+	inline uint32_t CorrectOne(uint32_t value, const uint16_t* dark, const uint16_t* gain, std::size_t i, uint32_t maxValue)
+	{
+		if (dark) {
+			value = value > dark[i] ? value - dark[i] : 0;
+		}
+		if (gain) {
+			value = (value * gain[i] + (1u << (kFlatGainShift - 1))) >> kFlatGainShift;
+		}
+		return std::min(value, maxValue);
+	}
+
+#if defined(__aarch64__)
+	// Eight samples: saturating dark subtraction, widening multiply by the gain and rounding narrow back.
+	inline uint16x8_t CorrectEight(uint16x8_t v, const uint16_t* dark, const uint16_t* gain, uint16x8_t maxValue)
+	{
+		if (dark) {
+			v = vqsubq_u16(v, vld1q_u16(dark));
+		}
+		if (gain) {
+			uint16x8_t g = vld1q_u16(gain);
+			uint32x4_t lo = vmull_u16(vget_low_u16(v), vget_low_u16(g));
+			uint32x4_t hi = vmull_high_u16(v, g);
+			v = vcombine_u16(vqrshrn_n_u32(lo, kFlatGainShift), vqrshrn_n_u32(hi, kFlatGainShift));
+		}
+		return vminq_u16(v, maxValue);
+	}
+#endif
+}
+
+
+const char* CalibrationKindName(CalibrationKind kind)
+{
+	return kind == CalibrationKind::Dark ? "dark" : "flat";
+}
+
+std::string CalibrationFileName(CalibrationKind kind, double exposure, const Rect& roi)
+{
+	std::ostringstream oss;
+	oss << CalibrationKindName(kind) << "_" << static_cast<long long>(std::llround(exposure)) << "us_"
+	    << roi.width << "x" << roi.height << "+" << roi.x << "+" << roi.y << ".cal";
+	return oss.str();
+}
+
+void SaveCalibrationMaster(const std::string& path, const CalibrationMaster& master)
+{
+	MasterHeader header;
+	std::memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.kind = static_cast<uint32_t>(master.kind);
+	header.width = master.width;
+	header.height = master.height;
+	header.channels = master.channels;
+	header.format = static_cast<uint32_t>(master.format);
+	header.frames = master.frames;
+	header.exposure = master.exposure;
+
+	// Write next to the target and rename, so a reader never sees a half-written master.
+	const std::string tmp = path + ".tmp";
+	std::ofstream out(tmp, std::ios::out | std::ios::binary | std::ios::trunc);
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(master.data.data()), master.data.size() * sizeof(uint16_t));
+	out.close();
+	if (!out || std::rename(tmp.c_str(), path.c_str()) != 0) {
+		std::remove(tmp.c_str());
+		throw std::runtime_error("Could not write calibration master " + path);
+	}
+}
+
+bool LoadCalibrationMaster(const std::string& path, CalibrationMaster& master)
+{
+	std::ifstream in(path, std::ios::in | std::ios::binary);
+	if (!in) {
+		return false;
+	}
+
+	MasterHeader header;
+	if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+			|| std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0
+			|| header.kind > static_cast<uint32_t>(CalibrationKind::Flat)) {
+		return false;
+	}
+
+	master.kind = static_cast<CalibrationKind>(header.kind);
+	master.width = header.width;
+	master.height = header.height;
+	master.channels = header.channels;
+	master.format = static_cast<VmbPixelFormatType>(header.format);
+	master.frames = header.frames;
+	master.exposure = header.exposure;
+	master.data.resize(static_cast<std::size_t>(header.width) * header.height * header.channels);
+	return static_cast<bool>(in.read(reinterpret_cast<char*>(master.data.data()), master.data.size() * sizeof(uint16_t)));
+}
+
+void BuildFlatGain(const uint16_t* flat, const uint16_t* dark, uint32_t width, uint32_t height, uint32_t channels,
+		   uint16_t* gain)
+{
+	const bool bayer = channels == 1;
+	const uint32_t planes = bayer ? 4 : channels;
+	auto plane = [&](uint32_t x, uint32_t y, uint32_t c) {
+		return bayer ? (y & 1) * 2 + (x & 1) : c;
+	};
+	auto signal = [&](std::size_t i) {
+		int32_t v = static_cast<int32_t>(flat[i]) - (dark ? static_cast<int32_t>(dark[i]) : 0);
+		return std::max(v, 0);
+	};
+
+	double sums[4] = { 0.0, 0.0, 0.0, 0.0 };
+	std::size_t counts[4] = { 0, 0, 0, 0 };
+	for (uint32_t y = 0; y < height; ++y) {
+		for (uint32_t x = 0; x < width; ++x) {
+			for (uint32_t c = 0; c < channels; ++c) {
+				std::size_t i = (static_cast<std::size_t>(y) * width + x) * channels + c;
+				uint32_t p = plane(x, y, c);
+				sums[p] += signal(i);
+				counts[p]++;
+			}
+		}
+	}
+
+	double means[4];
+	for (uint32_t p = 0; p < planes && p < 4; ++p) {
+		means[p] = counts[p] ? sums[p] / counts[p] : 0.0;
+	}
+
+	const double one = static_cast<double>(1u << kFlatGainShift);
+	for (uint32_t y = 0; y < height; ++y) {
+		for (uint32_t x = 0; x < width; ++x) {
+			for (uint32_t c = 0; c < channels; ++c) {
+				std::size_t i = (static_cast<std::size_t>(y) * width + x) * channels + c;
+				int32_t v = std::max(signal(i), 1);
+				double g = std::round(means[plane(x, y, c)] * one / v);
+				gain[i] = static_cast<uint16_t>(std::min(g, 65535.0));
+			}
+		}
+	}
+}
+
+void CorrectSamples16(uint16_t* samples, std::size_t count, const uint16_t* dark, const uint16_t* gain, uint16_t maxValue)
+{
+	std::size_t i = 0;
+#if defined(__aarch64__)
+	const uint16x8_t maxv = vdupq_n_u16(maxValue);
+	for (; i + 8 <= count; i += 8) {
+		uint16x8_t v = CorrectEight(vld1q_u16(samples + i), dark ? dark + i : nullptr, gain ? gain + i : nullptr, maxv);
+		vst1q_u16(samples + i, v);
+	}
+#endif
+	for (; i < count; ++i) {
+		samples[i] = static_cast<uint16_t>(CorrectOne(samples[i], dark, gain, i, maxValue));
+	}
+}
+
+void CorrectSamples8(const uint8_t* src, std::size_t count, const uint16_t* dark, const uint16_t* gain, uint8_t* dst)
+{
+	std::size_t i = 0;
+#if defined(__aarch64__)
+	const uint16x8_t maxv = vdupq_n_u16(255);
+	for (; i + 8 <= count; i += 8) {
+		uint16x8_t v = CorrectEight(vmovl_u8(vld1_u8(src + i)), dark ? dark + i : nullptr, gain ? gain + i : nullptr, maxv);
+		vst1_u8(dst + i, vmovn_u16(v));
+	}
+#endif
+	for (; i < count; ++i) {
+		dst[i] = static_cast<uint8_t>(CorrectOne(src[i], dark, gain, i, 255));
+	}
+}
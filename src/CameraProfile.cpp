@@ -0,0 +1,355 @@
+#include "CameraProfile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <strings.h>
+
+namespace VmbCPP {
+namespace Examples {
+
+// Type of the features a profile can hold; commands and PayloadSize cannot be set.
+static bool FeatureKind(HotFeature feature, FeatureValue::Kind& kind)
+{
+    switch (feature) {
+    case HotFeature::AcquisitionFrameRateEnable:
+    case HotFeature::GammaEnable:
+        kind = FeatureValue::Kind::Bool;
+        return true;
+    case HotFeature::Width:
+    case HotFeature::Height:
+    case HotFeature::OffsetX:
+    case HotFeature::OffsetY:
+        kind = FeatureValue::Kind::Int;
+        return true;
+    case HotFeature::AcquisitionFrameRate:
+    case HotFeature::ExposureTime:
+    case HotFeature::Gain:
+        kind = FeatureValue::Kind::Float;
+        return true;
+    case HotFeature::TriggerSelector:
+    case HotFeature::TriggerMode:
+    case HotFeature::TriggerSource:
+    case HotFeature::AcquisitionMode:
+    case HotFeature::ExposureMode:
+    case HotFeature::ExposureAuto:
+    case HotFeature::GainAuto:
+    case HotFeature::PixelFormat:
+        kind = FeatureValue::Kind::Enum;
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool IsSelector(HotFeature feature)
+{
+    return feature == HotFeature::TriggerSelector;
+}
+
+bool FeatureValue::Matches(const FeatureValue& other) const
+{
+    if (kind != other.kind) {
+        return false;
+    }
+    switch (kind) {
+    case Kind::Bool:
+        return boolValue == other.boolValue;
+    case Kind::Int:
+        return intValue == other.intValue;
+    case Kind::Float:
+        return std::fabs(floatValue - other.floatValue) <= 1e-6 * std::max(1.0, std::fabs(other.floatValue));
+    case Kind::Enum:
+        return enumValue == other.enumValue;
+    }
+    return false;
+}
+
+std::string FeatureValue::ToString() const
+{
+    switch (kind) {
+    case Kind::Bool:
+        return boolValue ? "true" : "false";
+    case Kind::Int:
+        return std::to_string(intValue);
+    case Kind::Float:
+        return std::to_string(floatValue);
+    case Kind::Enum:
+        return enumValue;
+    }
+    return std::string();
+}
+
+void CameraProfile::Set(HotFeature feature, FeatureValue value, bool required)
+{
+    for (FeatureSetting& setting : m_settings) {
+        if (setting.feature == feature) {
+            setting.value = std::move(value);
+            setting.required = required;
+            return;
+        }
+    }
+    m_settings.push_back(FeatureSetting{feature, std::move(value), required});
+}
+
+void CameraProfile::SetBool(HotFeature feature, bool value, bool required)
+{
+    FeatureValue v;
+    v.kind = FeatureValue::Kind::Bool;
+    v.boolValue = value;
+    Set(feature, std::move(v), required);
+}
+
+void CameraProfile::SetInt(HotFeature feature, VmbInt64_t value, bool required)
+{
+    FeatureValue v;
+    v.kind = FeatureValue::Kind::Int;
+    v.intValue = value;
+    Set(feature, std::move(v), required);
+}
+
+void CameraProfile::SetFloat(HotFeature feature, double value, bool required)
+{
+    FeatureValue v;
+    v.kind = FeatureValue::Kind::Float;
+    v.floatValue = value;
+    Set(feature, std::move(v), required);
+}
+
+void CameraProfile::SetEnum(HotFeature feature, const std::string& value, bool required)
+{
+    FeatureValue v;
+    v.kind = FeatureValue::Kind::Enum;
+    v.enumValue = value;
+    Set(feature, std::move(v), required);
+}
+
+// Number of elements in xml with Name="name"; features stored per selector value have one per value.
+static std::size_t CountElements(const std::string& xml, const std::string& name)
+{
+    const std::string attribute = "Name=\"" + name + "\"";
+    std::size_t count = 0;
+    for (std::size_t pos = xml.find(attribute); pos != std::string::npos; pos = xml.find(attribute, pos + attribute.size())) {
+        count++;
+    }
+    return count;
+}
+
+// Text of the first <... Name="name" ...>text</...> element in xml; false if there is none or it is empty.
+static bool ElementText(const std::string& xml, const std::string& name, std::string& text)
+{
+    const std::string attribute = "Name=\"" + name + "\"";
+    std::size_t pos = xml.find(attribute);
+    if (pos == std::string::npos) {
+        return false;
+    }
+    std::size_t begin = xml.find('>', pos);
+    if (begin == std::string::npos || xml[begin - 1] == '/') {
+        return false;
+    }
+    std::size_t end = xml.find('<', ++begin);
+    if (end == std::string::npos) {
+        return false;
+    }
+    text = xml.substr(begin, end - begin);
+    text.erase(0, text.find_first_not_of(" \t\r\n"));
+    text.erase(text.find_last_not_of(" \t\r\n") + 1);
+    return !text.empty();
+}
+
+CameraProfile CameraProfile::FromSettingsFile(const std::string& path, std::vector<std::string>& skipped)
+{
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Could not open camera profile " + path);
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    const std::string xml = contents.str();
+
+    CameraProfile profile;
+    for (std::size_t i = 0; i < static_cast<std::size_t>(HotFeature::Count); ++i) {
+        const HotFeature feature = static_cast<HotFeature>(i);
+        FeatureValue::Kind kind;
+        std::string text;
+        if (!FeatureKind(feature, kind)) {
+            continue;
+        }
+        const std::size_t count = CountElements(xml, HotFeatureName(feature));
+        if (count == 0) {
+            skipped.push_back(std::string(HotFeatureName(feature)) + " (not in the file)");
+            continue;
+        }
+        if (count > 1) {
+            skipped.push_back(std::string(HotFeatureName(feature)) + " (stored once per selector value)");
+            continue;
+        }
+        if (!ElementText(xml, HotFeatureName(feature), text)) {
+            skipped.push_back(std::string(HotFeatureName(feature)) + " (no value)");
+            continue;
+        }
+        try
+        {
+            switch (kind) {
+            case FeatureValue::Kind::Bool:
+                profile.SetBool(feature, strcasecmp(text.c_str(), "true") == 0 || text == "1", true);
+                break;
+            case FeatureValue::Kind::Int:
+                profile.SetInt(feature, std::stoll(text), true);
+                break;
+            case FeatureValue::Kind::Float:
+                profile.SetFloat(feature, std::stod(text), true);
+                break;
+            case FeatureValue::Kind::Enum:
+                profile.SetEnum(feature, text, true);
+                break;
+            }
+        }
+        catch (const std::exception&)
+        {
+            throw std::runtime_error("Invalid value '" + text + "' for " + HotFeatureName(feature) + " in camera profile " + path);
+        }
+    }
+    return profile;
+}
+
+static VmbErrorType Read(const FeatureTable& features, HotFeature feature, FeatureValue::Kind kind, FeatureValue& value)
+{
+    value.kind = kind;
+    switch (kind) {
+    case FeatureValue::Kind::Bool:
+        return features.GetBool(feature, value.boolValue);
+    case FeatureValue::Kind::Int:
+        return features.GetInt(feature, value.intValue);
+    case FeatureValue::Kind::Float:
+        return features.GetFloat(feature, value.floatValue);
+    case FeatureValue::Kind::Enum: {
+        const char* entry = nullptr;
+        VmbErrorType err = features.GetEnum(feature, entry);
+        value.enumValue = entry ? entry : "";
+        return err;
+    }
+    }
+    return VmbErrorBadParameter;
+}
+
+static VmbErrorType Write(const FeatureTable& features, HotFeature feature, const FeatureValue& value)
+{
+    switch (value.kind) {
+    case FeatureValue::Kind::Bool:
+        return features.SetBool(feature, value.boolValue);
+    case FeatureValue::Kind::Int:
+        return features.SetInt(feature, value.intValue);
+    case FeatureValue::Kind::Float:
+        return features.SetFloat(feature, value.floatValue);
+    case FeatureValue::Kind::Enum:
+        return features.SetEnum(feature, value.enumValue.c_str());
+    }
+    return VmbErrorBadParameter;
+}
+
+// Write order; see ApplyProfile().
+static int Rank(const FeatureSetting& setting, const FeatureValue& current)
+{
+    switch (setting.feature) {
+    case HotFeature::PixelFormat:
+        return 0;
+    case HotFeature::OffsetX:
+    case HotFeature::OffsetY:
+        return setting.value.intValue < current.intValue ? 1 : 3;
+    case HotFeature::Width:
+    case HotFeature::Height:
+        return 2;
+    case HotFeature::ExposureTime:
+    case HotFeature::Gain:
+        return 5;
+    case HotFeature::AcquisitionFrameRateEnable:
+        // Off before the exposure is raised, on once everything it limits is set.
+        return setting.value.boolValue ? 6 : 4;
+    case HotFeature::AcquisitionFrameRate:
+        return 7;
+    default:
+        return 4;
+    }
+}
+
+namespace {
+
+struct PendingWrite
+{
+    const FeatureSetting* setting;
+    FeatureValue current;
+    bool known;         // current was read, so the write can be rolled back
+    int rank;
+};
+
+}
+
+ProfileResult ApplyProfile(const FeatureTable& features, const CameraProfile& profile)
+{
+    const auto start = std::chrono::steady_clock::now();
+    ProfileResult result;
+    std::vector<PendingWrite> pending;
+    std::vector<PendingWrite> written;     // For the rollback
+
+    auto write = [&](const PendingWrite& w) {
+        VmbErrorType err = Write(features, w.setting->feature, w.setting->value);
+        if (err == VmbErrorSuccess) {
+            result.written++;
+            written.push_back(w);
+            return true;
+        }
+        if (!w.setting->required) {
+            result.failed.push_back(std::string(HotFeatureName(w.setting->feature)) + "=" + w.setting->value.ToString());
+            return true;
+        }
+        result.abortedAt = w.setting->feature;
+        result.err = err;
+        for (auto it = written.rbegin(); it != written.rend(); ++it) {
+            if (it->known) {
+                Write(features, it->setting->feature, it->current);
+            }
+        }
+        result.written = 0;
+        return false;
+    };
+
+    // Selectors first, then read what they select.
+    for (int pass = 0; pass < 2; ++pass) {
+        pending.clear();
+        for (const FeatureSetting& setting : profile.Settings()) {
+            if (IsSelector(setting.feature) != (pass == 0)) {
+                continue;
+            }
+            PendingWrite w{&setting, FeatureValue(), false, 0};
+            w.known = Read(features, setting.feature, setting.value.kind, w.current) == VmbErrorSuccess;
+            if (!w.known) {
+                // Missing, or not readable in the current state: write it blind, like before.
+                if (!features.Has(setting.feature)) {
+                    result.missing++;
+                    continue;
+                }
+            }
+            else if (w.current.Matches(setting.value)) {
+                result.unchanged++;
+                continue;
+            }
+            w.rank = Rank(setting, w.current);
+            pending.push_back(std::move(w));
+        }
+        std::stable_sort(pending.begin(), pending.end(), [](const PendingWrite& a, const PendingWrite& b) { return a.rank < b.rank; });
+        for (const PendingWrite& w : pending) {
+            if (!write(w)) {
+                result.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+                return result;
+            }
+        }
+    }
+
+    result.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return result;
+}
+
+}} // namespace VmbCPP
@@ -0,0 +1,188 @@
+#include "ChunkedCompressor.h"
+#include "Crc32.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(ALVIUM_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+#if defined(ALVIUM_HAVE_LZ4)
+#include <lz4.h>
+#endif
+
+
+namespace {
+
+	const char kMagic[8] = { 'A', 'L', 'V', 'R', 'A', 'W', 'Z', '1' };
+	const std::size_t kHeaderBytes = 64;
+	const std::size_t kTableEntryBytes = 16;
+
+	void PutU32(uint8_t* dst, uint32_t value)
+	{
+		for (int i = 0; i < 4; ++i) dst[i] = static_cast<uint8_t>(value >> (8 * i));
+	}
+
+	void PutU64(uint8_t* dst, uint64_t value)
+	{
+		for (int i = 0; i < 8; ++i) dst[i] = static_cast<uint8_t>(value >> (8 * i));
+	}
+}
+
+
+CompressionCodec ParseCompressionCodec(const std::string& name)
+{
+	if (name == "zstd") return CompressionCodec::Zstd;
+	if (name == "lz4") return CompressionCodec::Lz4;
+	throw std::invalid_argument("Unknown compression codec: " + name);
+}
+
+const char* CompressionCodecName(CompressionCodec codec)
+{
+	switch (codec) {
+		case CompressionCodec::Zstd: return "zstd";
+		case CompressionCodec::Lz4: return "lz4";
+		default: return "none";
+	}
+}
+
+bool CompressionCodecAvailable(CompressionCodec codec)
+{
+	switch (codec) {
+#if defined(ALVIUM_HAVE_ZSTD)
+		case CompressionCodec::Zstd: return true;
+#endif
+#if defined(ALVIUM_HAVE_LZ4)
+		case CompressionCodec::Lz4: return true;
+#endif
+		default: return false;
+	}
+}
+
+ChunkedCompressor::ChunkedCompressor(CompressionCodec codec, int level, std::size_t numThreads)
+	: method(codec), level(level), pool(numThreads)
+{
+	if (!CompressionCodecAvailable(codec)) {
+		throw std::runtime_error(std::string("Compression codec ") + CompressionCodecName(codec) + " is not available in this build");
+	}
+}
+
+ChunkedCompressor::~ChunkedCompressor()
+{
+#if defined(ALVIUM_HAVE_ZSTD)
+	for (void* ctx : contexts) {
+		ZSTD_freeCCtx(static_cast<ZSTD_CCtx*>(ctx));
+	}
+#endif
+}
+
+bool ChunkedCompressor::compressChunk(std::size_t index, const uint8_t* src, std::size_t bytes)
+{
+	Chunk& chunk = chunks[index];
+	chunk.rawBytes = bytes;
+	chunk.compressedBytes = 0;
+
+	switch (method) {
+#if defined(ALVIUM_HAVE_ZSTD)
+		case CompressionCodec::Zstd: {
+			chunk.data.resize(ZSTD_compressBound(bytes));
+			size_t n = ZSTD_compressCCtx(static_cast<ZSTD_CCtx*>(contexts[index]), chunk.data.data(), chunk.data.size(), src, bytes, level);
+			if (ZSTD_isError(n)) return false;
+			chunk.compressedBytes = n;
+			return true;
+		}
+#endif
+#if defined(ALVIUM_HAVE_LZ4)
+		case CompressionCodec::Lz4: {
+			chunk.data.resize(LZ4_compressBound(static_cast<int>(bytes)));
+			int n = LZ4_compress_fast(reinterpret_cast<const char*>(src), reinterpret_cast<char*>(chunk.data.data()),
+						  static_cast<int>(bytes), static_cast<int>(chunk.data.size()), level > 0 ? level : 1);
+			if (n <= 0) return false;
+			chunk.compressedBytes = static_cast<std::size_t>(n);
+			return true;
+		}
+#endif
+		default:
+			(void)src;
+			return false;
+	}
+}
+
+std::size_t ChunkedCompressor::compress(const uint8_t* data, std::size_t bytes, std::size_t chunkBytes)
+{
+	if (data == nullptr || bytes == 0 || chunkBytes == 0) {
+		return 0;
+	}
+
+	chunkCount = (bytes + chunkBytes - 1) / chunkBytes;
+	if (chunks.size() < chunkCount) {
+		chunks.resize(chunkCount);
+	}
+#if defined(ALVIUM_HAVE_ZSTD)
+	while (method == CompressionCodec::Zstd && contexts.size() < chunkCount) {
+		contexts.push_back(ZSTD_createCCtx());
+	}
+#endif
+
+	std::atomic<bool> failed(false);
+	pool.parallelFor(chunkCount, [&](std::size_t i) {
+		std::size_t offset = i * chunkBytes;
+		std::size_t size = std::min(chunkBytes, bytes - offset);
+		if (!compressChunk(i, data + offset, size)) {
+			failed = true;
+		}
+	});
+	if (failed) {
+		return 0;
+	}
+
+	std::size_t total = 0;
+	for (std::size_t i = 0; i < chunkCount; ++i) {
+		total += chunks[i].compressedBytes;
+	}
+	return total;
+}
+
+bool ChunkedCompressor::write(const std::string& path, const RawzInfo& info, uint32_t* crc) const
+{
+	std::vector<uint8_t> head(kHeaderBytes + chunkCount * kTableEntryBytes, 0);
+	std::memcpy(head.data(), kMagic, sizeof(kMagic));
+	PutU32(&head[8], static_cast<uint32_t>(method));
+	PutU32(&head[12], info.width);
+	PutU32(&head[16], info.height);
+	PutU32(&head[20], info.channels);
+	PutU32(&head[24], info.bitDepth);
+	PutU32(&head[28], info.chunkRows);
+	PutU32(&head[32], static_cast<uint32_t>(chunkCount));
+	PutU64(&head[40], info.frameId);
+	std::memcpy(&head[48], info.format.c_str(), std::min<std::size_t>(info.format.size(), 15));
+
+	uint64_t offset = head.size();
+	for (std::size_t i = 0; i < chunkCount; ++i) {
+		uint8_t* entry = &head[kHeaderBytes + i * kTableEntryBytes];
+		PutU64(entry, offset);
+		PutU32(entry + 8, static_cast<uint32_t>(chunks[i].compressedBytes));
+		PutU32(entry + 12, static_cast<uint32_t>(chunks[i].rawBytes));
+		offset += chunks[i].compressedBytes;
+	}
+
+	if (crc) {
+		*crc = Crc32(head.data(), head.size());
+		for (std::size_t i = 0; i < chunkCount; ++i) {
+			*crc = Crc32(chunks[i].data.data(), chunks[i].compressedBytes, *crc);
+		}
+	}
+
+	FILE* file = std::fopen(path.c_str(), "wb");
+	if (file == nullptr) {
+		return false;
+	}
+	bool ok = std::fwrite(head.data(), 1, head.size(), file) == head.size();
+	for (std::size_t i = 0; ok && i < chunkCount; ++i) {
+		ok = std::fwrite(chunks[i].data.data(), 1, chunks[i].compressedBytes, file) == chunks[i].compressedBytes;
+	}
+	return std::fclose(file) == 0 && ok;
+}
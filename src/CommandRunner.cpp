@@ -0,0 +1,87 @@
+#include "CommandRunner.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace VmbCPP {
+namespace Examples {
+
+VmbErrorType CommandRunner::Execute(VmbHandle_t handle, const char* name, std::chrono::microseconds timeout)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + timeout;
+    const std::chrono::microseconds maxDelay(2000);
+    std::chrono::microseconds delay(10);
+
+    VmbErrorType err = static_cast<VmbErrorType>(VmbFeatureCommandRun(handle, name));
+    while (err == VmbErrorSuccess) {
+        VmbBool_t done = VmbBoolFalse;
+        err = static_cast<VmbErrorType>(VmbFeatureCommandIsDone(handle, name, &done));
+        if (err != VmbErrorSuccess || done == VmbBoolTrue) {
+            break;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            err = VmbErrorTimeout;
+            break;
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(delay, deadline - now));
+        delay = std::min(delay * 2, maxDelay);
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    Record(name, err, static_cast<uint32_t>(std::min<int64_t>(elapsed.count(), UINT32_MAX)));
+    return err;
+}
+
+VmbErrorType CommandRunner::Execute(const FeatureTable& features, HotFeature feature, std::chrono::microseconds timeout)
+{
+    if (!features.Has(feature)) {
+        return VmbErrorNotFound;
+    }
+    return Execute(features.Handle(), HotFeatureName(feature), timeout);
+}
+
+void CommandRunner::Record(const char* name, VmbErrorType err, uint32_t us)
+{
+    const std::size_t maxTraced = 4096;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats& stats = m_stats[name];
+    stats.runs++;
+    if (err == VmbErrorTimeout) {
+        stats.timeouts++;
+    }
+    else if (err != VmbErrorSuccess) {
+        stats.failures++;
+    }
+    else if (stats.latencyUs.size() < maxTraced) {
+        stats.latencyUs.push_back(us);
+    }
+}
+
+std::vector<std::string> CommandRunner::Report() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> lines;
+    for (const auto& entry : m_stats) {
+        const Stats& stats = entry.second;
+        std::string line = entry.first + ": " + std::to_string(stats.runs) + " runs";
+        if (!stats.latencyUs.empty()) {
+            std::vector<uint32_t> us = stats.latencyUs;
+            auto percentile = [&](double p) {
+                std::size_t k = std::min(us.size() - 1, static_cast<std::size_t>(p * (us.size() - 1) + 0.5));
+                std::nth_element(us.begin(), us.begin() + k, us.end());
+                return us[k];
+            };
+            const uint32_t p50 = percentile(0.50);
+            const uint32_t p99 = percentile(0.99);
+            const uint32_t maxUs = *std::max_element(us.begin(), us.end());
+            line += ", p50 " + std::to_string(p50) + " us, p99 " + std::to_string(p99) + " us, max " + std::to_string(maxUs) + " us to done";
+        }
+        line += ", " + std::to_string(stats.timeouts) + " timeouts, " + std::to_string(stats.failures) + " failures.";
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+}} // namespace VmbCPP
@@ -0,0 +1,76 @@
+#include "Crc32.h"
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <unistd.h>
+
+
+namespace {
+
+	// Tables for slicing by 8, built on first use.
+	const uint32_t (&CrcTables())[8][256]
+	{
+		static uint32_t tables[8][256];
+		static bool ready = [] {
+			for (uint32_t i = 0; i < 256; ++i) {
+				uint32_t c = i;
+				for (int k = 0; k < 8; ++k) {
+					c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				}
+				tables[0][i] = c;
+			}
+			for (uint32_t i = 0; i < 256; ++i) {
+				for (int t = 1; t < 8; ++t) {
+					tables[t][i] = tables[0][tables[t - 1][i] & 0xFF] ^ (tables[t - 1][i] >> 8);
+				}
+			}
+			return true;
+		}();
+		(void)ready;
+		return tables;
+	}
+}
+
+
+uint32_t Crc32(const void* data, std::size_t bytes, uint32_t crc)
+{
+	const uint32_t (&t)[8][256] = CrcTables();
+	const uint8_t* p = static_cast<const uint8_t*>(data);
+	crc = ~crc;
+	for (; bytes >= 8; bytes -= 8, p += 8) {
+		uint32_t lo;
+		uint32_t hi;
+		std::memcpy(&lo, p, 4);
+		std::memcpy(&hi, p + 4, 4);
+		lo ^= crc;
+		crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24]
+		    ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+	}
+	for (; bytes > 0; --bytes, ++p) {
+		crc = t[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+bool FileCrc32(int fd, uint32_t& crc, uint64_t& bytes)
+{
+	std::vector<uint8_t> chunk(1 << 20);
+	crc = 0;
+	bytes = 0;
+	while (true) {
+		ssize_t n = ::read(fd, chunk.data(), chunk.size());
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		if (n == 0) {
+			return true;
+		}
+		crc = Crc32(chunk.data(), static_cast<std::size_t>(n), crc);
+		bytes += static_cast<uint64_t>(n);
+	}
+}
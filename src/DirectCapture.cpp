@@ -0,0 +1,100 @@
+#include "DirectCapture.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+namespace VmbCPP {
+namespace Examples {
+
+DirectCapture::DirectCapture(const CameraPtr& camera, const BufferArena& arena, std::size_t buffers, std::size_t payloadSize, FrameDescriptorRing& ring) :
+    m_handle(camera->GetHandle()), m_frames(buffers), m_ring(ring)
+{
+    for (std::size_t i = 0; i < m_frames.size(); ++i) {
+        VmbFrame_t& frame = m_frames[i];
+        frame = VmbFrame_t();
+        frame.buffer = arena.buffer(i);
+        frame.bufferSize = static_cast<VmbUint32_t>(payloadSize);
+        frame.context[0] = this;
+        frame.context[1] = reinterpret_cast<void*>(i);
+        VmbError_t err = VmbFrameAnnounce(m_handle, &frame, sizeof(VmbFrame_t));
+        if (err != VmbErrorSuccess) {
+            VmbFrameRevokeAll(m_handle);
+            throw std::runtime_error("Could not announce frame buffer, err=" + std::to_string(err));
+        }
+    }
+}
+
+DirectCapture::~DirectCapture()
+{
+    Stop();
+    VmbFrameRevokeAll(m_handle);
+}
+
+VmbErrorType DirectCapture::Start()
+{
+    VmbError_t err = VmbCaptureStart(m_handle);
+    if (err != VmbErrorSuccess) {
+        return static_cast<VmbErrorType>(err);
+    }
+    m_capturing = true;
+    for (VmbFrame_t& frame : m_frames) {
+        err = VmbCaptureFrameQueue(m_handle, &frame, &DirectCapture::FrameDone);
+        if (err != VmbErrorSuccess) {
+            break;
+        }
+    }
+    return static_cast<VmbErrorType>(err);
+}
+
+VmbErrorType DirectCapture::Requeue(const FrameDescriptor& frame)
+{
+    if (!m_capturing.load(std::memory_order_acquire) || frame.index >= m_frames.size()) {
+        return VmbErrorInvalidCall;
+    }
+    return static_cast<VmbErrorType>(VmbCaptureFrameQueue(m_handle, &m_frames[frame.index], &DirectCapture::FrameDone));
+}
+
+void DirectCapture::Stop()
+{
+    if (!m_capturing.exchange(false)) {
+        return;
+    }
+    VmbCaptureEnd(m_handle);
+    VmbCaptureQueueFlush(m_handle);
+}
+
+void VMB_CALL DirectCapture::FrameDone(const VmbHandle_t cameraHandle, const VmbHandle_t, VmbFrame_t* frame)
+{
+    DirectCapture* self = static_cast<DirectCapture*>(frame->context[0]);
+
+    if (frame->receiveStatus != VmbFrameStatusComplete) {
+        self->m_incomplete.fetch_add(1, std::memory_order_relaxed);
+        if (self->m_capturing.load(std::memory_order_acquire)) {
+            VmbCaptureFrameQueue(cameraHandle, frame, &DirectCapture::FrameDone);
+        }
+        return;
+    }
+
+    FrameDescriptor d;
+    d.deliveredNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    d.receivedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    d.buffer = frame->imageData ? frame->imageData : static_cast<uint8_t*>(frame->buffer);
+    d.bufferSize = frame->bufferSize;
+    d.index = static_cast<uint32_t>(reinterpret_cast<std::size_t>(frame->context[1]));
+    d.frameId = frame->frameID;
+    d.timestamp = frame->timestamp;
+    d.pixelFormat = frame->pixelFormat;
+    d.width = frame->width;
+    d.height = frame->height;
+    d.offsetX = frame->offsetX;
+    d.offsetY = frame->offsetY;
+    d.status = frame->receiveStatus;
+
+    // The ring holds every announced buffer, so this only fails if the consumer lost track of one.
+    if (!self->m_ring.push(d) && self->m_capturing.load(std::memory_order_acquire)) {
+        VmbCaptureFrameQueue(cameraHandle, frame, &DirectCapture::FrameDone);
+    }
+}
+
+}} // namespace VmbCPP
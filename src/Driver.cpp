@@ -6,6 +6,8 @@
 #include "Driver.h"
 #include "Logger.h"
 #include "Utils.h"
+#include "FrameWriter.h"
+#include "PixelFormat.h"
 
 #include <VmbCPP/VmbCPP.h>
 
@@ -22,6 +24,10 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <condition_variable>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 
 namespace VmbCPP {
 namespace Examples {
@@ -30,7 +36,7 @@ namespace Examples {
 class FrameObserver : public IFrameObserver
 {
     public:
-        FrameObserver(CameraPtr camera, const std::string& saveDir, std::shared_ptr<::Logger> logger, std::shared_ptr<FrameQueue> queue) : IFrameObserver(camera), m_saveDir(saveDir),  m_queue(queue), m_logger(logger), m_frameCounter(1)  {}
+        FrameObserver(CameraPtr camera, std::shared_ptr<::Logger> logger, std::shared_ptr<FrameQueue> queue) : IFrameObserver(camera), m_queue(queue), m_logger(logger)  {}
 
         void FrameReceived(const FramePtr frame) override
         {
@@ -38,11 +44,13 @@ class FrameObserver : public IFrameObserver
             if (frame->GetReceiveStatus(status) == VmbErrorSuccess
                     && status == VmbFrameStatusComplete)
             {
-                std::ostringstream oss; 
-                oss << m_saveDir << "/frame_" << std::setw(6) << std::setfill('0') << m_frameCounter++ << ".raw";
-                m_logger->log(oss.str() + " captured.");
+                // Receive time and queue depth go to frames.meta via the worker.
                 m_queue->push(frame);
             }
+            else
+            {
+                m_logger->debug("Incomplete frame dropped, status " + std::to_string(status) + ".");
+            }
 
             m_pCamera->QueueFrame(frame);
 
@@ -50,30 +58,32 @@ class FrameObserver : public IFrameObserver
     private:
         std::shared_ptr<FrameQueue> m_queue;
         std::shared_ptr<::Logger> m_logger;
-        std::string m_saveDir;
-        std::atomic<int> m_frameCounter;
-
 };
 
 void FrameQueue::push(const FramePtr& f) 
 
 {
+    const int64_t delivered = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    const int64_t received = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
     std::lock_guard<std::mutex> lock(mtx);
-    q.push(f);
+    q.push(Entry{f, received, delivered});
     cv.notify_one();
 }
 
-FramePtr FrameQueue::pop() {
+FramePtr FrameQueue::pop(int64_t& receivedNs, int64_t& deliveredNs, std::size_t& depth) {
     std::unique_lock<std::mutex> lock(mtx);
     cv.wait(lock, [&]{ return !q.empty(); });
-    FramePtr f = q.front();
+    FramePtr f = q.front().frame;
+    receivedNs = q.front().receivedNs;
+    deliveredNs = q.front().deliveredNs;
     q.pop();
+    depth = q.size();
     return f;
 }
 
 
 // Helper function to adjust the packet size for Allied vision GigE cameras
-void GigEAdjustPacketSize(CameraPtr camera, std::shared_ptr<::Logger> m_logger)
+void GigEAdjustPacketSize(CameraPtr camera, CommandRunner& commands, std::shared_ptr<::Logger> m_logger)
 {
     StreamPtrVector streams;
     VmbErrorType err = camera->GetStreams(streams);
@@ -89,19 +99,9 @@ void GigEAdjustPacketSize(CameraPtr camera, std::shared_ptr<::Logger> m_logger)
 
     if (err == VmbErrorSuccess)
     {
-        err = feature->RunCommand();
-        if (err == VmbErrorSuccess)
-        {
-            bool commandDone = false;
-            do
-            {
-                if (feature->IsCommandDone(commandDone) != VmbErrorSuccess)
-                {
-                    break;
-                }
-            } while (commandDone == false);
-        }
-        else
+        // The packet size is found by sending test packets, which takes up to a few seconds on a poor link.
+        err = commands.Execute(streams[0]->GetHandle(), "GVSPAdjustPacketSize", std::chrono::seconds(5));
+        if (err != VmbErrorSuccess)
         {
 			m_logger->error("Error while executing GVSPAdjustPacketSize, err=" + std::to_string(err));
         }
@@ -110,49 +110,71 @@ void GigEAdjustPacketSize(CameraPtr camera, std::shared_ptr<::Logger> m_logger)
 
 
 // Main driver constructor to accept camera configurations and initialize for acquisition
-Driver::Driver(const char* cameraId, const std::string& saveDirectory, std::shared_ptr<::Logger> logger, int frameRate, const std::string& mode, int exposureTime, bool processing, bool timing, int core_id, const ROI& roi) :
+Driver::Driver(const char* cameraId, const std::string& saveDirectory, std::shared_ptr<::Logger> logger, int frameRate, const std::string& mode, int exposureTime, bool processing, bool timing, int core_id, const ROI& roi, const char* transportLayers) :
     m_vmbSystem(VmbSystem::GetInstance()), m_saveDir(saveDirectory), m_logger(logger), m_frameRate(frameRate), m_mode(mode), m_exposureTime(exposureTime), m_processing(processing), m_timing(timing), m_coreid(core_id), m_roi(roi)
 {
-	// Attempt to access the VmbCPP API
-    VmbErrorType err = m_vmbSystem.Startup();
+    m_startupBegin = std::chrono::steady_clock::now();
+    m_phaseMark = m_startupBegin;
+
+	// Attempt to access the VmbCPP API; with transportLayers only those are loaded and polled.
+    VmbErrorType err = transportLayers != nullptr ? m_vmbSystem.Startup(transportLayers) : m_vmbSystem.Startup();
 
     if (err != VmbErrorSuccess)
     {
 		m_logger->error("Could not start API, err=" + std::to_string(err));
         throw std::runtime_error("Could not start API, err=" + std::to_string(err));
     }
+    MarkStartupPhase("api start");
 
-	// Attempt to open any connected cameras
-    CameraPtrVector cameras;
-    err = m_vmbSystem.GetCameras(cameras);
-    if (err != VmbErrorSuccess)
-    {
-        m_vmbSystem.Shutdown();
-		m_logger->error("Could not get cameras, err=" + std::to_string(err));
-        throw std::runtime_error("Could not get cameras, err=" + std::to_string(err));
-    }
-
-    if (cameras.empty())
-    {
-        m_vmbSystem.Shutdown();
-		m_logger->error("No cameras found.");
-        throw std::runtime_error("No cameras found.");
-    }
-	
+    // With an ID the camera is queried directly (VmbCameraInfoQuery) instead of enumerating every transport layer;
+    // a serial number is not an ID the transport layers know, so it falls back to the enumeration.
     if (cameraId != nullptr)
     {
         err = m_vmbSystem.GetCameraByID(cameraId, m_camera);
+    }
+    if (cameraId == nullptr || err != VmbErrorSuccess)
+    {
+        CameraPtrVector cameras;
+        err = m_vmbSystem.GetCameras(cameras);
         if (err != VmbErrorSuccess)
         {
             m_vmbSystem.Shutdown();
-			m_logger->error("No camera found with ID=" + std::string(cameraId) + ", err = " + std::to_string(err));
-            throw std::runtime_error("No camera found with ID=" + std::string(cameraId) + ", err = " + std::to_string(err));
+            m_logger->error("Could not get cameras, err=" + std::to_string(err));
+            throw std::runtime_error("Could not get cameras, err=" + std::to_string(err));
+        }
+
+        if (cameras.empty())
+        {
+            m_vmbSystem.Shutdown();
+            m_logger->error("No cameras found.");
+            throw std::runtime_error("No cameras found.");
+        }
+
+        if (cameraId == nullptr)
+        {
+            m_camera = cameras[0];
+        }
+        else
+        {
+            for (const CameraPtr& camera : cameras)
+            {
+                std::string serial;
+                if (camera->GetSerialNumber(serial) == VmbErrorSuccess && serial == cameraId)
+                {
+                    m_camera = camera;
+                    break;
+                }
+            }
+            if (!m_camera)
+            {
+                m_vmbSystem.Shutdown();
+                m_logger->error("No camera found with ID or serial number " + std::string(cameraId));
+                throw std::runtime_error("No camera found with ID or serial number " + std::string(cameraId));
+            }
         }
     }
-    else
-    {
-        m_camera = cameras[0];
-    }
+    MarkStartupPhase("discovery");
+
 	// Attempt to open discovered camera
     err = m_camera->Open(VmbAccessModeFull);
     if (err != VmbErrorSuccess)
@@ -162,6 +184,9 @@ Driver::Driver(const char* cameraId, const std::string& saveDirectory, std::shar
     }
 
 
+    // Every feature the driver touches, looked up once.
+    m_features.Resolve(m_camera);
+
 	// Log successful camera initialization
     std::string name;
     if (m_camera->GetName(name) == VmbErrorSuccess)
@@ -171,39 +196,149 @@ Driver::Driver(const char* cameraId, const std::string& saveDirectory, std::shar
 		}
 	}
 
-    try
+    // Packet size negotiation only applies to GigE; USB and MIPI cameras skip the stream feature lookup.
+    VmbTransportLayerType interfaceType = VmbTransportLayerTypeUnknown;
+    if (m_camera->GetInterfaceType(interfaceType) != VmbErrorSuccess || interfaceType == VmbTransportLayerTypeGEV)
     {
-        GigEAdjustPacketSize(m_camera, m_logger);
-    }
-    catch (std::runtime_error& e)
-    {
-        m_vmbSystem.Shutdown();
-        throw e;
+        try
+        {
+            GigEAdjustPacketSize(m_camera, m_commands, m_logger);
+        }
+        catch (std::runtime_error& e)
+        {
+            m_vmbSystem.Shutdown();
+            throw e;
+        }
     }
+    MarkStartupPhase("open");
 
 	// Set fixed frame rate, fixed exposure, or triggered frame mode based on --mode input argument
-    if (m_mode == "fixed")
+    CameraProfile profile;
+    try
     {
-	    ConfigureFixedFrameRate();
+        if (m_mode == "fixed")
+        {
+            ConfigureFixedFrameRate(profile);
+        }
+        else if ((m_mode == "trigger_keyboard") || (m_mode == "trigger"))
+        {
+            ConfigureTriggerMode(profile);
+        }
+        else if (m_mode == "exposure" || m_mode == "calibrate_dark" || m_mode == "calibrate_flat")
+        {
+            ConfigureExposureMode(profile);
+        }
+        else if (m_mode == "burst")
+        {
+            ConfigureBurstMode(profile);
+        }
+        SetROI(profile);
+
+        // Written in one pass, ROI before the frame rate it limits.
+        ApplyConfiguration(profile, "Camera configuration");
     }
-    else if ((m_mode == "trigger_keyboard") || (m_mode == "trigger"))
+    catch (std::runtime_error&)
     {
-	    ConfigureTriggerMode();
+        m_vmbSystem.Shutdown();
+        throw;
     }
-	else if (m_mode == "exposure")
-	{
-		ConfigureExposureMode();
-	}
 
+    double expTimeReadback = 0.0;
+    if (!m_timing && (m_mode == "exposure" || m_mode == "calibrate_dark" || m_mode == "calibrate_flat")
+            && m_features.GetFloat(HotFeature::ExposureTime, expTimeReadback) == VmbErrorSuccess) {
+        m_logger->log("Camera set to exposure time of " + std::to_string(expTimeReadback) + " us.");
+    }
 
 	// Set core locking affinity based on --core_id input argument
     if (m_coreid != -1) {
 	    SetCpuAffinity();
     }
+    MarkStartupPhase("configuration");
+}
+
+// Method to end a startup phase; the phases of the first session are logged with its first frame.
+void Driver::MarkStartupPhase(const char* name)
+{
+    if (m_startupLogged) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    m_startupPhases.emplace_back(name, std::chrono::duration<double, std::milli>(now - m_phaseMark).count());
+    m_phaseMark = now;
+}
 
-    SetROI();
+// Method to print the startup phases; logged with --timing too, since this is what time-to-first-frame is made of.
+void Driver::LogStartupPhases()
+{
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1) << "Startup phases (ms):";
+    for (size_t i = 0; i < m_startupPhases.size(); ++i) {
+        line << (i == 0 ? " " : ", ") << m_startupPhases[i].first << " " << m_startupPhases[i].second;
+    }
+    line << "; first frame after " << std::chrono::duration<double, std::milli>(m_phaseMark - m_startupBegin).count();
+    m_logger->log(line.str());
+    std::cout << line.str() << std::endl;
+    m_startupLogged = true;
+}
 
+// Method to write a profile to the camera and log how much of it had to be written.
+void Driver::ApplyConfiguration(const CameraProfile& profile, const std::string& what)
+{
+    ProfileResult result = ApplyProfile(m_features, profile);
+    for (const std::string& failed : result.failed) {
+        m_logger->error("Could not set " + failed + ".");
+    }
+    if (result.abortedAt != HotFeature::Count) {
+        std::string message = what + ": could not set " + HotFeatureName(result.abortedAt) + ", err=" + std::to_string(result.err) + ", changes rolled back";
+        m_logger->error(message);
+        throw std::runtime_error(message);
+    }
+    // Logged with --timing too, it is part of the startup time.
+    m_logger->log(what + ": " + std::to_string(result.written) + " features written, " + std::to_string(result.unchanged) + " unchanged, "
+                  + std::to_string(result.missing) + " not on this camera, " + std::to_string(result.elapsed.count() / 1000.0) + " ms.");
+}
 
+// Method to bring the camera to a saved profile.
+void Driver::LoadProfile(const std::string& path)
+{
+    CameraProfile profile;
+    std::vector<std::string> skipped;
+    try
+    {
+        profile = CameraProfile::FromSettingsFile(path, skipped);
+    }
+    catch (std::runtime_error& e)
+    {
+        m_logger->error(e.what());
+        throw;
+    }
+    for (const std::string& feature : skipped) {
+        m_logger->log("Profile " + path + ": skipped " + feature + ".");
+    }
+    if (profile.Empty()) {
+        m_logger->error("No driver features in camera profile " + path);
+        throw std::runtime_error("No driver features in camera profile " + path);
+    }
+    ApplyConfiguration(profile, "Profile " + path);
+}
+
+// Method to save the camera's features to a profile.
+void Driver::SaveProfile(const std::string& path)
+{
+    VmbFeaturePersistSettings_t settings = {};
+    settings.persistType = VmbFeaturePersistNoLUT;
+    settings.modulePersistFlags = VmbModulePersistFlagsRemoteDevice;
+    settings.maxIterations = 5;
+    settings.loggingLevel = VmbLogLevelNone;
+    VmbErrorType err = m_camera->SaveSettings(path.c_str(), &settings);
+    if (err != VmbErrorSuccess)
+    {
+        m_logger->error("Could not save camera profile " + path + ", err=" + std::to_string(err));
+        throw std::runtime_error("Could not save camera profile " + path + ", err=" + std::to_string(err));
+    }
+    if (!m_timing) {
+        m_logger->log("Camera profile saved to " + path);
+    }
 }
 
 
@@ -239,86 +374,1163 @@ Driver::~Driver()
 void Driver::Start()
 {
     m_queue = std::make_shared<FrameQueue>();
+    if (m_videoEnabled) {
+        VideoSettings settings = m_videoSettings;
+        settings.fps = m_frameRate > 0 ? m_frameRate : 30.0;
+        m_video = std::make_unique<VideoRecorder>(m_saveDir, settings, m_logger, m_timing);
+    }
+    // Video segments carry their own per-frame sidecar.
+    if (m_journalInterval.count() > 0 && !m_video) {
+        std::vector<std::string> dirs = m_stripeDirs.size() > 1 ? m_stripeDirs : std::vector<std::string>{m_saveDir};
+        try
+        {
+            m_journal = std::make_unique<SessionJournal>(m_saveDir + "/session.journal", dirs, m_journalInterval);
+        }
+        catch (std::runtime_error& e)
+        {
+            m_logger->error(e.what());
+            throw;
+        }
+    }
+    if (m_stripeDirs.size() > 1) {
+        std::vector<std::unique_ptr<FrameWriter>> writers;
+        for (const auto& dir : m_stripeDirs) {
+            writers.push_back(CreateWriter(dir));
+        }
+        m_striped = std::make_unique<StripedWriter>(std::move(writers), m_stripeDirs, m_stripePolicy, m_saveDir + "/session_index.csv", m_logger, m_timing);
+        m_striped->SetJournal(m_journal.get());
+    }
+    else {
+        m_writer = CreateWriter(m_saveDir);
+    }
+    ReadFrameMetadata();
+    try
+    {
+        m_records = std::make_unique<FrameRecordStore>(m_saveDir + "/frames.meta", m_tickFrequency);
+    }
+    catch (std::runtime_error& e)
+    {
+        m_logger->error(e.what());
+        throw;
+    }
+
+    // The worker picks its delivery path from what AnnounceFrames() set up.
+    m_deliveryUs.clear();
+    m_deliveryUs.reserve(4096);
+    MarkStartupPhase("session setup");
+    AnnounceFrames();
+    MarkStartupPhase("buffer announce");
 
     m_running = true;
+    if (m_ring) {
+        m_flushThread = std::thread(&Driver::FlushLoop, this);
+    }
     m_workerThread = std::thread(
             &Driver::FrameWorkerLoop, this
             );
 
-    VmbErrorType err = m_camera->StartContinuousImageAcquisition(5, IFrameObserverPtr(new FrameObserver(m_camera, m_saveDir, m_logger, m_queue)));
+    VmbErrorType err = VmbErrorSuccess;
+    if (m_direct) {
+        err = m_direct->Start();
+    }
+    else {
+        err = m_camera->StartCapture();
+        for (size_t i = 0; err == VmbErrorSuccess && i < m_frames.size(); ++i) {
+            err = m_camera->QueueFrame(m_frames[i]);
+        }
+    }
+    if (err == VmbErrorSuccess) {
+        err = m_commands.Execute(m_features, HotFeature::AcquisitionStart, std::chrono::seconds(1));
+    }
     if (!m_timing) {
     	m_logger->log("Started image acquisition.");
     }
     if (err != VmbErrorSuccess)
     {
 		m_logger->error("Could not start acquisition, err=" + std::to_string(err));
+        // Stop the worker and hand the buffers back now; a later Start() announces them again.
+        m_running = false;
+        if (m_workerThread.joinable()) {
+            m_workerThread.join();
+        }
+        if (m_direct) {
+            m_direct->Stop();
+            m_direct.reset();
+            m_descriptors.reset();
+        }
+        else {
+            RevokeFrames();
+        }
         throw std::runtime_error("Could not start acquisition, err=" + std::to_string(err));
     }
 }
 
+// Method to announce driver-owned frame buffers. The arena outlives Stop() so that later sessions start on
+// already faulted-in memory.
+void Driver::AnnounceFrames()
+{
+    const size_t bufferCount = 5;
+    VmbInt64_t payload = 0;
+    VmbUint32_t alignment = 1;
+    if (m_features.GetInt(HotFeature::PayloadSize, payload) != VmbErrorSuccess || payload <= 0) {
+        m_logger->error("Could not read PayloadSize.");
+        throw std::runtime_error("Could not read PayloadSize.");
+    }
+    if (m_camera->GetStreamBufferAlignment(alignment) != VmbErrorSuccess || alignment == 0) {
+        alignment = 1;
+    }
+
+    if (!m_arena || !m_arena->fits(bufferCount, static_cast<size_t>(payload), alignment)) {
+        m_arena.reset();
+        try
+        {
+            m_arena = std::make_unique<BufferArena>(bufferCount, static_cast<size_t>(payload), alignment);
+            if (!m_timing) {
+                m_logger->log("Frame buffers: " + std::to_string(bufferCount) + " x " + std::to_string(payload) + " bytes on "
+                              + m_arena->backing() + (m_arena->locked() ? ", locked" : ", not locked (raise ulimit -l)")
+                              + ", alignment " + std::to_string(alignment) + ".");
+            }
+        }
+        catch (std::runtime_error& e)
+        {
+            m_logger->error(std::string(e.what()) + ", letting the SDK allocate frame buffers.");
+        }
+    }
+
+    if (m_directDelivery && m_arena) {
+        m_descriptors = std::make_unique<FrameDescriptorRing>(bufferCount);
+        try
+        {
+            m_direct = std::make_unique<DirectCapture>(m_camera, *m_arena, bufferCount, static_cast<size_t>(payload), *m_descriptors);
+        }
+        catch (std::runtime_error& e)
+        {
+            m_logger->error(e.what());
+            throw;
+        }
+        return;
+    }
+    if (m_directDelivery) {
+        m_logger->error("Direct frame delivery needs the frame arena, using frame observers.");
+    }
+
+    m_observer = IFrameObserverPtr(new FrameObserver(m_camera, m_logger, m_queue));
+    m_frames.clear();
+    for (size_t i = 0; i < bufferCount; ++i) {
+        FramePtr frame(m_arena ? new Frame(m_arena->buffer(i), payload)
+                               : new Frame(payload, FrameAllocation_AnnounceFrame, alignment));
+        VmbErrorType err = frame->RegisterObserver(m_observer);
+        if (err == VmbErrorSuccess) {
+            err = m_camera->AnnounceFrame(frame);
+        }
+        if (err != VmbErrorSuccess) {
+            frame->UnregisterObserver();
+            RevokeFrames();
+            m_logger->error("Could not announce frame buffer, err=" + std::to_string(err));
+            throw std::runtime_error("Could not announce frame buffer, err=" + std::to_string(err));
+        }
+        m_frames.push_back(frame);
+    }
+}
+
+// Method to end capture and revoke the frames announced by AnnounceFrames(); the arena stays mapped.
+void Driver::RevokeFrames()
+{
+    m_camera->EndCapture();
+    m_camera->FlushQueue();
+    m_camera->RevokeAllFrames();
+    for (const FramePtr& frame : m_frames) {
+        frame->UnregisterObserver();
+    }
+    m_frames.clear();
+}
+
 // Method to listen for software triggers and acquire the frame accordingly.
 void Driver::TriggerFrame()
 {
     if (m_mode == "trigger_keyboard") {
         std::cout << "Frame triggered" << std::endl;
     }
-	FeaturePtr triggerCmd;
-	m_camera->GetFeatureByName("TriggerSoftware", triggerCmd);
-	if (triggerCmd->RunCommand() == VmbErrorSuccess) {
+	VmbErrorType err = m_commands.Execute(m_features, HotFeature::TriggerSoftware, std::chrono::milliseconds(100));
+	if (err == VmbErrorSuccess) {
 		m_logger->debug("Triggered Image Acquisition.");
 	}
+	else if (err == VmbErrorTimeout) {
+		m_logger->error("TriggerSoftware did not complete within 100 ms.");
+	}
+}
+
+// Descriptor of a frame delivered through VmbCPP, so that both delivery paths share HandleFrame().
+static void DescribeFrame(const FramePtr& frame, FrameDescriptor& d)
+{
+    VmbUint32_t bufferSize = 0, width = 0, height = 0, offsetX = 0, offsetY = 0;
+    VmbUint64_t frameId = 0, timestamp = 0;
+    VmbPixelFormatType pixelFormat = VmbPixelFormatLast;
+    VmbFrameStatusType status = VmbFrameStatusComplete;
+    frame->GetImage(d.buffer);
+    frame->GetBufferSize(bufferSize);
+    frame->GetWidth(width);
+    frame->GetHeight(height);
+    frame->GetOffsetX(offsetX);
+    frame->GetOffsetY(offsetY);
+    frame->GetPixelFormat(pixelFormat);
+    frame->GetFrameID(frameId);
+    frame->GetTimestamp(timestamp);
+    frame->GetReceiveStatus(status);
+    d.bufferSize = bufferSize;
+    d.frameId = frameId;
+    d.timestamp = timestamp;
+    d.width = width;
+    d.height = height;
+    d.offsetX = offsetX;
+    d.offsetY = offsetY;
+    d.pixelFormat = pixelFormat;
+    d.status = status;
+}
+
+// Method to capture a burst into one buffer per frame and write it out once the camera is done.
+void Driver::CaptureBurst(size_t frameCount)
+{
+    VmbInt64_t payload = 0;
+    VmbUint32_t alignment = 1;
+    if (m_features.GetInt(HotFeature::PayloadSize, payload) != VmbErrorSuccess || payload <= 0) {
+        m_logger->error("Could not read PayloadSize.");
+        throw std::runtime_error("Could not read PayloadSize.");
+    }
+    if (m_camera->GetStreamBufferAlignment(alignment) != VmbErrorSuccess || alignment == 0) {
+        alignment = 1;
+    }
+    // AcquireMultipleImages() queues at least StreamAnnounceBufferMinimum frames and waits on that many of ours.
+    StreamPtrVector streams;
+    FeaturePtr feature;
+    VmbInt64_t minimum = 0;
+    if (m_camera->GetStreams(streams) == VmbErrorSuccess && !streams.empty()
+        && streams[0]->GetFeatureByName("StreamAnnounceBufferMinimum", feature) == VmbErrorSuccess
+        && feature->GetValue(minimum) == VmbErrorSuccess && static_cast<VmbInt64_t>(frameCount) < minimum) {
+        m_logger->log("Burst raised to " + std::to_string(minimum) + " frames, the minimum the stream announces.");
+        frameCount = static_cast<size_t>(minimum);
+    }
+
+    // AcquireMultipleImages() announces the frames as given, so the whole burst is mapped before the first exposure.
+    if (!m_arena || !m_arena->fits(frameCount, static_cast<size_t>(payload), alignment)) {
+        m_arena.reset();
+        try
+        {
+            m_arena = std::make_unique<BufferArena>(frameCount, static_cast<size_t>(payload), alignment);
+        }
+        catch (std::runtime_error& e)
+        {
+            m_logger->error(std::string(e.what()) + ", letting the SDK allocate frame buffers.");
+        }
+    }
+    if (!m_timing) {
+        m_logger->log("Burst buffers: " + std::to_string(frameCount) + " x " + std::to_string(payload) + " bytes ("
+                      + std::to_string((frameCount * static_cast<size_t>(payload)) >> 20) + " MiB)"
+                      + (m_arena ? std::string(" on ") + m_arena->backing() : std::string(" allocated by the SDK")) + ".");
+    }
+    FramePtrVector frames(frameCount);
+    for (size_t i = 0; i < frameCount; ++i) {
+        frames[i] = FramePtr(m_arena ? new Frame(m_arena->buffer(i), payload)
+                                     : new Frame(payload, FrameAllocation_AnnounceFrame, alignment));
+    }
+
+    ReadFrameMetadata();
+    try
+    {
+        m_records = std::make_unique<FrameRecordStore>(m_saveDir + "/frames.meta", m_tickFrequency);
+    }
+    catch (std::runtime_error& e)
+    {
+        m_logger->error(e.what());
+        throw;
+    }
+
+    // Each wait covers one frame; allow for a long exposure.
+    const VmbUint32_t timeoutMs = 1000 + static_cast<VmbUint32_t>(2.0 * m_frameMetadata.exposure / 1000.0);
+    VmbUint32_t completed = 0;
+    const auto captureStart = std::chrono::steady_clock::now();
+    VmbErrorType err = m_camera->AcquireMultipleImages(frames, timeoutMs, completed);
+    const double captureSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - captureStart).count();
+    // The frames are only handed over once the burst is over, so they all share one host receive time.
+    const int64_t receivedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    if (completed == 0) {
+        m_logger->error("Burst capture failed, err=" + std::to_string(err));
+        throw std::runtime_error("Burst capture failed, err=" + std::to_string(err));
+    }
+    if (err != VmbErrorSuccess) {
+        m_logger->error("Burst stopped after " + std::to_string(completed) + " of " + std::to_string(frameCount) + " frames, err=" + std::to_string(err));
+    }
+
+    std::vector<FrameDescriptor> descriptors(completed);
+    for (size_t i = 0; i < descriptors.size(); ++i) {
+        DescribeFrame(frames[i], descriptors[i]);
+        descriptors[i].receivedNs = receivedNs;
+    }
+    if (!m_timing) {
+        std::string rate;
+        if (descriptors.size() > 1 && descriptors.back().timestamp > descriptors.front().timestamp) {
+            const uint64_t span = descriptors.back().timestamp - descriptors.front().timestamp;
+            rate = ", " + std::to_string((descriptors.size() - 1) * static_cast<double>(m_tickFrequency) / span) + " fps on the camera clock";
+        }
+        m_logger->log("Burst captured: " + std::to_string(completed) + " frames in " + std::to_string(captureSeconds * 1e3) + " ms" + rate + ".");
+    }
+
+    // Drain in parallel, one writer per thread since a FrameWriter keeps per-frame scratch buffers. The writers
+    // share the dirty budget, so the drain leaves no more unwritten data in the page cache than --dirty_mb.
+    const size_t threadCount = std::min<size_t>({std::max(1u, std::thread::hardware_concurrency()), 4, descriptors.size()});
+    std::vector<std::unique_ptr<FrameWriter>> writers;
+    for (size_t t = 0; t < threadCount; ++t) {
+        writers.push_back(CreateWriter(m_saveDir));
+        if (m_dirtyBudget > 0) {
+            writers.back()->SetDirtyBudget(std::max<size_t>(1, m_dirtyBudget / threadCount));
+        }
+    }
+    std::vector<FrameRecord> records(descriptors.size());
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> written{0};
+    const auto drainStart = std::chrono::steady_clock::now();
+    auto drain = [&](FrameWriter& writer) {
+        for (size_t i = next++; i < descriptors.size(); i = next++) {
+            const FrameDescriptor& d = descriptors[i];
+            FrameMetadata meta = m_frameMetadata;
+            meta.frameId = d.frameId;
+            meta.timestamp = d.timestamp;
+            meta.offsetX = d.offsetX;
+            meta.offsetY = d.offsetY;
+
+            FrameRecord& record = records[i];
+            record.frameCounter = i + 1;
+            record.frameId = d.frameId;
+            record.deviceTimestamp = d.timestamp;
+            record.hostTimestamp = d.receivedNs;
+            record.exposure = static_cast<float>(meta.exposure);
+            record.gain = static_cast<float>(meta.gain);
+            record.status = static_cast<uint16_t>(FrameRecordStatus::NotWritten);
+            if (d.status != VmbFrameStatusComplete) {
+                continue;
+            }
+            auto writeStart = std::chrono::steady_clock::now();
+            std::string path = writer.Write(d.buffer, d.bufferSize, DescribePixelFormat(static_cast<VmbPixelFormatType>(d.pixelFormat)),
+                                            d.width, d.height, i + 1, meta);
+            record.writeLatency = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - writeStart).count());
+            record.status = static_cast<uint16_t>(path.empty() ? FrameRecordStatus::WriteFailed : FrameRecordStatus::Written);
+            if (!path.empty()) {
+                written++;
+                m_logger->debug(path + " saved.");
+            }
+        }
+        writer.Flush();
+    };
+    std::vector<std::thread> drainThreads;
+    for (size_t t = 0; t < threadCount; ++t) {
+        drainThreads.emplace_back(drain, std::ref(*writers[t]));
+    }
+    for (std::thread& thread : drainThreads) {
+        thread.join();
+    }
+    const double drainSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - drainStart).count();
+
+    for (const FrameRecord& record : records) {
+        m_records->add(record);
+    }
+    if (!m_records->flush()) {
+        m_logger->error("Could not write frames.meta.");
+    }
+    m_records.reset();
+    if (!m_timing) {
+        m_logger->log("Burst written: " + std::to_string(written.load()) + " of " + std::to_string(completed) + " frames by "
+                      + std::to_string(threadCount) + " threads in " + std::to_string(drainSeconds * 1e3) + " ms.");
+    }
+    std::cout << "Burst of " << completed << " frames captured in " << captureSeconds * 1e3 << " ms, written in " << drainSeconds * 1e3 << " ms." << std::endl;
 }
 
 void Driver::FrameWorkerLoop()
 {
     uint64_t frameCounter = 0;
+    const std::size_t maxTraced = 1 << 20;
     while (m_running) {
-        FramePtr frame = m_queue->pop();
-        if (!frame) {
-            continue;
+        FrameDescriptor descriptor;
+        std::size_t queueDepth = 0;
+        FramePtr frame;
+        if (m_direct) {
+            // Time out now and then to notice Stop().
+            if (!m_descriptors->pop(descriptor, std::chrono::milliseconds(100))) {
+                continue;
+            }
+            queueDepth = m_descriptors->size();
+        }
+        else {
+            frame = m_queue->pop(descriptor.receivedNs, descriptor.deliveredNs, queueDepth);
+            if (!frame) {
+                continue;
+            }
+            DescribeFrame(frame, descriptor);
+        }
+        if (m_deliveryUs.size() < maxTraced) {
+            const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            m_deliveryUs.push_back(static_cast<uint32_t>(std::max<int64_t>(0, now - descriptor.deliveredNs) / 1000));
         }
-        
+
         frameCounter++;
+        if (!m_startupLogged) {
+            MarkStartupPhase("first frame");
+            LogStartupPhases();
+        }
+        HandleFrame(descriptor, queueDepth, frameCounter);
 
-        unsigned char* buffer = nullptr;
-        frame->GetImage(buffer);
+        // The buffer is only handed back once the frame is written, so the camera cannot overwrite it mid-write.
+        if (m_direct) {
+            m_direct->Requeue(descriptor);
+        }
+    }
+}
 
-        VmbUint32_t width=0, height=0;
-        frame->GetWidth(width);
-        frame->GetHeight(height);
+void Driver::HandleFrame(const FrameDescriptor& frame, std::size_t queueDepth, uint64_t frameCounter)
+{
+    unsigned char* buffer = frame.buffer;
+    VmbUint32_t width = frame.width, height = frame.height, bufferSize = frame.bufferSize;
+    PixelLayout layout = DescribePixelFormat(static_cast<VmbPixelFormatType>(frame.pixelFormat));
+
+    FrameMetadata meta = m_frameMetadata;
+    meta.frameId = frame.frameId;
+    meta.timestamp = frame.timestamp;
+    meta.offsetX = frame.offsetX;
+    meta.offsetY = frame.offsetY;
+
+    FrameRecord record = {};
+    record.frameCounter = frameCounter;
+    record.frameId = frame.frameId;
+    record.deviceTimestamp = frame.timestamp;
+    record.hostTimestamp = frame.receivedNs;
+    record.exposure = static_cast<float>(meta.exposure);
+    record.gain = static_cast<float>(meta.gain);
+    record.queueDepth = static_cast<uint16_t>(std::min<std::size_t>(queueDepth, UINT16_MAX));
+    record.status = static_cast<uint16_t>(FrameRecordStatus::NotWritten);
+
+    if (m_calibrationStacker) {
+        AddCalibrationFrame(buffer, layout, width, height);
+        if (m_records) {
+            m_records->add(record);
+        }
+        return;
+    }
 
-        if(!m_processing) {
-            std::ostringstream oss;
-            oss << m_saveDir << "/frame_" << std::setw(6) << std::setfill('0') << frameCounter << ".raw";
+    const uint8_t* data = buffer;
+    if (m_correction) {
+        data = CorrectFrame(buffer, layout, width, height, bufferSize);
+    }
 
-            std::ofstream out(oss.str(), std::ios::out | std::ios::binary);
-            out.write(reinterpret_cast<char*>(buffer), width * height * 3);
+    // With stacking only every Kth frame produces output, numbered by stack.
+    const uint8_t* output = data;
+    PixelLayout outputLayout = layout;
+    VmbUint32_t outputSize = bufferSize;
+    uint64_t outputCounter = frameCounter;
+    if (m_stacker) {
+        output = StackFrame(data, outputLayout, width, height, outputSize);
+        outputCounter = m_stackedFrames;
+    }
+
+    std::string path;
+    if (output && m_ring) {
+        RingFrame ringFrame;
+        ringFrame.bytes = outputSize;
+        ringFrame.layout = outputLayout;
+        ringFrame.width = width;
+        ringFrame.height = height;
+        ringFrame.frameCounter = outputCounter;
+        ringFrame.meta = meta;
+        ringFrame.received = std::chrono::steady_clock::now();
+        if (!m_ring->push(output, ringFrame)) {
+            m_logger->debug("frame_" + std::to_string(outputCounter) + " dropped, ring slot still waiting for flush.");
+        }
+    }
+    else if (output) {
+        auto writeStart = std::chrono::steady_clock::now();
+        path = WriteFrame(output, outputSize, outputLayout, width, height, outputCounter, meta);
+        record.writeLatency = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - writeStart).count());
+        record.status = static_cast<uint16_t>(m_video || m_striped ? FrameRecordStatus::Handed
+                                              : path.empty() ? FrameRecordStatus::WriteFailed : FrameRecordStatus::Written);
+    }
+    if (!path.empty()) {
+        if (!m_processing) {
             if (!m_timing) {
-                m_logger->debug(oss.str() + " saved.");
+                m_logger->debug(path + " saved.");
             }
         }
         else {
-            VmbPixelFormatType pixelFormat;
-            VmbError_t convErr;
-            VmbErrorType formatResult = frame->GetPixelFormat(pixelFormat);
-            VmbImage dstImg = {};
-            dstImg.Size = sizeof(VmbImage);
+            m_logger->log(path + " saved.");
+        }
+    }
+
+    ImageView view;
+    if (m_focusScorer || m_statsEnabled || m_preview || m_autoExposure) {
+        view = AnalysisView(data, layout, width, height, m_analysisUnpacked, m_analysisScratch);
+    }
+    if (!view.empty()) {
+        if (m_statsEnabled || m_autoExposure) {
+            FrameStatsSettings statsSettings = m_statsEnabled ? m_statsSettings : FrameStatsSettings();
+            if (m_autoExposure && !m_statsEnabled) {
+                statsSettings.step = m_autoExposure->settings().sampleStep;
+            }
+            auto start = std::chrono::steady_clock::now();
+            FrameStats stats = ComputeFrameStats(view, statsSettings);
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+            if (m_statsEnabled) {
+                RecordFrameStats(stats, elapsed, record);
+            }
+            if (m_autoExposure) {
+                UpdateAutoExposure(stats, frameCounter);
+            }
+        }
+        if (m_focusScorer) {
+            ScoreFocus(view, frameCounter);
+        }
+        if (m_preview && (frameCounter % m_previewEvery) == 0) {
+            m_preview->publish(view, frameCounter);
+        }
+    }
+    // Added after the analysis, so the record carries the frame's statistics.
+    if (m_records) {
+        m_records->add(record);
+    }
+}
+
+// Method to select the camera pixel format by its feature name, e.g. "Mono12p".
+void Driver::SetPixelFormat(const std::string& pixelFormat)
+{
+    CameraProfile profile;
+    profile.SetEnum(HotFeature::PixelFormat, pixelFormat, true);
+    ProfileResult result = ApplyProfile(m_features, profile);
+    if (result.abortedAt != HotFeature::Count || result.missing > 0)
+    {
+        m_logger->error("Could not set pixel format " + pixelFormat);
+        throw std::runtime_error("Could not set pixel format " + pixelFormat);
+    }
+    if (!m_timing) {
+        m_logger->log("Pixel format set to " + pixelFormat);
+    }
+}
+
+// Method to select the file format used when --processing is enabled.
+void Driver::SetImageFormat(const std::string& imageFormat, bool deflate)
+{
+    m_imageFormat = imageFormat;
+    m_tiffDeflate = deflate;
+}
+
+// Method to cache the exposure and gain that are stored with each frame; auto-exposure keeps the exposure current.
+void Driver::ReadFrameMetadata()
+{
+    FeaturePtr feature;
+    VmbInt64_t tickFrequency = 0;
+    if (m_camera->GetFeatureByName("GevTimestampTickFrequency", feature) == VmbErrorSuccess) {
+        feature->GetValue(tickFrequency);
+    }
+    // USB and MIPI Alvium cameras count timestamps in ns.
+    m_tickFrequency = tickFrequency > 0 ? static_cast<uint64_t>(tickFrequency) : 1000000000ull;
+    // One device/host time pair, so the device timestamps in frames.meta can be placed on the host clock.
+    const int64_t before = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    VmbInt64_t latched = 0;
+    if (m_commands.Execute(m_features, HotFeature::TimestampLatch, std::chrono::milliseconds(100)) == VmbErrorSuccess
+        && m_features.GetInt(HotFeature::TimestampLatchValue, latched) == VmbErrorSuccess && !m_timing) {
+        const int64_t after = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        m_logger->log("Timestamp latch: device " + std::to_string(latched) + " ticks at host " + std::to_string(before + (after - before) / 2)
+                      + " ns, +/- " + std::to_string((after - before) / 2000) + " us.");
+    }
+    m_features.GetFloat(HotFeature::ExposureTime, m_frameMetadata.exposure);
+    m_features.GetFloat(HotFeature::Gain, m_frameMetadata.gain);
+}
+
+// Method to enable live focus scoring on every frame handled by the worker.
+void Driver::EnableFocusScoring(const Rect& roi, FocusMetric metric)
+{
+    m_focusScorer = std::make_unique<FocusScorer>(roi, 0);
+    m_focusMetric = metric;
+    m_bestFocus = -1.0;
+    m_bestFocusFrame = 0;
+    if (!m_timing) {
+        m_logger->log("Focus scoring enabled using " + std::string(FocusMetricName(metric)) + " metric.");
+    }
+}
+
+// Method to enable the per-frame statistics stage; the statistics go to frames.meta.
+void Driver::EnableFrameStats(const FrameStatsSettings& settings)
+{
+    m_statsSettings = settings;
+    m_statsEnabled = true;
+    if (!m_timing) {
+        m_logger->log("Frame statistics enabled on every " + std::to_string(settings.step) + "th pixel.");
+    }
+}
+
+// Method to store the decimated statistics of a frame in its metadata record.
+void Driver::RecordFrameStats(const FrameStats& stats, std::chrono::microseconds elapsed, FrameRecord& record)
+{
+    record.meanLevel = static_cast<float>(stats.mean);
+    record.saturatedPercent = static_cast<float>(stats.saturatedPercent);
+    record.blackPercent = static_cast<float>(stats.blackPercent);
+    record.sharpness = static_cast<float>(stats.sharpness);
+    record.statsLatency = static_cast<uint32_t>(elapsed.count());
+    record.p1 = stats.p1;
+    record.p50 = stats.p50;
+    record.p99 = stats.p99;
+    record.hasStats = 1;
+}
+
+// Method to set up the host-side auto-exposure loop with a cached ExposureTime feature.
+void Driver::EnableAutoExposure(const AutoExposureSettings& settings)
+{
+    double minVal = 0.0, maxVal = 0.0, increment = 0.0, current = 0.0;
+
+    // The camera's own loops would fight the host-side controller.
+    m_features.SetEnum(HotFeature::ExposureAuto, "Off");
+    m_features.SetEnum(HotFeature::GainAuto, "Off");
+
+    const FeaturePtr& exposureTime = m_features.Get(HotFeature::ExposureTime);
+    if (!exposureTime
+            || exposureTime->GetRange(minVal, maxVal) != VmbErrorSuccess
+            || m_features.GetFloat(HotFeature::ExposureTime, current) != VmbErrorSuccess) {
+        m_logger->error("Could not access ExposureTime for auto-exposure.");
+        throw std::runtime_error("Could not access ExposureTime for auto-exposure.");
+    }
+    if (exposureTime->GetIncrement(increment) != VmbErrorSuccess) {
+        increment = 0.0;
+    }
+
+    m_autoExposure = std::make_unique<AutoExposure>(settings, minVal, maxVal, increment);
+    m_autoExposure->reset(current);
+
+    if (!m_timing) {
+        std::string target = settings.target == AutoExposureSettings::Target::Mean
+            ? std::string("mean")
+            : "p" + std::to_string(static_cast<int>(std::round(settings.percentile * 100.0)));
+        m_logger->log("Auto-exposure enabled: " + target + " target " + std::to_string(settings.level) + ", starting at " + std::to_string(current) + " us.");
+    }
+}
+
+// Method to run one auto-exposure step and write the new exposure to the camera.
+void Driver::UpdateAutoExposure(const FrameStats& stats, uint64_t frameCounter)
+{
+    AutoExposureStep step = m_autoExposure->update(stats);
+
+    std::ostringstream oss;
+    oss << "frame_" << std::setw(6) << std::setfill('0') << frameCounter << std::setfill(' ')
+        << std::fixed << std::setprecision(1)
+        << " AE measured=" << step.measured << " target=" << m_autoExposure->settings().level
+        << " exposure=" << step.previous;
+
+    if (!step.changed) {
+        m_logger->debug(oss.str());
+        return;
+    }
+
+    VmbErrorType err = m_features.SetFloat(HotFeature::ExposureTime, step.exposure);
+    if (err != VmbErrorSuccess) {
+        m_logger->error(oss.str() + " could not set exposure to " + std::to_string(step.exposure) + " us, err=" + std::to_string(err));
+        m_autoExposure->reset(step.previous);
+        return;
+    }
+    m_frameMetadata.exposure = step.exposure;
+    oss << " -> " << step.exposure << " us";
+    m_logger->log(oss.str());
+}
+
+// Method to enable the shared-memory preview stream.
+void Driver::EnablePreview(int everyN, uint32_t scale)
+{
+    try
+    {
+        // Size the slots for the full sensor so that the preview survives ROI changes.
+        ROI sensor;
+        m_preview = std::make_unique<PreviewTap>("/alvium_preview", scale, sensor.width, sensor.height, 3);
+    }
+    catch (std::runtime_error& e)
+    {
+        m_logger->error(e.what());
+        throw;
+    }
+    m_previewEvery = std::max(1, everyN);
+    if (!m_timing) {
+        m_logger->log("Preview enabled on /dev/shm/alvium_preview: every " + std::to_string(m_previewEvery) + " frames at 1/" + std::to_string(scale) + " scale.");
+    }
+}
+
+// Method to read back the exposure time used to key the calibration masters.
+double Driver::CurrentExposure()
+{
+    double exposure = 0.0;
+    if (m_features.GetFloat(HotFeature::ExposureTime, exposure) != VmbErrorSuccess) {
+        m_logger->error("Could not read ExposureTime for calibration.");
+        throw std::runtime_error("Could not read ExposureTime for calibration.");
+    }
+    return exposure;
+}
+
+// Method to read back the ROI the camera applied, which may differ from the requested one after rounding to the
+// sensor's increments.
+Rect Driver::CurrentRoi()
+{
+    VmbInt64_t width = 0, height = 0, offsetX = 0, offsetY = 0;
+    if (m_features.GetInt(HotFeature::Width, width) != VmbErrorSuccess || m_features.GetInt(HotFeature::Height, height) != VmbErrorSuccess
+            || m_features.GetInt(HotFeature::OffsetX, offsetX) != VmbErrorSuccess || m_features.GetInt(HotFeature::OffsetY, offsetY) != VmbErrorSuccess) {
+        m_logger->error("Could not read the ROI back from the camera.");
+        throw std::runtime_error("Could not read the ROI back from the camera.");
+    }
+    Rect roi;
+    roi.x = static_cast<uint32_t>(offsetX);
+    roi.y = static_cast<uint32_t>(offsetY);
+    roi.width = static_cast<uint32_t>(width);
+    roi.height = static_cast<uint32_t>(height);
+    return roi;
+}
+
+// Masters are kept per exposure time and ROI, since both change the dark level and the flat.
+std::string Driver::CalibrationPath(const std::string& directory, CalibrationKind kind, double exposure, const Rect& roi) const
+{
+    return directory + "/" + CalibrationFileName(kind, exposure, roi);
+}
+
+// Method to refuse median and sigma-clipped stacks whose frame history would not fit in memory.
+void Driver::CheckStackMemory(StackMethod method, size_t frames, const Rect& roi)
+{
+    if (method == StackMethod::Mean) {
+        return;
+    }
+    const char* format = nullptr;
+    uint64_t channels = 1;
+    if (m_features.GetEnum(HotFeature::PixelFormat, format) == VmbErrorSuccess && format != nullptr
+            && (std::strncmp(format, "RGB", 3) == 0 || std::strncmp(format, "BGR", 3) == 0)) {
+        channels = 3;
+    }
+    // Every frame is kept as 16-bit samples until the stack is reduced.
+    const uint64_t frameBytes = static_cast<uint64_t>(roi.width) * roi.height * channels * sizeof(uint16_t);
+    const uint64_t limit = static_cast<uint64_t>(::sysconf(_SC_PHYS_PAGES)) * static_cast<uint64_t>(::sysconf(_SC_PAGESIZE)) / 2;
+    if (frameBytes > 0 && frames * frameBytes > limit) {
+        const std::string message = std::string(StackMethodName(method)) + " stacking of " + std::to_string(frames) + " frames needs "
+                                  + std::to_string(frames * frameBytes >> 20) + " MB, more than half the memory; use at most "
+                                  + std::to_string(limit / frameBytes) + " frames or mean stacking.";
+        m_logger->error(message);
+        throw std::runtime_error(message);
+    }
+}
+
+// Method to switch the worker from saving frames to stacking a master dark or flat.
+void Driver::EnableCalibrationCapture(CalibrationKind kind, size_t frames, StackMethod method, const std::string& directory)
+{
+    double exposure = CurrentExposure();
+    Rect roi = CurrentRoi();
+    CheckStackMemory(method, frames, roi);
+
+    m_calibrationMaster = CalibrationMaster();
+    m_calibrationMaster.kind = kind;
+    m_calibrationMaster.exposure = exposure;
+    m_calibrationPath = CalibrationPath(directory, kind, exposure, roi);
+    if (!m_stackPool) {
+        m_stackPool = std::make_unique<ThreadPool>(0);
+    }
+    m_calibrationStacker = std::make_unique<FrameStacker>(method, frames, m_stackPool.get());
+    m_calibrationDone = false;
+
+    // Flats are taken relative to the dark level of the same exposure.
+    if (kind == CalibrationKind::Flat) {
+        std::string darkPath = CalibrationPath(directory, CalibrationKind::Dark, exposure, roi);
+        if (!LoadCalibrationMaster(darkPath, m_dark)) {
+            m_dark = CalibrationMaster();
+            m_logger->log("No master dark at " + darkPath + ", flat will include the dark level.");
+        }
+    }
+
+    m_logger->log("Capturing master " + std::string(CalibrationKindName(kind)) + " from " + std::to_string(frames)
+                  + " frames (" + StackMethodName(method) + ") to " + m_calibrationPath);
+}
+
+// Method to stack one calibration frame and write the master once the stack is full.
+void Driver::AddCalibrationFrame(const uint8_t* buffer, const PixelLayout& layout, uint32_t width, uint32_t height)
+{
+    if (m_calibrationDone) {
+        return;
+    }
+    if (!layout.known) {
+        m_logger->error("Cannot calibrate unsupported pixel format " + PixelFormatToString(layout.format));
+        m_calibrationDone = true;
+        return;
+    }
+
+    const size_t samples = static_cast<size_t>(width) * height * layout.channels;
+    m_calibrationSamples.resize(samples);
+    UnpackTo16(buffer, layout.packing, samples, m_calibrationSamples.data());
+    if (!m_calibrationStacker->add(m_calibrationSamples.data(), samples)) {
+        m_logger->error("Calibration frame size changed, frame skipped.");
+        return;
+    }
+    m_logger->debug("Calibration frame " + std::to_string(m_calibrationStacker->frames()) + " stacked.");
+    if (!m_calibrationStacker->full()) {
+        return;
+    }
+
+    CalibrationMaster& master = m_calibrationMaster;
+    master.width = width;
+    master.height = height;
+    master.channels = layout.channels;
+    master.format = layout.format;
+    master.frames = static_cast<uint32_t>(m_calibrationStacker->frames());
+    m_calibrationStacker->finish(master.data);
+
+    if (master.kind == CalibrationKind::Flat) {
+        const uint16_t* dark = m_dark.data.size() == master.data.size() && m_dark.format == master.format ? m_dark.data.data() : nullptr;
+        std::vector<uint16_t> gain(master.data.size());
+        BuildFlatGain(master.data.data(), dark, width, height, layout.channels, gain.data());
+        master.data.swap(gain);
+    }
+
+    try
+    {
+        SaveCalibrationMaster(m_calibrationPath, master);
+        m_logger->log("Saved master " + std::string(CalibrationKindName(master.kind)) + " " + m_calibrationPath);
+    }
+    catch (std::runtime_error& e)
+    {
+        m_logger->error(e.what());
+    }
+    m_calibrationDone = true;
+}
 
-            convErr = VmbSetImageInfoFromPixelFormat(pixelFormat, width, height, &dstImg);
-            
-            dstImg.Data = buffer;
-            frame->GetBufferSize(dstImg.Size);
+// Method to load the masters matching the current exposure and ROI for in-pipeline correction.
+void Driver::EnableCorrection(const std::string& directory)
+{
+    double exposure = CurrentExposure();
+    Rect roi = CurrentRoi();
+    std::string darkPath = CalibrationPath(directory, CalibrationKind::Dark, exposure, roi);
+    std::string flatPath = CalibrationPath(directory, CalibrationKind::Flat, exposure, roi);
+
+    bool haveDark = LoadCalibrationMaster(darkPath, m_dark);
+    bool haveFlat = LoadCalibrationMaster(flatPath, m_flat);
+    if (!haveDark) m_dark = CalibrationMaster();
+    if (!haveFlat) m_flat = CalibrationMaster();
+    if (!haveDark && !haveFlat) {
+        m_logger->error("No calibration masters found for " + darkPath + " or " + flatPath);
+        throw std::runtime_error("No calibration masters found for " + darkPath + " or " + flatPath);
+    }
 
-            cv::Mat output_img(height, width, CV_8UC3, dstImg.Data);
-            std::ostringstream oss;
-            oss << m_saveDir << "/frame_" << std::setw(6) << std::setfill('0') << frameCounter << ".png"; 
+    m_correction = true;
+    m_correctionMismatch = false;
+    if (!m_timing) {
+        m_logger->log("Frame correction enabled:" + std::string(haveDark ? " dark " + darkPath : "") + std::string(haveFlat ? " flat " + flatPath : ""));
+    }
+}
 
-            cv::imwrite(oss.str(), output_img);
-            m_logger->log(oss.str() + " saved.");
+// Method to run the fixed-point dark/flat kernel on a frame before it is written.
+const uint8_t* Driver::CorrectFrame(const uint8_t* buffer, PixelLayout& layout, uint32_t width, uint32_t height, VmbUint32_t& bufferSize)
+{
+    const size_t samples = static_cast<size_t>(width) * height * layout.channels;
+    auto matches = [&](const CalibrationMaster& master) {
+        return master.data.empty() || (master.format == layout.format && master.data.size() == samples);
+    };
+    if (!layout.known || !matches(m_dark) || !matches(m_flat)) {
+        if (!m_correctionMismatch) {
+            m_correctionMismatch = true;
+            m_logger->error("Calibration masters do not match " + PixelFormatToString(layout.format) + " " + std::to_string(width) + "x" + std::to_string(height) + " frames, saving uncorrected.");
         }
+        return buffer;
+    }
+
+    const uint16_t* dark = m_dark.data.empty() ? nullptr : m_dark.data.data();
+    const uint16_t* gain = m_flat.data.empty() ? nullptr : m_flat.data.data();
+
+    if (layout.packing == PixelPacking::Bits8) {
+        m_corrected8.resize(samples);
+        CorrectSamples8(buffer, samples, dark, gain, m_corrected8.data());
+        return m_corrected8.data();
+    }
+
+    // Deeper formats are corrected unpacked; the writer packs them again.
+    m_correctedSamples.resize(samples);
+    UnpackTo16(buffer, layout.packing, samples, m_correctedSamples.data());
+    CorrectSamples16(m_correctedSamples.data(), samples, dark, gain, static_cast<uint16_t>((1u << layout.bitDepth) - 1));
+    layout.packing = PixelPacking::Bits16;
+    bufferSize = static_cast<VmbUint32_t>(samples * sizeof(uint16_t));
+    return reinterpret_cast<const uint8_t*>(m_correctedSamples.data());
+}
 
+// Method to select chunked compression for raw frames; checked here so that a missing codec fails before capture.
+void Driver::EnableCompression(CompressionCodec codec, int level, uint32_t chunkRows)
+{
+    if (!CompressionCodecAvailable(codec)) {
+        m_logger->error(std::string("Compression codec ") + CompressionCodecName(codec) + " is not available in this build.");
+        throw std::runtime_error(std::string("Compression codec ") + CompressionCodecName(codec) + " is not available in this build.");
     }
-}    
+    if (m_processing) {
+        m_logger->log("Compression only applies to raw frames and is ignored with --processing.");
+    }
+    m_compression = codec;
+    m_compressionLevel = level;
+    m_chunkRows = chunkRows;
+}
+
+void Driver::SetStripeTargets(const std::vector<std::string>& directories, StripePolicy policy)
+{
+    m_stripeDirs = directories;
+    m_stripePolicy = policy;
+}
+
+std::unique_ptr<FrameWriter> Driver::CreateWriter(const std::string& dir)
+{
+    auto writer = std::make_unique<FrameWriter>(dir, m_processing, m_imageFormat, m_logger, m_timing);
+    if (m_compression != CompressionCodec::None) {
+        writer->SetCompression(m_compression, m_compressionLevel, m_chunkRows);
+    }
+    writer->SetTiffCompression(m_tiffDeflate);
+    writer->SetDirtyBudget(m_dirtyBudget);
+    writer->SetChecksums(m_journal != nullptr);
+    std::string model;
+    if (m_camera->GetModel(model) == VmbErrorSuccess) {
+        writer->SetCameraModel(model);
+    }
+    return writer;
+}
+
+std::string Driver::WriteFrame(const uint8_t* buffer, VmbUint32_t bufferSize, const PixelLayout& layout, VmbUint32_t width, VmbUint32_t height, uint64_t frameCounter, const FrameMetadata& meta)
+{
+    if (m_video) {
+        if (!m_video->Write(buffer, bufferSize, layout, width, height, frameCounter, meta)) {
+            m_logger->debug("frame_" + std::to_string(frameCounter) + " not encoded.");
+        }
+        return std::string();
+    }
+    if (m_striped) {
+        // The target thread logs the path once the frame is on its way to disk.
+        m_striped->Write(buffer, bufferSize, layout, width, height, frameCounter, meta);
+        return std::string();
+    }
+    std::string path = m_writer->Write(buffer, bufferSize, layout, width, height, frameCounter, meta);
+    if (m_journal && !path.empty()) {
+        m_journal->append(frameCounter, 0, path, m_writer->LastBytes(), m_writer->LastCrc(), meta);
+    }
+    return path;
+}
+
+void Driver::EnableVideo(const VideoSettings& settings)
+{
+    m_videoEnabled = true;
+    m_videoSettings = settings;
+}
+
+void Driver::SetJournalInterval(std::chrono::milliseconds interval)
+{
+    m_journalInterval = interval;
+}
+
+void Driver::SetDirtyBudget(std::size_t budgetBytes)
+{
+    m_dirtyBudget = budgetBytes;
+}
+
+// Method to deliver frames from the VmbC callback through a lock-free ring.
+void Driver::EnableDirectDelivery()
+{
+    m_directDelivery = true;
+}
+
+// Method to log how long frames waited between reaching the driver and reaching the worker.
+void Driver::LogDeliveryLatency()
+{
+    if (m_deliveryUs.empty() || m_timing) {
+        return;
+    }
+    std::vector<uint32_t> us = m_deliveryUs;
+    auto percentile = [&](double p) {
+        std::size_t k = std::min(us.size() - 1, static_cast<std::size_t>(p * (us.size() - 1) + 0.5));
+        std::nth_element(us.begin(), us.begin() + k, us.end());
+        return us[k];
+    };
+    const uint32_t p50 = percentile(0.50);
+    const uint32_t p99 = percentile(0.99);
+    const uint32_t maxUs = *std::max_element(us.begin(), us.end());
+    m_logger->log(std::string("Frame delivery (") + (m_direct ? "direct" : "observer") + "): " + std::to_string(us.size())
+                  + " frames, p50 " + std::to_string(p50) + " us, p99 " + std::to_string(p99) + " us, max " + std::to_string(maxUs) + " us to the worker.");
+}
+
+// Raises a black-box event when the camera reports a line edge.
+class LineEventObserver : public IFeatureObserver
+{
+    public:
+        explicit LineEventObserver(Driver& driver) : m_driver(driver) {}
+
+        void FeatureChanged(const FeaturePtr&) override
+        {
+            m_driver.TriggerEvent();
+        }
+    private:
+        Driver& m_driver;
+};
+
+// Method to set up the pre-trigger RAM ring, sized from the camera payload and the memory budget.
+void Driver::EnableBlackbox(double preSeconds, double postSeconds, size_t ringMegabytes)
+{
+    VmbInt64_t payload = 0;
+    if (m_features.GetInt(HotFeature::PayloadSize, payload) != VmbErrorSuccess || payload <= 0) {
+        m_logger->error("Could not read PayloadSize for the black-box ring.");
+        throw std::runtime_error("Could not read PayloadSize for the black-box ring.");
+    }
+
+    // Corrected 10/12-bit frames are kept unpacked, which needs up to twice the payload.
+    size_t slotBytes = static_cast<size_t>(payload) * (m_correction ? 2 : 1);
+    size_t slots = ringMegabytes * 1024 * 1024 / slotBytes;
+    if (slots < 2) {
+        m_logger->error("Black-box ring of " + std::to_string(ringMegabytes) + " MB holds fewer than two frames.");
+        throw std::runtime_error("Black-box ring of " + std::to_string(ringMegabytes) + " MB holds fewer than two frames.");
+    }
+
+    m_ring = std::make_unique<FrameRing>(slots, slotBytes);
+    m_preEvent = std::chrono::duration<double>(preSeconds);
+    m_postEvent = std::chrono::duration<double>(postSeconds);
+
+    std::string msg = "Black box enabled: " + std::to_string(slots) + " frames in RAM, keeping " + std::to_string(preSeconds)
+                      + " s before and " + std::to_string(postSeconds) + " s after each event.";
+    if (m_mode == "fixed" && m_frameRate > 0 && slots < preSeconds * m_frameRate) {
+        msg += " The ring only covers " + std::to_string(slots / static_cast<double>(m_frameRate)) + " s at " + std::to_string(m_frameRate) + " FPS.";
+    }
+    m_logger->log(msg);
+}
+
+// Method to subscribe to the camera's line edge events.
+void Driver::EnableLineEvent(const std::string& line)
+{
+    FeaturePtr feature;
+    const std::string event = line + "RisingEdge";
+    if (m_camera->GetFeatureByName("EventSelector", feature) != VmbErrorSuccess
+            || feature->SetValue(event.c_str()) != VmbErrorSuccess
+            || m_camera->GetFeatureByName("EventNotification", feature) != VmbErrorSuccess
+            || feature->SetValue("On") != VmbErrorSuccess
+            || m_camera->GetFeatureByName(("Event" + event).c_str(), m_lineEventFeature) != VmbErrorSuccess) {
+        m_logger->error("Camera does not support " + event + " events.");
+        throw std::runtime_error("Camera does not support " + event + " events.");
+    }
+
+    m_lineEventObserver = IFeatureObserverPtr(new LineEventObserver(*this));
+    if (m_lineEventFeature->RegisterObserver(m_lineEventObserver) != VmbErrorSuccess) {
+        m_logger->error("Could not register for " + event + " events.");
+        throw std::runtime_error("Could not register for " + event + " events.");
+    }
+    m_logger->log("Black-box events raised on " + event + ".");
+}
+
+// Method to mark the current pre/post windows for flushing.
+void Driver::TriggerEvent()
+{
+    if (!m_ring) {
+        return;
+    }
+    m_ring->trigger(std::chrono::duration_cast<std::chrono::steady_clock::duration>(m_preEvent),
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(m_postEvent));
+    m_logger->log("Black-box event " + std::to_string(++m_events) + ": flushing the last " + std::to_string(m_preEvent.count())
+                  + " s and recording the next " + std::to_string(m_postEvent.count()) + " s.");
+}
+
+// Flush thread: writes marked ring frames while capture keeps filling the ring.
+void Driver::FlushLoop()
+{
+    RingFrame frame;
+    while (m_ring->next(frame)) {
+        std::string path = WriteFrame(frame.data, static_cast<VmbUint32_t>(frame.bytes), frame.layout, frame.width, frame.height, frame.frameCounter, frame.meta);
+        m_ring->release();
+        if (!path.empty() && !m_timing) {
+            m_logger->debug(path + " flushed.");
+        }
+    }
+}
+
+// Method to enable the temporal stacking stage.
+void Driver::EnableStacking(size_t frames, StackMethod method, double kappa)
+{
+    CheckStackMemory(method, frames, CurrentRoi());
+    if (!m_stackPool) {
+        m_stackPool = std::make_unique<ThreadPool>(0);
+    }
+    m_stacker = std::make_unique<FrameStacker>(method, frames, m_stackPool.get());
+    m_stacker->setSigmaClip(kappa);
+    m_stackedFrames = 0;
+    if (!m_timing) {
+        std::string clip = method == StackMethod::SigmaClippedMean ? " at " + std::to_string(kappa) + " sigma" : "";
+        m_logger->log("Stacking enabled: one " + std::string(StackMethodName(method)) + clip + " frame saved per " + std::to_string(frames) + " frames.");
+    }
+}
+
+// Method to accumulate a frame into the current stack and hand back the result when the stack is complete.
+const uint8_t* Driver::StackFrame(const uint8_t* buffer, PixelLayout& layout, uint32_t width, uint32_t height, VmbUint32_t& bufferSize)
+{
+    if (!layout.known) {
+        return buffer;
+    }
+
+    const size_t samples = static_cast<size_t>(width) * height * layout.channels;
+    bool added = false;
+    if (layout.packing == PixelPacking::Bits8) {
+        added = m_stacker->add(buffer, samples);
+    }
+    else if (layout.packing == PixelPacking::Bits16) {
+        added = m_stacker->add(reinterpret_cast<const uint16_t*>(buffer), samples);
+    }
+    else {
+        m_stackSamples.resize(samples);
+        UnpackTo16(buffer, layout.packing, samples, m_stackSamples.data());
+        added = m_stacker->add(m_stackSamples.data(), samples);
+    }
+
+    if (!added) {
+        // The frame size changed mid-stack; start a new stack from this frame.
+        m_logger->error("Dropped a partial stack of " + std::to_string(m_stacker->frames()) + " frames after a frame size change.");
+        m_stacker->finish(m_stacked);
+        return StackFrame(buffer, layout, width, height, bufferSize);
+    }
+    if (!m_stacker->full()) {
+        return nullptr;
+    }
+
+    // A stack of 8-bit frames is saved as 16-bit 8.8 fixed point, so averaging gains precision rather than
+    // being rounded back to the input depth.
+    const bool widen = layout.packing == PixelPacking::Bits8 && SixteenBitFormat(layout.format) != VmbPixelFormatLast;
+    m_stacker->finish(m_stacked, widen ? 8 : 0);
+    m_stackedFrames++;
+
+    if (widen) {
+        layout = DescribePixelFormat(SixteenBitFormat(layout.format));
+    }
+    else if (layout.packing == PixelPacking::Bits8) {
+        m_stacked8.resize(samples);
+        NarrowTo8(m_stacked.data(), samples, 0, m_stacked8.data());
+        bufferSize = static_cast<VmbUint32_t>(samples);
+        return m_stacked8.data();
+    }
+    layout.packing = PixelPacking::Bits16;
+    bufferSize = static_cast<VmbUint32_t>(samples * sizeof(uint16_t));
+    return reinterpret_cast<const uint8_t*>(m_stacked.data());
+}
+
+// Method to score a frame and print the running best score for manual focusing.
+void Driver::ScoreFocus(const ImageView& img, uint64_t frameCounter)
+{
+    FocusScores scores = m_focusScorer->score(img);
+    double value = FocusScore(scores, m_focusMetric);
+    if (value > m_bestFocus) {
+        m_bestFocus = value;
+        m_bestFocusFrame = frameCounter;
+    }
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2)
+        << "Focus (" << FocusMetricName(m_focusMetric) << "): " << value
+        << "  best: " << m_bestFocus << " (frame " << m_bestFocusFrame << ")";
+    std::cout << "\r" << oss.str() << "    " << std::flush;
+
+    std::ostringstream dbg;
+    dbg << "frame_" << std::setw(6) << std::setfill('0') << frameCounter
+        << " focus laplacian=" << scores.laplacianVariance
+        << " tenengrad=" << scores.tenengrad
+        << " nge=" << scores.normalizedGradientEnergy;
+    m_logger->debug(dbg.str());
+}
 
 
 // Method for stopping camera acquisition
@@ -328,9 +1540,69 @@ void Driver::Stop()
     if (m_workerThread.joinable()) {
         m_workerThread.join();
     }
-    VmbErrorType err = m_camera->StopContinuousImageAcquisition();
+    LogDeliveryLatency();
+    if (m_lineEventFeature) {
+        m_lineEventFeature->UnregisterObserver(m_lineEventObserver);
+        m_lineEventFeature.reset();
+    }
+    if (m_ring) {
+        // Let the flusher finish the windows already marked.
+        m_ring->close();
+        if (m_flushThread.joinable()) {
+            m_flushThread.join();
+        }
+        m_logger->log("Black box: " + std::to_string(m_events.load()) + " events, " + std::to_string(m_ring->dropped()) + " frames dropped.");
+    }
+    if (m_records) {
+        if (!m_records->flush()) {
+            m_logger->error("Could not write frames.meta.");
+        }
+        else if (!m_timing) {
+            m_logger->log("Frame metadata: " + std::to_string(m_records->records()) + " frames in frames.meta.");
+        }
+        m_records.reset();
+    }
+    if (m_video) {
+        m_video->Close();
+    }
+    if (m_striped) {
+        m_striped->Close();
+    }
+    if (m_writer) {
+        m_writer->Flush();
+        m_writer->LogThroughput();
+    }
+    if (m_journal) {
+        if (!m_journal->close()) {
+            m_logger->error("Session journal could not be written completely.");
+        }
+        else if (!m_timing) {
+            m_logger->log("Journal: " + std::to_string(m_journal->records()) + " frames in " + std::to_string(m_journal->commits())
+                          + " commits, slowest commit " + std::to_string(m_journal->maxCommitSeconds() * 1e3) + " ms.");
+        }
+        m_journal.reset();
+    }
+    if (m_stacker && m_stacker->frames() > 0 && !m_timing) {
+        m_logger->log("Discarded incomplete stack of " + std::to_string(m_stacker->frames()) + " frames.");
+    }
+    // Same sequence as StopContinuousImageAcquisition(); the frames are ours to revoke, the arena stays mapped.
+    VmbErrorType err = m_commands.Execute(m_features, HotFeature::AcquisitionStop, std::chrono::seconds(1));
+    if (m_direct) {
+        m_direct->Stop();
+        if (m_direct->incomplete() > 0) {
+            m_logger->log("Direct delivery: " + std::to_string(m_direct->incomplete()) + " incomplete frames requeued.");
+        }
+        m_direct.reset();
+        m_descriptors.reset();
+    }
+    else {
+        RevokeFrames();
+    }
     if (!m_timing) {
     	m_logger->log("Stopped image acquisition.");
+        for (const std::string& line : m_commands.Report()) {
+            m_logger->log("Command " + line);
+        }
     }
     if (err != VmbErrorSuccess)
     {
@@ -340,36 +1612,17 @@ void Driver::Stop()
 }
 
 // Method to configure a fixed frame rate
-void Driver::ConfigureFixedFrameRate()
+void Driver::ConfigureFixedFrameRate(CameraProfile& profile)
 {
-	FeaturePtr pTriggerMode;
-	FeaturePtr pAcqMode;
-	FeaturePtr pFrameRateEnable;
-	FeaturePtr pFrameRate;
-
-
 	// If --framerate flag is between 0 and 30, set the camera feature accordingly.
-	if (m_camera->GetFeatureByName("TriggerMode", pTriggerMode) == VmbErrorSuccess)
-	{
-		pTriggerMode->SetValue("Off");
-	}
+	profile.SetEnum(HotFeature::TriggerMode, "Off");
+	profile.SetEnum(HotFeature::AcquisitionMode, "Continuous");
+	profile.SetBool(HotFeature::AcquisitionFrameRateEnable, true);
 
-	if (m_camera->GetFeatureByName("AcquisitionMode", pAcqMode) == VmbErrorSuccess)
-	{
-		pAcqMode->SetValue("Continuous");
-	}
-
-	if (m_camera->GetFeatureByName("AcquisitionFrameRateEnable", pFrameRateEnable) == VmbErrorSuccess)
-	{
-		pFrameRateEnable->SetValue(true);
-	}
 	if ((m_frameRate > 0) && (m_frameRate <= 30)) {
-		if (m_camera->GetFeatureByName("AcquisitionFrameRate", pFrameRate) == VmbErrorSuccess)
-		{
-			pFrameRate->SetValue((double)m_frameRate);
-			if (!m_timing) {
-				m_logger->log("Frame rate set to " + std::to_string(m_frameRate) + " FPS.");
-			}
+		profile.SetFloat(HotFeature::AcquisitionFrameRate, (double)m_frameRate);
+		if (!m_timing) {
+			m_logger->log("Frame rate set to " + std::to_string(m_frameRate) + " FPS.");
 		}
 	}
 
@@ -381,31 +1634,16 @@ void Driver::ConfigureFixedFrameRate()
 }
 
 // Method that enables a triggered mode
-void Driver::ConfigureTriggerMode()
+void Driver::ConfigureTriggerMode(CameraProfile& profile)
 {
-	FeaturePtr feature;
-
-	if (m_camera->GetFeatureByName("AcquisitionFrameRateEnable", feature) == VmbErrorSuccess)
-	{
-		feature->SetValue(false);
-	}
+	profile.SetBool(HotFeature::AcquisitionFrameRateEnable, false);
 
 	// Enable triggering for frame start
-	if (m_camera->GetFeatureByName("TriggerSelector", feature) == VmbErrorSuccess)
-	{
-		feature->SetValue("FrameStart");
-	}
-
-	if (m_camera->GetFeatureByName("TriggerMode", feature) == VmbErrorSuccess)
-	{
-		feature->SetValue("On");
-	}
+	profile.SetEnum(HotFeature::TriggerSelector, "FrameStart");
+	profile.SetEnum(HotFeature::TriggerMode, "On");
 
 	// Trigger the camera from software
-	if (m_camera->GetFeatureByName("TriggerSource", feature) == VmbErrorSuccess)
-	{
-		feature->SetValue("Software");
-	}
+	profile.SetEnum(HotFeature::TriggerSource, "Software");
 
 	if (!m_timing) {
 		m_logger->log("Camera configured for software trigger.") ;
@@ -413,56 +1651,45 @@ void Driver::ConfigureTriggerMode()
 
 }
 
-// Method to set exposure time of the camera
-void Driver::ConfigureExposureMode()
-{
-	double minVal, maxVal;
-
-	FeaturePtr pFrameRateEnable;
-	FeaturePtr pExposureMode;
-	FeaturePtr pExposureTime;
-	FeaturePtr pExposureAuto;
-	FeaturePtr pGainAuto;
-	FeaturePtr pGammaEnable;
-	FeaturePtr pGain;
-	FeaturePtr pFeature;
-	FeaturePtr pTriggerMode;
-
-	double increment;
-	double expTimeReadback;
-	double finalExposure = m_exposureTime;
-
-	if (m_camera->GetFeatureByName("TriggerMode", pTriggerMode) == VmbErrorSuccess) {
-		pTriggerMode->SetValue("Off");
-	}
+// Method to let the camera run free at the highest frame rate the exposure and ROI allow
+void Driver::ConfigureBurstMode(CameraProfile& profile)
+{
+	profile.SetEnum(HotFeature::TriggerMode, "Off");
+	profile.SetEnum(HotFeature::AcquisitionMode, "Continuous");
+	profile.SetBool(HotFeature::AcquisitionFrameRateEnable, false);
 
-	if (m_camera->GetFeatureByName("AcquisitionFrameRateEnable", pFrameRateEnable) == VmbErrorSuccess) {
-		pFrameRateEnable->SetValue(false);
-	}
-	
-	if (m_camera->GetFeatureByName("ExposureMode", pExposureMode) == VmbErrorSuccess) {
-		pExposureMode->SetValue("Timed");
+	if (!m_timing) {
+		m_logger->log("Camera configured for burst capture at the maximum frame rate.");
 	}
+}
 
-	// Turn off automatic exposure so that we can control it manually.
-	if (m_camera->GetFeatureByName("ExposureAuto", pExposureAuto) == VmbErrorSuccess) {
-		pExposureAuto->SetValue("Off");
-	}
+// Method to set exposure time of the camera
+void Driver::ConfigureExposureMode(CameraProfile& profile)
+{
+	double minVal = 0.0, maxVal = 0.0;
+	double increment = 0.0;
+	double finalExposure = m_exposureTime;
 
-	if (m_camera->GetFeatureByName("GainAuto", pGainAuto) == VmbErrorSuccess) {
-			pGainAuto->SetValue("Off");
-	}
+	// Written before the exposure range is read, since a frame rate limit narrows it.
+	CameraProfile modes;
+	modes.SetEnum(HotFeature::TriggerMode, "Off");
+	modes.SetBool(HotFeature::AcquisitionFrameRateEnable, false);
+	modes.SetEnum(HotFeature::ExposureMode, "Timed");
 
-	if (m_camera->GetFeatureByName("GammaEnable", pGammaEnable) == VmbErrorSuccess) {
-			pGammaEnable->SetValue(false);
-	}
-
-	if (m_camera->GetFeatureByName("Gain", pGain) == VmbErrorSuccess) {
-			pGain->SetValue(0.0);
+	// Turn off automatic exposure so that we can control it manually.
+	modes.SetEnum(HotFeature::ExposureAuto, "Off");
+	modes.SetEnum(HotFeature::GainAuto, "Off");
+	modes.SetBool(HotFeature::GammaEnable, false);
+	modes.SetFloat(HotFeature::Gain, 0.0);
+	ApplyConfiguration(modes, "Exposure mode");
+
+	const FeaturePtr& pExposureTime = m_features.Get(HotFeature::ExposureTime);
+	if (!pExposureTime) {
+		m_logger->error("Camera has no ExposureTime feature.");
+		throw std::runtime_error("Camera has no ExposureTime feature.");
 	}
 
-	if (m_camera->GetFeatureByName("ExposureTime", pExposureTime) == VmbErrorSuccess) {
-			pExposureTime->GetRange(minVal, maxVal);
+	if (pExposureTime->GetRange(minVal, maxVal) == VmbErrorSuccess) {
 			m_logger->debug("Exposure time limits between " + std::to_string(minVal) + " and " + std::to_string(maxVal) + " us.");
 	}
 
@@ -478,21 +1705,7 @@ void Driver::ConfigureExposureMode()
 
 	// If exposure time is within limits, set the exposure time appropriately.
 	if (m_exposureTime > minVal && m_exposureTime < maxVal) {
-		if (m_camera->GetFeatureByName("ExposureTime", pExposureTime) == VmbErrorSuccess) 
-		{
-			pExposureTime->SetValue(finalExposure);
-			if (m_camera->GetFeatureByName("ExposureTime", pFeature) == VmbErrorSuccess)
-			{
-				pFeature->GetValue(expTimeReadback);
-				if (!m_timing) {
-					m_logger->log("Camera set to exposure time of " + std::to_string(expTimeReadback) + " us.");
-				}
-			}
-		}
-		else
-		{
-			m_logger->error("Failed to set exposure time to " + std::to_string(m_exposureTime) + " us.");
-		}
+		profile.SetFloat(HotFeature::ExposureTime, finalExposure);
 	}
 	else {
 		m_logger->error("Exposure time must be set between " + std::to_string(minVal) + " us and " + std::to_string(maxVal) + " us.");
@@ -521,28 +1734,11 @@ void Driver::SetCpuAffinity()
 	}
 }
 
-void Driver::SetROI() {
-    FeaturePtr pWidth;
-    FeaturePtr pHeight;
-    FeaturePtr pOffsetX;
-    FeaturePtr pOffsetY;
-
-    if (m_camera->GetFeatureByName("Width", pWidth) == VmbErrorSuccess)
-    {
-        pWidth->SetValue(m_roi.width);
-    }
-    if (m_camera->GetFeatureByName("Height", pHeight) == VmbErrorSuccess)
-    {
-        pHeight->SetValue(m_roi.height);
-    }
-    if (m_camera->GetFeatureByName("OffsetX", pOffsetX) == VmbErrorSuccess)
-    {
-        pOffsetX->SetValue(m_roi.offsetX);
-    }
-    if (m_camera->GetFeatureByName("OffsetY", pOffsetY) == VmbErrorSuccess)
-    {
-        pOffsetY->SetValue(m_roi.offsetY);
-    }
+void Driver::SetROI(CameraProfile& profile) {
+    profile.SetInt(HotFeature::Width, m_roi.width);
+    profile.SetInt(HotFeature::Height, m_roi.height);
+    profile.SetInt(HotFeature::OffsetX, m_roi.offsetX);
+    profile.SetInt(HotFeature::OffsetY, m_roi.offsetY);
     if (!m_timing)
     {
         m_logger->log("ROI Dimensions - W: " + std::to_string(m_roi.width) + " H: " + std::to_string(m_roi.height) + " Offset X: " + std::to_string(m_roi.offsetX) + " Offset Y: " + std::to_string(m_roi.offsetY));
@@ -0,0 +1,137 @@
+#include "FeatureTable.h"
+
+#include <VmbC/VmbC.h>
+
+namespace VmbCPP {
+namespace Examples {
+
+// In HotFeature order.
+static const char* const kFeatureNames[] = {
+    "TriggerSoftware",
+    "TriggerSelector",
+    "TriggerMode",
+    "TriggerSource",
+    "AcquisitionMode",
+    "AcquisitionStart",
+    "AcquisitionStop",
+    "AcquisitionFrameRateEnable",
+    "AcquisitionFrameRate",
+    "ExposureMode",
+    "ExposureAuto",
+    "ExposureTime",
+    "GainAuto",
+    "Gain",
+    "GammaEnable",
+    "Width",
+    "Height",
+    "OffsetX",
+    "OffsetY",
+    "PayloadSize",
+    "PixelFormat",
+    "TimestampLatch",
+    "TimestampLatchValue",
+};
+static_assert(sizeof(kFeatureNames) / sizeof(kFeatureNames[0]) == static_cast<std::size_t>(HotFeature::Count),
+              "kFeatureNames must list every HotFeature");
+
+const char* HotFeatureName(HotFeature feature)
+{
+    return kFeatureNames[static_cast<std::size_t>(feature)];
+}
+
+void FeatureTable::Resolve(const CameraPtr& camera)
+{
+    m_handle = camera->GetHandle();
+    for (std::size_t i = 0; i < m_features.size(); ++i) {
+        FeaturePtr feature;
+        m_features[i] = camera->GetFeatureByName(kFeatureNames[i], feature) == VmbErrorSuccess ? feature : FeaturePtr();
+    }
+}
+
+VmbErrorType FeatureTable::RunCommand(HotFeature feature) const
+{
+    if (!Has(feature)) {
+        return VmbErrorNotFound;
+    }
+    return static_cast<VmbErrorType>(VmbFeatureCommandRun(m_handle, kFeatureNames[Index(feature)]));
+}
+
+VmbErrorType FeatureTable::IsCommandDone(HotFeature feature, bool& done) const
+{
+    if (!Has(feature)) {
+        return VmbErrorNotFound;
+    }
+    VmbBool_t isDone = VmbBoolFalse;
+    VmbError_t err = VmbFeatureCommandIsDone(m_handle, kFeatureNames[Index(feature)], &isDone);
+    done = isDone == VmbBoolTrue;
+    return static_cast<VmbErrorType>(err);
+}
+
+VmbErrorType FeatureTable::GetFloat(HotFeature feature, double& value) const
+{
+    if (!Has(feature)) {
+        return VmbErrorNotFound;
+    }
+    return static_cast<VmbErrorType>(VmbFeatureFloatGet(m_handle, kFeatureNames[Index(feature)], &value));
+}
+
+VmbErrorType FeatureTable::SetFloat(HotFeature feature, double value) const
+{
+    if (!Has(feature)) {
+        return VmbErrorNotFound;
+    }
+    return static_cast<VmbErrorType>(VmbFeatureFloatSet(m_handle, kFeatureNames[Index(feature)], value));
+}
+
+VmbErrorType FeatureTable::GetInt(HotFeature feature, VmbInt64_t& value) const
+{
+    if (!Has(feature)) {
+        return VmbErrorNotFound;
+    }
+    return static_cast<VmbErrorType>(VmbFeatureIntGet(m_handle, kFeatureNames[Index(feature)], &value));
+}
+
+VmbErrorType FeatureTable::SetInt(HotFeature feature, VmbInt64_t value) const
+{
+    if (!Has(feature)) {
+        return VmbErrorNotFound;
+    }
+    return static_cast<VmbErrorType>(VmbFeatureIntSet(m_handle, kFeatureNames[Index(feature)], value));
+}
+
+VmbErrorType FeatureTable::GetBool(HotFeature feature, bool& value) const
+{
+    if (!Has(feature)) {
+        return VmbErrorNotFound;
+    }
+    VmbBool_t boolValue = VmbBoolFalse;
+    VmbError_t err = VmbFeatureBoolGet(m_handle, kFeatureNames[Index(feature)], &boolValue);
+    value = boolValue == VmbBoolTrue;
+    return static_cast<VmbErrorType>(err);
+}
+
+VmbErrorType FeatureTable::SetBool(HotFeature feature, bool value) const
+{
+    if (!Has(feature)) {
+        return VmbErrorNotFound;
+    }
+    return static_cast<VmbErrorType>(VmbFeatureBoolSet(m_handle, kFeatureNames[Index(feature)], value ? VmbBoolTrue : VmbBoolFalse));
+}
+
+VmbErrorType FeatureTable::GetEnum(HotFeature feature, const char*& value) const
+{
+    if (!Has(feature)) {
+        return VmbErrorNotFound;
+    }
+    return static_cast<VmbErrorType>(VmbFeatureEnumGet(m_handle, kFeatureNames[Index(feature)], &value));
+}
+
+VmbErrorType FeatureTable::SetEnum(HotFeature feature, const char* value) const
+{
+    if (!Has(feature)) {
+        return VmbErrorNotFound;
+    }
+    return static_cast<VmbErrorType>(VmbFeatureEnumSet(m_handle, kFeatureNames[Index(feature)], value));
+}
+
+}} // namespace VmbCPP
@@ -0,0 +1,195 @@
+#include "FocusMetrics.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+
+namespace {
+
+	struct FocusAccum {
+		int64_t lapSum = 0;
+		uint64_t lapSq = 0;
+		uint64_t sobelSq = 0;
+		uint64_t gradSq = 0;
+		uint64_t lumaSum = 0;
+		uint64_t count = 0;
+
+		void add(const FocusAccum& o) {
+			lapSum += o.lapSum;
+			lapSq += o.lapSq;
+			sobelSq += o.sobelSq;
+			gradSq += o.gradSq;
+			lumaSum += o.lumaSum;
+			count += o.count;
+		}
+	};
+
+#if defined(__aarch64__)
+	inline int16x8_t Load8(const uint8_t* p)
+	{
+		return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(p)));
+	}
+
+	inline uint32x4_t SumSquaresLow(int16x8_t a, int16x8_t b)
+	{
+		return vreinterpretq_u32_s32(vmlal_s16(vmull_s16(vget_low_s16(a), vget_low_s16(a)), vget_low_s16(b), vget_low_s16(b)));
+	}
+
+	inline uint32x4_t SumSquaresHigh(int16x8_t a, int16x8_t b)
+	{
+		return vreinterpretq_u32_s32(vmlal_high_s16(vmull_high_s16(a, a), b, b));
+	}
+#endif
+
+	// Accumulate all metrics for the interior pixels of row r, given the luma rows above (a) and below (b).
+	void AccumulateRow(const uint8_t* a, const uint8_t* r, const uint8_t* b, uint32_t w, FocusAccum& acc)
+	{
+		if (w < 3) return;
+
+		uint32_t x = 1;
+#if defined(__aarch64__)
+		int32x4_t lapSum = vdupq_n_s32(0);
+		uint64x2_t lapSq = vdupq_n_u64(0);
+		uint64x2_t sobelSq = vdupq_n_u64(0);
+		uint64x2_t gradSq = vdupq_n_u64(0);
+		uint32x4_t lumaSum = vdupq_n_u32(0);
+
+		for (; x + 8 < w; x += 8) {
+			int16x8_t am = Load8(a + x - 1), a0 = Load8(a + x), ap = Load8(a + x + 1);
+			int16x8_t rm = Load8(r + x - 1), r0 = Load8(r + x), rp = Load8(r + x + 1);
+			int16x8_t bm = Load8(b + x - 1), b0 = Load8(b + x), bp = Load8(b + x + 1);
+
+			int16x8_t lap = vsubq_s16(vaddq_s16(vaddq_s16(a0, b0), vaddq_s16(rm, rp)), vshlq_n_s16(r0, 2));
+			int16x8_t gx = vsubq_s16(vaddq_s16(vaddq_s16(ap, bp), vshlq_n_s16(rp, 1)),
+			                         vaddq_s16(vaddq_s16(am, bm), vshlq_n_s16(rm, 1)));
+			int16x8_t gy = vsubq_s16(vaddq_s16(vaddq_s16(bm, bp), vshlq_n_s16(b0, 1)),
+			                         vaddq_s16(vaddq_s16(am, ap), vshlq_n_s16(a0, 1)));
+			int16x8_t dx = vsubq_s16(rp, r0);
+			int16x8_t dy = vsubq_s16(b0, r0);
+
+			lapSum = vpadalq_s16(lapSum, lap);
+			lapSq = vpadalq_u32(lapSq, vreinterpretq_u32_s32(vaddq_s32(vmull_s16(vget_low_s16(lap), vget_low_s16(lap)), vmull_high_s16(lap, lap))));
+			sobelSq = vpadalq_u32(sobelSq, SumSquaresLow(gx, gy));
+			sobelSq = vpadalq_u32(sobelSq, SumSquaresHigh(gx, gy));
+			gradSq = vpadalq_u32(gradSq, SumSquaresLow(dx, dy));
+			gradSq = vpadalq_u32(gradSq, SumSquaresHigh(dx, dy));
+			lumaSum = vpadalq_u16(lumaSum, vreinterpretq_u16_s16(r0));
+		}
+
+		acc.lapSum += vaddlvq_s32(lapSum);
+		acc.lapSq += vaddvq_u64(lapSq);
+		acc.sobelSq += vaddvq_u64(sobelSq);
+		acc.gradSq += vaddvq_u64(gradSq);
+		acc.lumaSum += vaddlvq_u32(lumaSum);
+#endif
+		for (; x + 1 < w; ++x) {
+			int lap = a[x] + b[x] + r[x - 1] + r[x + 1] - 4 * r[x];
+			int gx = (a[x + 1] + 2 * r[x + 1] + b[x + 1]) - (a[x - 1] + 2 * r[x - 1] + b[x - 1]);
+			int gy = (b[x - 1] + 2 * b[x] + b[x + 1]) - (a[x - 1] + 2 * a[x] + a[x + 1]);
+			int dx = r[x + 1] - r[x];
+			int dy = b[x] - r[x];
+
+			acc.lapSum += lap;
+			acc.lapSq += static_cast<uint64_t>(lap * lap);
+			acc.sobelSq += static_cast<uint64_t>(gx * gx + gy * gy);
+			acc.gradSq += static_cast<uint64_t>(dx * dx + dy * dy);
+			acc.lumaSum += r[x];
+		}
+		acc.count += w - 2;
+	}
+}
+
+
+FocusMetric ParseFocusMetric(const std::string& name)
+{
+	if (name == "laplacian") return FocusMetric::LaplacianVariance;
+	if (name == "tenengrad") return FocusMetric::Tenengrad;
+	if (name == "nge") return FocusMetric::NormalizedGradientEnergy;
+	throw std::invalid_argument("Unknown focus metric: " + name);
+}
+
+const char* FocusMetricName(FocusMetric metric)
+{
+	switch (metric)
+	{
+		case FocusMetric::LaplacianVariance:		return "laplacian";
+		case FocusMetric::Tenengrad:			return "tenengrad";
+		case FocusMetric::NormalizedGradientEnergy:	return "nge";
+	}
+	return "unknown";
+}
+
+double FocusScore(const FocusScores& scores, FocusMetric metric)
+{
+	switch (metric)
+	{
+		case FocusMetric::LaplacianVariance:		return scores.laplacianVariance;
+		case FocusMetric::Tenengrad:			return scores.tenengrad;
+		case FocusMetric::NormalizedGradientEnergy:	return scores.normalizedGradientEnergy;
+	}
+	return 0.0;
+}
+
+
+FocusScorer::FocusScorer(const Rect& roi, std::size_t numThreads)
+	: roi(roi), pool(numThreads)
+{
+	// A few bands per thread keeps the workers busy when rows differ in cost.
+	scratch.resize(pool.size() * 2);
+}
+
+FocusScores FocusScorer::score(const ImageView& img)
+{
+	FocusScores scores;
+	if (img.empty()) return scores;
+
+	const Rect r = ClipRect(roi, img);
+	if (r.width < 3 || r.height < 3) return scores;
+
+	// Rows with a neighbour above and below inside the ROI.
+	const uint32_t firstRow = r.y + 1;
+	const uint32_t lastRow = r.y + r.height - 1;
+	const std::size_t bands = std::min<std::size_t>(scratch.size(), lastRow - firstRow);
+	const uint32_t rowsPerBand = (lastRow - firstRow + bands - 1) / bands;
+
+	std::vector<FocusAccum> partial(bands);
+
+	pool.parallelFor(bands, [&](std::size_t band) {
+		uint32_t y0 = firstRow + static_cast<uint32_t>(band) * rowsPerBand;
+		uint32_t y1 = std::min(lastRow, y0 + rowsPerBand);
+		if (y0 >= y1) return;
+
+		std::vector<uint8_t>& buf = scratch[band];
+		buf.resize(3 * static_cast<std::size_t>(r.width));
+		uint8_t* above = buf.data();
+		uint8_t* cur = above + r.width;
+		uint8_t* below = cur + r.width;
+
+		LumaRow(img, y0 - 1, r.x, r.width, above);
+		LumaRow(img, y0, r.x, r.width, cur);
+		for (uint32_t y = y0; y < y1; ++y) {
+			LumaRow(img, y + 1, r.x, r.width, below);
+			AccumulateRow(above, cur, below, r.width, partial[band]);
+			std::swap(above, cur);
+			std::swap(cur, below);
+		}
+	});
+
+	FocusAccum total;
+	for (const auto& p : partial) {
+		total.add(p);
+	}
+	if (total.count == 0) return scores;
+
+	const double n = static_cast<double>(total.count);
+	const double lapMean = total.lapSum / n;
+	scores.laplacianVariance = total.lapSq / n - lapMean * lapMean;
+	scores.tenengrad = total.sobelSq / n;
+	scores.meanLuma = total.lumaSum / n;
+	scores.normalizedGradientEnergy = (total.gradSq / n) / std::max(1.0, scores.meanLuma * scores.meanLuma);
+	return scores;
+}
@@ -0,0 +1,106 @@
+#include "FrameDescriptorRing.h"
+
+#include <ctime>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Spins before sleeping; a frame that is already on its way is cheaper to wait for than a futex round trip.
+static const int kSpins = 256;
+
+static inline void CpuRelax()
+{
+#if defined(__aarch64__)
+	asm volatile("yield" ::: "memory");
+#elif defined(__x86_64__) || defined(__i386__)
+	asm volatile("pause" ::: "memory");
+#endif
+}
+
+static uint32_t* FutexWord(std::atomic<uint32_t>& word)
+{
+	static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex needs a plain 32-bit word");
+	return reinterpret_cast<uint32_t*>(&word);
+}
+
+FrameDescriptorRing::FrameDescriptorRing(std::size_t capacity)
+{
+	std::size_t size = 1;
+	while (size < capacity) {
+		size <<= 1;
+	}
+	slots.resize(size);
+	mask = size - 1;
+}
+
+bool FrameDescriptorRing::push(const FrameDescriptor& frame)
+{
+	const uint64_t h = head.load(std::memory_order_relaxed);
+	if (h - tail.load(std::memory_order_acquire) > mask) {
+		drops.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	slots[h & mask] = frame;
+	// seq_cst so that the sleeping check below cannot be ordered before the publish (pairs with pop()).
+	head.store(h + 1, std::memory_order_seq_cst);
+	wake();
+	return true;
+}
+
+void FrameDescriptorRing::wake()
+{
+	signal.fetch_add(1, std::memory_order_seq_cst);
+	if (sleeping.load(std::memory_order_seq_cst)) {
+		syscall(SYS_futex, FutexWord(signal), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+	}
+}
+
+bool FrameDescriptorRing::pop(FrameDescriptor& frame, std::chrono::milliseconds timeout)
+{
+	const auto deadline = std::chrono::steady_clock::now() + timeout;
+	const uint64_t t = tail.load(std::memory_order_relaxed);
+	int spins = 0;
+	while (true) {
+		if (head.load(std::memory_order_acquire) != t) {
+			frame = slots[t & mask];
+			tail.store(t + 1, std::memory_order_release);
+			return true;
+		}
+		if (closed.load(std::memory_order_acquire)) {
+			return false;
+		}
+		if (spins < kSpins) {
+			spins++;
+			CpuRelax();
+			continue;
+		}
+
+		auto remaining = deadline - std::chrono::steady_clock::now();
+		if (remaining <= std::chrono::steady_clock::duration::zero()) {
+			return false;
+		}
+		const uint32_t seen = signal.load(std::memory_order_seq_cst);
+		sleeping.store(true, std::memory_order_seq_cst);
+		if (head.load(std::memory_order_seq_cst) == t && !closed.load(std::memory_order_seq_cst)) {
+			auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+			struct timespec ts;
+			ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+			ts.tv_nsec = static_cast<long>(ns % 1000000000);
+			// Returns at once if a push bumped signal since it was read.
+			syscall(SYS_futex, FutexWord(signal), FUTEX_WAIT_PRIVATE, seen, &ts, nullptr, 0);
+		}
+		sleeping.store(false, std::memory_order_relaxed);
+	}
+}
+
+void FrameDescriptorRing::close()
+{
+	closed.store(true, std::memory_order_seq_cst);
+	wake();
+}
+
+std::size_t FrameDescriptorRing::size() const
+{
+	return static_cast<std::size_t>(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+}
@@ -0,0 +1,49 @@
+#include "FrameRecordStore.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+
+FrameRecordStore::FrameRecordStore(const std::string& path, uint64_t tickFrequency, std::size_t batchRecords)
+	: batchSize(std::max<std::size_t>(1, batchRecords))
+{
+	file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file) {
+		throw std::runtime_error("Could not create " + path);
+	}
+
+	char header[kHeaderBytes] = {'A', 'L', 'V', 'M', 'E', 'T', 'A', '1'};
+	const uint32_t recordSize = sizeof(FrameRecord);
+	const int64_t created = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	std::memcpy(header + 8, &recordSize, 4);
+	std::memcpy(header + 16, &tickFrequency, 8);
+	std::memcpy(header + 24, &created, 8);
+	file.write(header, sizeof(header));
+	batch.reserve(batchSize);
+}
+
+FrameRecordStore::~FrameRecordStore()
+{
+	flush();
+}
+
+void FrameRecordStore::add(const FrameRecord& record)
+{
+	batch.push_back(record);
+	if (batch.size() >= batchSize) {
+		flush();
+	}
+}
+
+bool FrameRecordStore::flush()
+{
+	if (!batch.empty()) {
+		file.write(reinterpret_cast<const char*>(batch.data()), batch.size() * sizeof(FrameRecord));
+		written += batch.size();
+		batch.clear();
+	}
+	file.flush();
+	return static_cast<bool>(file);
+}
@@ -0,0 +1,122 @@
+#include "FrameRing.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <sys/mman.h>
+
+
+FrameRing::FrameRing(std::size_t slots, std::size_t slotBytes)
+	: slotCount(std::max<std::size_t>(1, slots)), slotSize(slotBytes), frames(slotCount)
+{
+	// Touch every page now so that capture never waits on a page fault, and keep them resident if allowed.
+	memory.assign(slotCount * slotSize, 0);
+	::mlock(memory.data(), memory.size());
+}
+
+bool FrameRing::isPending(uint64_t frame) const
+{
+	for (const Window& window : pending) {
+		if (frame >= window.begin && frame < window.end) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Mark frames [begin, end) for flushing, joining the last window if they follow straight on.
+void FrameRing::mark(uint64_t begin, uint64_t end)
+{
+	if (begin >= end) {
+		return;
+	}
+	if (!pending.empty() && pending.back().end == begin) {
+		pending.back().end = end;
+	}
+	else {
+		pending.push_back({begin, end});
+	}
+	flushEnd = end;
+	cv.notify_one();
+}
+
+bool FrameRing::push(const uint8_t* data, const RingFrame& frame)
+{
+	std::unique_lock<std::mutex> lock(mtx);
+	if (closed || frame.bytes > slotSize) {
+		droppedFrames++;
+		return false;
+	}
+
+	// The frame previously in this slot may still be waiting for the flusher.
+	if (written >= slotCount && isPending(written - slotCount)) {
+		droppedFrames++;
+		return false;
+	}
+
+	const std::size_t slot = written % slotCount;
+	uint8_t* dst = &memory[slot * slotSize];
+	lock.unlock();
+
+	// The new frame is not visible to the flusher until written is advanced, and trigger() never walks back
+	// onto the frame it replaces, so copy without the lock.
+	std::memcpy(dst, data, frame.bytes);
+
+	lock.lock();
+	frames[slot] = frame;
+	frames[slot].data = dst;
+	written++;
+	if (frame.received <= postDeadline) {
+		mark(written - 1, written);
+	}
+	return true;
+}
+
+void FrameRing::trigger(std::chrono::steady_clock::duration pre, std::chrono::steady_clock::duration post)
+{
+	const auto now = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> lock(mtx);
+
+	// Walk back over the frames still in the ring that fall inside the pre-event window. The oldest frame's
+	// slot is the one push() fills next, possibly right now, so it is left out, as are frames already marked.
+	uint64_t first = written;
+	const uint64_t oldest = std::max<uint64_t>(written >= slotCount ? written - slotCount + 1 : 0, flushEnd);
+	while (first > oldest && now - frames[(first - 1) % slotCount].received <= pre) {
+		first--;
+	}
+	mark(first, written);
+	postDeadline = std::max(postDeadline, now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(post));
+	cv.notify_one();
+}
+
+bool FrameRing::next(RingFrame& frame)
+{
+	std::unique_lock<std::mutex> lock(mtx);
+	cv.wait(lock, [&] { return !pending.empty() || closed; });
+	if (pending.empty()) {
+		return false;
+	}
+	frame = frames[pending.front().begin % slotCount];
+	return true;
+}
+
+void FrameRing::release()
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	if (!pending.empty() && ++pending.front().begin == pending.front().end) {
+		pending.pop_front();
+	}
+}
+
+void FrameRing::close()
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	closed = true;
+	cv.notify_all();
+}
+
+uint64_t FrameRing::dropped() const
+{
+	std::lock_guard<std::mutex> lock(mtx);
+	return droppedFrames;
+}
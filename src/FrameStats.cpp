@@ -0,0 +1,88 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+
+uint8_t HistogramPercentile(const std::array<uint32_t, 256>& histogram, uint64_t samples, double fraction)
+{
+	if (samples == 0) return 0;
+
+	const double target = fraction * samples;
+	uint64_t cumulative = 0;
+	for (int level = 0; level < 256; ++level) {
+		cumulative += histogram[level];
+		if (cumulative >= target) {
+			return static_cast<uint8_t>(level);
+		}
+	}
+	return 255;
+}
+
+FrameStats ComputeFrameStats(const ImageView& img, const FrameStatsSettings& settings)
+{
+	FrameStats stats;
+	if (img.empty()) return stats;
+
+	const uint32_t step = std::max<uint32_t>(1, settings.step);
+	// Green sits in the middle of RGB/BGR pixels; mono and raw Bayer data only have one channel.
+	const uint32_t channel = img.channels >= 3 ? 1 : 0;
+	const std::size_t sampleStride = static_cast<std::size_t>(step) * img.channels;
+	// Every sample needs its right-hand neighbour for the sharpness term.
+	const uint32_t samplesPerRow = (img.width - 1 + step - 1) / step;
+
+	// Four interleaved histograms so that consecutive samples of equal value do not serialise on one counter.
+	std::array<std::array<uint32_t, 256>, 4> hist{};
+	uint64_t gradient = 0;
+
+	for (uint32_t y = 0; y < img.height; y += step) {
+		const uint8_t* p = img.row(y) + channel;
+		uint32_t rowGradient = 0;
+		uint32_t i = 0;
+		for (; i + 4 <= samplesPerRow; i += 4) {
+			const uint8_t* q = p + i * sampleStride;
+			uint8_t v0 = q[0];
+			uint8_t v1 = q[sampleStride];
+			uint8_t v2 = q[2 * sampleStride];
+			uint8_t v3 = q[3 * sampleStride];
+			++hist[0][v0];
+			++hist[1][v1];
+			++hist[2][v2];
+			++hist[3][v3];
+			rowGradient += std::abs(q[img.channels] - v0)
+				     + std::abs(q[sampleStride + img.channels] - v1)
+				     + std::abs(q[2 * sampleStride + img.channels] - v2)
+				     + std::abs(q[3 * sampleStride + img.channels] - v3);
+		}
+		for (; i < samplesPerRow; ++i) {
+			const uint8_t* q = p + i * sampleStride;
+			++hist[0][q[0]];
+			rowGradient += std::abs(q[img.channels] - q[0]);
+		}
+		gradient += rowGradient;
+		stats.samples += samplesPerRow;
+	}
+
+	if (stats.samples == 0) return stats;
+
+	uint64_t sum = 0;
+	uint64_t black = 0;
+	uint64_t saturated = 0;
+	for (int level = 0; level < 256; ++level) {
+		uint32_t count = hist[0][level] + hist[1][level] + hist[2][level] + hist[3][level];
+		stats.histogram[level] = count;
+		sum += static_cast<uint64_t>(count) * level;
+		if (level <= settings.blackLevel) black += count;
+		if (level >= settings.saturatedLevel) saturated += count;
+	}
+
+	const double n = static_cast<double>(stats.samples);
+	stats.mean = sum / n;
+	stats.p1 = HistogramPercentile(stats.histogram, stats.samples, 0.01);
+	stats.p50 = HistogramPercentile(stats.histogram, stats.samples, 0.50);
+	stats.p99 = HistogramPercentile(stats.histogram, stats.samples, 0.99);
+	stats.blackPercent = 100.0 * black / n;
+	stats.saturatedPercent = 100.0 * saturated / n;
+	stats.sharpness = gradient / n;
+	return stats;
+}
@@ -0,0 +1,331 @@
+#include "FrameWriter.h"
+#include "Crc32.h"
+#include "Utils.h"
+
+#include <opencv2/opencv.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <sys/stat.h>
+
+namespace VmbCPP {
+namespace Examples {
+
+FrameWriter::FrameWriter(const std::string& saveDir, bool processing, const std::string& imageFormat, std::shared_ptr<::Logger> logger, bool timing) :
+    m_saveDir(saveDir), m_processing(processing), m_imageFormat(imageFormat), m_logger(logger), m_timing(timing)
+{
+    if (m_imageFormat == "tiff" || m_imageFormat == "dng") {
+        m_tiff = std::make_unique<TiffWriter>(m_imageFormat == "dng", false);
+    }
+}
+
+std::string FrameWriter::FramePath(uint64_t frameCounter, const std::string& extension) const
+{
+    std::ostringstream oss;
+    oss << m_saveDir << "/frame_" << std::setw(6) << std::setfill('0') << frameCounter << "." << extension;
+    return oss.str();
+}
+
+// Record the size of a file just written and closed; only its inode is read.
+void FrameWriter::SetLastFile(const std::string& path, uint32_t crc)
+{
+    struct stat st;
+    m_lastBytes = ::stat(path.c_str(), &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+    m_lastCrc = crc;
+}
+
+std::string FrameWriter::Write(const uint8_t* buffer, VmbUint32_t bufferSize, const PixelLayout& layout, VmbUint32_t width, VmbUint32_t height, uint64_t frameCounter, const FrameMetadata& meta)
+{
+    if (buffer == nullptr) {
+        return std::string();
+    }
+    if (m_processing && layout.known && m_tiff) {
+        return WriteTiff(buffer, bufferSize, layout, width, height, frameCounter, meta);
+    }
+    if (m_processing && layout.known) {
+        return WriteImage(buffer, bufferSize, layout, width, height, frameCounter);
+    }
+    return WriteRaw(buffer, bufferSize, layout, width, height, frameCounter);
+}
+
+// Store the frame bytes, packing 16-bit containers of 10/12-bit data.
+std::string FrameWriter::WriteRaw(const uint8_t* buffer, VmbUint32_t bufferSize, const PixelLayout& layout, VmbUint32_t width, VmbUint32_t height, uint64_t frameCounter)
+{
+    const uint8_t* data = buffer;
+    std::size_t bytes = bufferSize;
+    PixelPacking storage = layout.packing;
+
+    if (layout.known) {
+        bytes = ImageBytes(layout.packing, layout.channels, width, height);
+        if (bytes > bufferSize) {
+            // A short or incomplete payload; packing it would read past the buffer.
+            m_logger->error("Frame buffer smaller than a " + std::to_string(width) + "x" + std::to_string(height) + " image.");
+            return std::string();
+        }
+        storage = CompactPacking(layout);
+        if (storage != layout.packing) {
+            const std::size_t samples = static_cast<std::size_t>(width) * height * layout.channels;
+            m_packed.resize(ImageBytes(storage, layout.channels, width, height));
+            bytes = PackFrom16(reinterpret_cast<const uint16_t*>(buffer), samples, storage, m_packed.data());
+            data = m_packed.data();
+        }
+    }
+
+    if (!m_formatLogged) {
+        m_formatLogged = true;
+        if (!layout.known) {
+            m_logger->error("Unsupported pixel format " + PixelFormatToString(layout.format) + ", raw frames hold the unmodified " + std::to_string(bufferSize) + " byte buffer.");
+        }
+        else if (!m_timing) {
+            m_logger->log("Raw frames stored as " + StorageFormatName(layout, storage) + " " + std::to_string(width) + "x" + std::to_string(height) + ", " + std::to_string(bytes) + " bytes per frame.");
+        }
+    }
+
+    if (m_compressor && layout.known) {
+        return WriteCompressed(data, bytes, layout, storage, width, height, frameCounter);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::string path = FramePath(frameCounter, "raw");
+    if (m_writeBehind) {
+        if (!m_writeBehind->write(path, data, bytes, frameCounter)) {
+            m_logger->error(m_writeBehind->error());
+            return std::string();
+        }
+        LogRetireFailures();
+    }
+    else {
+        std::ofstream out(path, std::ios::out | std::ios::binary);
+        out.write(reinterpret_cast<const char*>(data), bytes);
+        out.close();
+        if (!out) {
+            m_logger->error("Could not write " + path);
+            return std::string();
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    m_lastBytes = bytes;
+    m_lastCrc = m_checksums ? Crc32(data, bytes) : 0;
+    m_writeSeconds += seconds;
+    m_maxWriteSeconds = std::max(m_maxWriteSeconds, seconds);
+    m_framesWritten++;
+    m_rawBytes += bytes;
+    m_storedBytes += bytes;
+    return path;
+}
+
+// Compress the stored frame bytes in row chunks and write them as a .rawz file.
+std::string FrameWriter::WriteCompressed(const uint8_t* data, std::size_t bytes, const PixelLayout& layout, PixelPacking storage, VmbUint32_t width, VmbUint32_t height, uint64_t frameCounter)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::size_t chunkBytes = ImageBytes(storage, layout.channels, width, m_chunkRows);
+    std::size_t compressed = m_compressor->compress(data, bytes, chunkBytes);
+    auto compressedAt = std::chrono::steady_clock::now();
+    if (compressed == 0) {
+        m_logger->error("Could not compress frame " + std::to_string(frameCounter));
+        return std::string();
+    }
+
+    RawzInfo info;
+    info.width = width;
+    info.height = height;
+    info.channels = layout.channels;
+    info.bitDepth = layout.bitDepth;
+    info.format = StorageFormatName(layout, storage);
+    info.chunkRows = m_chunkRows;
+    info.frameId = frameCounter;
+
+    std::string path = FramePath(frameCounter, "rawz");
+    uint32_t crc = 0;
+    if (!m_compressor->write(path, info, m_checksums ? &crc : nullptr)) {
+        m_logger->error("Could not write " + path);
+        return std::string();
+    }
+    auto end = std::chrono::steady_clock::now();
+    SetLastFile(path, crc);
+
+    m_compressSeconds += std::chrono::duration<double>(compressedAt - start).count();
+    m_writeSeconds += std::chrono::duration<double>(end - compressedAt).count();
+    m_framesWritten++;
+    m_rawBytes += bytes;
+    m_storedBytes += compressed;
+    return path;
+}
+
+// Write the frame as TIFF/DNG with its metadata, straight from the frame buffer where the layout allows.
+std::string FrameWriter::WriteTiff(const uint8_t* buffer, VmbUint32_t bufferSize, const PixelLayout& layout, VmbUint32_t width, VmbUint32_t height, uint64_t frameCounter, const FrameMetadata& meta)
+{
+    const std::size_t samples = static_cast<std::size_t>(width) * height * layout.channels;
+    if (ImageBytes(layout.packing, layout.channels, width, height) > bufferSize) {
+        m_logger->error("Frame buffer smaller than a " + std::to_string(width) + "x" + std::to_string(height) + " image.");
+        return std::string();
+    }
+
+    const bool dng = m_imageFormat == "dng" && layout.channels == 1;
+    const uint8_t* data = buffer;
+    uint32_t bits = layout.packing == PixelPacking::Bits8 ? 8 : 16;
+
+    if (layout.packing != PixelPacking::Bits8 && (layout.packing != PixelPacking::Bits16 || (!dng && layout.bitDepth < 16))) {
+        // Packed data is expanded; plain TIFF is MSB-aligned like the PNG output, DNG keeps the sensor range
+        // and records it as the white level.
+        m_unpacked.resize(samples);
+        UnpackTo16(buffer, layout.packing, samples, m_unpacked.data());
+        if (!dng && layout.bitDepth < 16) {
+            const uint32_t shift = 16 - layout.bitDepth;
+            for (auto& v : m_unpacked) v = static_cast<uint16_t>(v << shift);
+        }
+        data = reinterpret_cast<const uint8_t*>(m_unpacked.data());
+    }
+
+    if (layout.channels == 3 && layout.bgr) {
+        // TIFF stores RGB.
+        const std::size_t sampleBytes = bits / 8;
+        m_swapped.resize(samples * sampleBytes);
+        for (std::size_t p = 0; p < samples; p += 3) {
+            std::memcpy(&m_swapped[p * sampleBytes], data + (p + 2) * sampleBytes, sampleBytes);
+            std::memcpy(&m_swapped[(p + 1) * sampleBytes], data + (p + 1) * sampleBytes, sampleBytes);
+            std::memcpy(&m_swapped[(p + 2) * sampleBytes], data + p * sampleBytes, sampleBytes);
+        }
+        data = m_swapped.data();
+    }
+
+    std::string path = FramePath(frameCounter, m_imageFormat);
+    const uint32_t significant = dng ? layout.bitDepth : bits;
+    uint32_t crc = 0;
+    if (!m_tiff->write(path, data, width, height, layout.channels, bits, significant, BayerPattern(layout.format), meta, m_checksums ? &crc : nullptr)) {
+        m_logger->error("Could not write " + path);
+        return std::string();
+    }
+    SetLastFile(path, crc);
+    return path;
+}
+
+void FrameWriter::SetTiffCompression(bool deflate)
+{
+    if (m_tiff && deflate != m_tiff->compressed()) {
+        m_tiff = std::make_unique<TiffWriter>(m_imageFormat == "dng", deflate);
+    }
+}
+
+void FrameWriter::SetCameraModel(const std::string& model)
+{
+    if (m_tiff) {
+        m_tiff->setModel(model);
+    }
+}
+
+void FrameWriter::SetCompression(CompressionCodec codec, int level, uint32_t chunkRows)
+{
+    // Whole 10p/12p pixel groups per chunk, so every chunk starts on a byte boundary.
+    m_chunkRows = std::max<uint32_t>(4, (chunkRows + 3) / 4 * 4);
+    m_compressor = std::make_unique<ChunkedCompressor>(codec, level);
+    if (!m_timing) {
+        m_logger->log("Raw frames compressed with " + std::string(CompressionCodecName(codec)) + " level " + std::to_string(level)
+                      + " in chunks of " + std::to_string(m_chunkRows) + " rows.");
+    }
+}
+
+void FrameWriter::SetDirtyBudget(std::size_t budgetBytes)
+{
+    Flush();
+    m_writeBehind.reset();
+    if (budgetBytes > 0) {
+        m_writeBehind = std::make_unique<WriteBehind>(budgetBytes);
+    }
+}
+
+void FrameWriter::Flush()
+{
+    if (m_writeBehind) {
+        m_writeBehind->drain();
+        LogRetireFailures();
+    }
+}
+
+// Earlier frames that failed on their way to the disk, each under its own frame counter.
+void FrameWriter::LogRetireFailures()
+{
+    for (const auto& failure : m_writeBehind->failures()) {
+        m_logger->error("frame_" + std::to_string(failure.id) + " lost after writing: " + failure.message);
+    }
+}
+
+void FrameWriter::LogThroughput() const
+{
+    if (m_framesWritten == 0 || m_writeSeconds <= 0.0) {
+        return;
+    }
+    // The write times cover handing the data to the kernel (and, with a dirty budget, waiting for older frames
+    // to be written back), not the device itself, so this is the rate the page cache accepted, not a disk rate.
+    const double frames = static_cast<double>(m_framesWritten);
+    const double acceptRate = m_storedBytes / m_writeSeconds;
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2)
+        << "Writer: " << m_framesWritten << " frames, " << m_rawBytes / frames / 1e6 << " MB/frame";
+    if (m_compressor) {
+        oss << ", " << CompressionCodecName(m_compressor->codec()) << " ratio " << static_cast<double>(m_rawBytes) / m_storedBytes
+            << ", compress " << m_compressSeconds / frames * 1e3 << " ms/frame"
+            << ", write() " << m_writeSeconds / frames * 1e3 << " ms/frame at " << acceptRate / 1e6 << " MB/s into the page cache";
+    }
+    else {
+        oss << ", write() " << m_writeSeconds / frames * 1e3 << " ms/frame (max " << m_maxWriteSeconds * 1e3 << " ms) at " << acceptRate / 1e6 << " MB/s into the page cache";
+        if (m_writeBehind) {
+            oss << ", " << m_writeBehind->waits() << " waits on the " << m_writeBehind->budget() / (1 << 20)
+                << " MB dirty budget (" << m_writeBehind->waitSeconds() << " s)";
+        }
+    }
+    m_logger->log(oss.str());
+}
+
+// Convert the frame to an OpenCV image and write it as PNG or TIFF.
+std::string FrameWriter::WriteImage(const uint8_t* buffer, VmbUint32_t bufferSize, const PixelLayout& layout, VmbUint32_t width, VmbUint32_t height, uint64_t frameCounter)
+{
+    const std::size_t samples = static_cast<std::size_t>(width) * height * layout.channels;
+    if (ImageBytes(layout.packing, layout.channels, width, height) > bufferSize) {
+        m_logger->error("Frame buffer smaller than a " + std::to_string(width) + "x" + std::to_string(height) + " image.");
+        return std::string();
+    }
+
+    cv::Mat image;
+    if (layout.packing == PixelPacking::Bits8) {
+        image = cv::Mat(height, width, layout.channels == 3 ? CV_8UC3 : CV_8UC1, const_cast<uint8_t*>(buffer));
+    }
+    else {
+        m_unpacked.resize(samples);
+        UnpackTo16(buffer, layout.packing, samples, m_unpacked.data());
+        cv::Mat unpacked(height, width, layout.channels == 3 ? CV_16UC3 : CV_16UC1, m_unpacked.data());
+        // Scale to the full 16-bit range so that viewers show the image at the right brightness.
+        unpacked.convertTo(image, unpacked.type(), static_cast<double>(1u << (16 - layout.bitDepth)));
+    }
+
+    if (layout.channels == 3 && !layout.bgr) {
+        cv::Mat bgr;
+        cv::cvtColor(image, bgr, cv::COLOR_RGB2BGR);
+        image = bgr;
+    }
+
+    // Encoded in memory so that the file's CRC comes from the buffer rather than from reading the file back.
+    std::string path = FramePath(frameCounter, m_imageFormat);
+    if (!cv::imencode("." + m_imageFormat, image, m_encoded)) {
+        m_logger->error("Could not encode " + path);
+        return std::string();
+    }
+    std::ofstream out(path, std::ios::out | std::ios::binary);
+    out.write(reinterpret_cast<const char*>(m_encoded.data()), m_encoded.size());
+    out.close();
+    if (!out) {
+        m_logger->error("Could not write " + path);
+        return std::string();
+    }
+    m_lastBytes = m_encoded.size();
+    m_lastCrc = m_checksums ? Crc32(m_encoded.data(), m_encoded.size()) : 0;
+    return path;
+}
+
+}} // namespace VmbCPP
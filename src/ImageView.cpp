@@ -0,0 +1,56 @@
+#include "ImageView.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+
+Rect ClipRect(const Rect& rect, const ImageView& img)
+{
+	Rect r = rect;
+	if (r.width == 0 || r.height == 0) {
+		return Rect{0, 0, img.width, img.height};
+	}
+	r.x = std::min(r.x, img.width);
+	r.y = std::min(r.y, img.height);
+	r.width = std::min(r.width, img.width - r.x);
+	r.height = std::min(r.height, img.height - r.y);
+	return r;
+}
+
+void LumaRow(const ImageView& img, uint32_t y, uint32_t x0, uint32_t count, uint8_t* dst)
+{
+	const uint8_t* src = img.row(y) + static_cast<std::size_t>(x0) * img.channels;
+
+	if (img.channels == 1) {
+		std::memcpy(dst, src, count);
+		return;
+	}
+
+	uint32_t x = 0;
+	if (img.channels == 3) {
+#if defined(__aarch64__)
+		for (; x + 16 <= count; x += 16) {
+			uint8x16x3_t px = vld3q_u8(src + 3 * x);
+			uint16x8_t lo = vaddl_u8(vget_low_u8(px.val[0]), vget_low_u8(px.val[2]));
+			uint16x8_t hi = vaddl_u8(vget_high_u8(px.val[0]), vget_high_u8(px.val[2]));
+			lo = vaddq_u16(lo, vshll_n_u8(vget_low_u8(px.val[1]), 1));
+			hi = vaddq_u16(hi, vshll_n_u8(vget_high_u8(px.val[1]), 1));
+			vst1q_u8(dst + x, vcombine_u8(vshrn_n_u16(lo, 2), vshrn_n_u16(hi, 2)));
+		}
+#endif
+		for (; x < count; ++x) {
+			const uint8_t* p = src + 3 * x;
+			dst[x] = static_cast<uint8_t>((p[0] + 2 * p[1] + p[2]) >> 2);
+		}
+		return;
+	}
+
+	// Other layouts (e.g. 4-channel): take the second channel, which is green for RGB-ordered data.
+	for (; x < count; ++x) {
+		dst[x] = src[x * img.channels + 1];
+	}
+}
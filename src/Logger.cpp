@@ -41,14 +41,20 @@ void Logger::debug(const std::string& msg) {
 }
 
 void Logger::addToBuffer(const std::string& message) {
+	std::lock_guard<std::mutex> lock(mtx);
 	buffer.push_back(message);
 
 	if (buffer.size() >= maxBufferSize) {
-		save();
+		writeBuffer();
 	}
 }
 
 void Logger::save() {
+	std::lock_guard<std::mutex> lock(mtx);
+	writeBuffer();
+}
+
+void Logger::writeBuffer() {
 	if (!logfile.is_open()) return;
 
 	for (const auto& entry : buffer) {
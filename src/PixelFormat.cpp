@@ -0,0 +1,396 @@
+#include "PixelFormat.h"
+
+#include <cstring>
+#include <string>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+
+namespace {
+
+	struct FormatEntry {
+		VmbPixelFormatType format;
+		PixelPacking packing;
+		uint32_t channels;
+		uint32_t bitDepth;
+		bool bgr;
+		const char* name;
+	};
+
+	const FormatEntry kFormats[] = {
+		{VmbPixelFormatMono8,		PixelPacking::Bits8,		1, 8,  false, "Mono8"},
+		{VmbPixelFormatMono10,		PixelPacking::Bits16,		1, 10, false, "Mono10"},
+		{VmbPixelFormatMono10p,		PixelPacking::Packed10p,	1, 10, false, "Mono10"},
+		{VmbPixelFormatMono12,		PixelPacking::Bits16,		1, 12, false, "Mono12"},
+		{VmbPixelFormatMono12p,		PixelPacking::Packed12p,	1, 12, false, "Mono12"},
+		{VmbPixelFormatMono12Packed,	PixelPacking::Packed12Gev,	1, 12, false, "Mono12"},
+		{VmbPixelFormatMono14,		PixelPacking::Bits16,		1, 14, false, "Mono14"},
+		{VmbPixelFormatMono16,		PixelPacking::Bits16,		1, 16, false, "Mono16"},
+		{VmbPixelFormatBayerRG8,	PixelPacking::Bits8,		1, 8,  false, "BayerRG8"},
+		{VmbPixelFormatBayerBG8,	PixelPacking::Bits8,		1, 8,  false, "BayerBG8"},
+		{VmbPixelFormatBayerGR8,	PixelPacking::Bits8,		1, 8,  false, "BayerGR8"},
+		{VmbPixelFormatBayerGB8,	PixelPacking::Bits8,		1, 8,  false, "BayerGB8"},
+		{VmbPixelFormatBayerRG10,	PixelPacking::Bits16,		1, 10, false, "BayerRG10"},
+		{VmbPixelFormatBayerBG10,	PixelPacking::Bits16,		1, 10, false, "BayerBG10"},
+		{VmbPixelFormatBayerGR10,	PixelPacking::Bits16,		1, 10, false, "BayerGR10"},
+		{VmbPixelFormatBayerGB10,	PixelPacking::Bits16,		1, 10, false, "BayerGB10"},
+		{VmbPixelFormatBayerRG10p,	PixelPacking::Packed10p,	1, 10, false, "BayerRG10"},
+		{VmbPixelFormatBayerBG10p,	PixelPacking::Packed10p,	1, 10, false, "BayerBG10"},
+		{VmbPixelFormatBayerGR10p,	PixelPacking::Packed10p,	1, 10, false, "BayerGR10"},
+		{VmbPixelFormatBayerGB10p,	PixelPacking::Packed10p,	1, 10, false, "BayerGB10"},
+		{VmbPixelFormatBayerRG12,	PixelPacking::Bits16,		1, 12, false, "BayerRG12"},
+		{VmbPixelFormatBayerBG12,	PixelPacking::Bits16,		1, 12, false, "BayerBG12"},
+		{VmbPixelFormatBayerGR12,	PixelPacking::Bits16,		1, 12, false, "BayerGR12"},
+		{VmbPixelFormatBayerGB12,	PixelPacking::Bits16,		1, 12, false, "BayerGB12"},
+		{VmbPixelFormatBayerRG12p,	PixelPacking::Packed12p,	1, 12, false, "BayerRG12"},
+		{VmbPixelFormatBayerBG12p,	PixelPacking::Packed12p,	1, 12, false, "BayerBG12"},
+		{VmbPixelFormatBayerGR12p,	PixelPacking::Packed12p,	1, 12, false, "BayerGR12"},
+		{VmbPixelFormatBayerGB12p,	PixelPacking::Packed12p,	1, 12, false, "BayerGB12"},
+		{VmbPixelFormatBayerRG12Packed,	PixelPacking::Packed12Gev,	1, 12, false, "BayerRG12"},
+		{VmbPixelFormatBayerBG12Packed,	PixelPacking::Packed12Gev,	1, 12, false, "BayerBG12"},
+		{VmbPixelFormatBayerGR12Packed,	PixelPacking::Packed12Gev,	1, 12, false, "BayerGR12"},
+		{VmbPixelFormatBayerGB12Packed,	PixelPacking::Packed12Gev,	1, 12, false, "BayerGB12"},
+		{VmbPixelFormatBayerRG16,	PixelPacking::Bits16,		1, 16, false, "BayerRG16"},
+		{VmbPixelFormatBayerBG16,	PixelPacking::Bits16,		1, 16, false, "BayerBG16"},
+		{VmbPixelFormatBayerGR16,	PixelPacking::Bits16,		1, 16, false, "BayerGR16"},
+		{VmbPixelFormatBayerGB16,	PixelPacking::Bits16,		1, 16, false, "BayerGB16"},
+		{VmbPixelFormatRgb8,		PixelPacking::Bits8,		3, 8,  false, "RGB8"},
+		{VmbPixelFormatBgr8,		PixelPacking::Bits8,		3, 8,  true,  "BGR8"},
+		{VmbPixelFormatRgb10,		PixelPacking::Bits16,		3, 10, false, "RGB10"},
+		{VmbPixelFormatBgr10,		PixelPacking::Bits16,		3, 10, true,  "BGR10"},
+		{VmbPixelFormatRgb12,		PixelPacking::Bits16,		3, 12, false, "RGB12"},
+		{VmbPixelFormatBgr12,		PixelPacking::Bits16,		3, 12, true,  "BGR12"},
+		{VmbPixelFormatRgb14,		PixelPacking::Bits16,		3, 14, false, "RGB14"},
+		{VmbPixelFormatBgr14,		PixelPacking::Bits16,		3, 14, true,  "BGR14"},
+		{VmbPixelFormatRgb16,		PixelPacking::Bits16,		3, 16, false, "RGB16"},
+		{VmbPixelFormatBgr16,		PixelPacking::Bits16,		3, 16, true,  "BGR16"},
+	};
+
+	const FormatEntry* FindFormat(VmbPixelFormatType pixelFormat)
+	{
+		for (const auto& entry : kFormats) {
+			if (entry.format == pixelFormat) {
+				return &entry;
+			}
+		}
+		return nullptr;
+	}
+
+	void UnpackScalar10p(const uint8_t* src, std::size_t count, uint16_t* dst)
+	{
+		std::size_t i = 0;
+		for (; i + 4 <= count; i += 4, src += 5) {
+			uint64_t v = static_cast<uint64_t>(src[0]) | static_cast<uint64_t>(src[1]) << 8 | static_cast<uint64_t>(src[2]) << 16
+				   | static_cast<uint64_t>(src[3]) << 24 | static_cast<uint64_t>(src[4]) << 32;
+			dst[i]     = static_cast<uint16_t>(v & 0x3FF);
+			dst[i + 1] = static_cast<uint16_t>((v >> 10) & 0x3FF);
+			dst[i + 2] = static_cast<uint16_t>((v >> 20) & 0x3FF);
+			dst[i + 3] = static_cast<uint16_t>((v >> 30) & 0x3FF);
+		}
+		for (std::size_t k = 0; i < count; ++i, ++k) {
+			std::size_t bit = 10 * k;
+			uint32_t v = src[bit / 8] | src[bit / 8 + 1] << 8;
+			dst[i] = static_cast<uint16_t>((v >> (bit % 8)) & 0x3FF);
+		}
+	}
+
+	void UnpackScalar12p(const uint8_t* src, std::size_t count, uint16_t* dst)
+	{
+		std::size_t i = 0;
+		for (; i + 2 <= count; i += 2, src += 3) {
+			dst[i]     = static_cast<uint16_t>(src[0] | (src[1] & 0x0F) << 8);
+			dst[i + 1] = static_cast<uint16_t>(src[1] >> 4 | src[2] << 4);
+		}
+		if (i < count) {
+			dst[i] = static_cast<uint16_t>(src[0] | (src[1] & 0x0F) << 8);
+		}
+	}
+
+#if defined(__aarch64__)
+	// Unpack 8 samples of a continuously packed format: gather the two bytes that hold each sample into a
+	// 16-bit lane, shift each lane right by its bit offset and mask.
+	inline uint16x8_t UnpackLanes(const uint8_t* src, uint8x16_t gather, int16x8_t shifts, uint16x8_t mask)
+	{
+		uint8x16_t bytes = vqtbl1q_u8(vld1q_u8(src), gather);
+		return vandq_u16(vshlq_u16(vreinterpretq_u16_u8(bytes), shifts), mask);
+	}
+#endif
+
+	void Unpack10p(const uint8_t* src, std::size_t count, uint16_t* dst)
+	{
+		std::size_t i = 0;
+#if defined(__aarch64__)
+		static const uint8_t gatherBytes[16] = {0, 1, 1, 2, 2, 3, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9};
+		static const int16_t shiftValues[8] = {0, -2, -4, -6, 0, -2, -4, -6};
+		const uint8x16_t gather = vld1q_u8(gatherBytes);
+		const int16x8_t shifts = vld1q_s16(shiftValues);
+		const uint16x8_t mask = vdupq_n_u16(0x3FF);
+		// 8 samples use 10 bytes but the load reads 16, so stop early enough to stay inside the buffer.
+		for (; i + 16 <= count; i += 8, src += 10) {
+			vst1q_u16(dst + i, UnpackLanes(src, gather, shifts, mask));
+		}
+#endif
+		UnpackScalar10p(src, count - i, dst + i);
+	}
+
+	void Unpack12p(const uint8_t* src, std::size_t count, uint16_t* dst)
+	{
+		std::size_t i = 0;
+#if defined(__aarch64__)
+		static const uint8_t gatherBytes[16] = {0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11};
+		static const int16_t shiftValues[8] = {0, -4, 0, -4, 0, -4, 0, -4};
+		const uint8x16_t gather = vld1q_u8(gatherBytes);
+		const int16x8_t shifts = vld1q_s16(shiftValues);
+		const uint16x8_t mask = vdupq_n_u16(0xFFF);
+		for (; i + 16 <= count; i += 8, src += 12) {
+			vst1q_u16(dst + i, UnpackLanes(src, gather, shifts, mask));
+		}
+#endif
+		UnpackScalar12p(src, count - i, dst + i);
+	}
+
+	void Unpack12Gev(const uint8_t* src, std::size_t count, uint16_t* dst)
+	{
+		std::size_t i = 0;
+		for (; i + 2 <= count; i += 2, src += 3) {
+			dst[i]     = static_cast<uint16_t>(src[0] << 4 | (src[1] & 0x0F));
+			dst[i + 1] = static_cast<uint16_t>(src[2] << 4 | src[1] >> 4);
+		}
+		if (i < count) {
+			dst[i] = static_cast<uint16_t>(src[0] << 4 | (src[1] & 0x0F));
+		}
+	}
+
+	std::size_t Pack10p(const uint16_t* src, std::size_t count, uint8_t* dst)
+	{
+		uint8_t* out = dst;
+		std::size_t i = 0;
+		for (; i + 4 <= count; i += 4, out += 5) {
+			uint64_t v = static_cast<uint64_t>(src[i] & 0x3FF) | static_cast<uint64_t>(src[i + 1] & 0x3FF) << 10
+				   | static_cast<uint64_t>(src[i + 2] & 0x3FF) << 20 | static_cast<uint64_t>(src[i + 3] & 0x3FF) << 30;
+			out[0] = static_cast<uint8_t>(v);
+			out[1] = static_cast<uint8_t>(v >> 8);
+			out[2] = static_cast<uint8_t>(v >> 16);
+			out[3] = static_cast<uint8_t>(v >> 24);
+			out[4] = static_cast<uint8_t>(v >> 32);
+		}
+		if (i < count) {
+			uint64_t v = 0;
+			std::size_t rest = count - i;
+			for (std::size_t k = 0; k < rest; ++k) {
+				v |= static_cast<uint64_t>(src[i + k] & 0x3FF) << (10 * k);
+			}
+			std::size_t bytes = (10 * rest + 7) / 8;
+			for (std::size_t k = 0; k < bytes; ++k) {
+				*out++ = static_cast<uint8_t>(v >> (8 * k));
+			}
+		}
+		return out - dst;
+	}
+
+	std::size_t Pack12p(const uint16_t* src, std::size_t count, uint8_t* dst)
+	{
+		uint8_t* out = dst;
+		std::size_t i = 0;
+#if defined(__aarch64__)
+		const uint16x8_t low4 = vdupq_n_u16(0x0F);
+		for (; i + 16 <= count; i += 16, out += 24) {
+			uint16x8x2_t px = vld2q_u16(src + i);
+			uint8x8x3_t bytes;
+			bytes.val[0] = vmovn_u16(px.val[0]);
+			bytes.val[1] = vmovn_u16(vorrq_u16(vandq_u16(vshrq_n_u16(px.val[0], 8), low4), vshlq_n_u16(vandq_u16(px.val[1], low4), 4)));
+			bytes.val[2] = vmovn_u16(vshrq_n_u16(px.val[1], 4));
+			vst3_u8(out, bytes);
+		}
+#endif
+		for (; i + 2 <= count; i += 2, out += 3) {
+			out[0] = static_cast<uint8_t>(src[i]);
+			out[1] = static_cast<uint8_t>((src[i] >> 8 & 0x0F) | (src[i + 1] & 0x0F) << 4);
+			out[2] = static_cast<uint8_t>(src[i + 1] >> 4);
+		}
+		if (i < count) {
+			out[0] = static_cast<uint8_t>(src[i]);
+			out[1] = static_cast<uint8_t>(src[i] >> 8 & 0x0F);
+			out += 2;
+		}
+		return out - dst;
+	}
+}
+
+
+PixelLayout DescribePixelFormat(VmbPixelFormatType pixelFormat)
+{
+	PixelLayout layout;
+	layout.format = pixelFormat;
+	if (const FormatEntry* entry = FindFormat(pixelFormat)) {
+		layout.packing = entry->packing;
+		layout.channels = entry->channels;
+		layout.bitDepth = entry->bitDepth;
+		layout.bgr = entry->bgr;
+		layout.known = true;
+	}
+	return layout;
+}
+
+VmbPixelFormatType SixteenBitFormat(VmbPixelFormatType pixelFormat)
+{
+	const FormatEntry* entry = FindFormat(pixelFormat);
+	if (entry == nullptr) return VmbPixelFormatLast;
+
+	// Same name up to the bit depth: "BayerGR" of "BayerGR8" matches "BayerGR16".
+	const std::size_t stem = std::strcspn(entry->name, "0123456789");
+	for (const auto& candidate : kFormats) {
+		if (candidate.bitDepth == 16 && candidate.channels == entry->channels
+				&& std::strlen(candidate.name) == stem + 2 && std::strncmp(candidate.name, entry->name, stem) == 0) {
+			return candidate.format;
+		}
+	}
+	return VmbPixelFormatLast;
+}
+
+std::size_t ImageBytes(PixelPacking packing, uint32_t channels, uint32_t width, uint32_t height)
+{
+	const std::size_t samples = static_cast<std::size_t>(width) * height * channels;
+	switch (packing)
+	{
+		case PixelPacking::Bits8:	return samples;
+		case PixelPacking::Bits16:	return samples * 2;
+		case PixelPacking::Packed10p:	return (samples * 10 + 7) / 8;
+		case PixelPacking::Packed12p:
+		case PixelPacking::Packed12Gev:	return (samples * 12 + 7) / 8;
+	}
+	return samples;
+}
+
+PixelPacking CompactPacking(const PixelLayout& layout)
+{
+	if (layout.packing == PixelPacking::Bits16) {
+		if (layout.bitDepth == 10) return PixelPacking::Packed10p;
+		if (layout.bitDepth == 12) return PixelPacking::Packed12p;
+	}
+	return layout.packing;
+}
+
+std::string StorageFormatName(const PixelLayout& layout, PixelPacking packing)
+{
+	const FormatEntry* entry = FindFormat(layout.format);
+	if (entry == nullptr) return "Unknown";
+
+	std::string name = entry->name;
+	if (packing == PixelPacking::Packed10p || packing == PixelPacking::Packed12p) {
+		name += "p";
+	}
+	else if (packing == PixelPacking::Packed12Gev) {
+		name += "Packed";
+	}
+	return name;
+}
+
+PixelLayout ParseStorageFormat(const std::string& name)
+{
+	for (const auto& entry : kFormats) {
+		PixelLayout layout = DescribePixelFormat(entry.format);
+		const PixelPacking packings[] = {layout.packing, CompactPacking(layout)};
+		for (PixelPacking packing : packings) {
+			if (StorageFormatName(layout, packing) == name) {
+				layout.packing = packing;
+				return layout;
+			}
+		}
+	}
+	return PixelLayout();
+}
+
+std::string BayerPattern(VmbPixelFormatType pixelFormat)
+{
+	const FormatEntry* entry = FindFormat(pixelFormat);
+	if (entry == nullptr || std::strncmp(entry->name, "Bayer", 5) != 0) return std::string();
+
+	// "BayerRG" names the first row; the second row holds the other two colours in swapped order.
+	const char a = entry->name[5];
+	const char b = entry->name[6];
+	const char c = a == 'G' ? (b == 'R' ? 'B' : 'R') : 'G';
+	const char d = a == 'G' ? 'G' : (a == 'R' ? 'B' : 'R');
+	return std::string{a, b, c, d};
+}
+
+void UnpackTo16(const uint8_t* src, PixelPacking packing, std::size_t count, uint16_t* dst)
+{
+	switch (packing)
+	{
+		case PixelPacking::Bits8:
+			for (std::size_t i = 0; i < count; ++i) dst[i] = src[i];
+			break;
+		case PixelPacking::Bits16:
+			std::memcpy(dst, src, count * 2);
+			break;
+		case PixelPacking::Packed10p:
+			Unpack10p(src, count, dst);
+			break;
+		case PixelPacking::Packed12p:
+			Unpack12p(src, count, dst);
+			break;
+		case PixelPacking::Packed12Gev:
+			Unpack12Gev(src, count, dst);
+			break;
+	}
+}
+
+std::size_t PackFrom16(const uint16_t* src, std::size_t count, PixelPacking packing, uint8_t* dst)
+{
+	switch (packing)
+	{
+		case PixelPacking::Packed10p:
+			return Pack10p(src, count, dst);
+		case PixelPacking::Packed12p:
+			return Pack12p(src, count, dst);
+		default:
+			std::memcpy(dst, src, count * 2);
+			return count * 2;
+	}
+}
+
+void NarrowTo8(const uint16_t* src, std::size_t count, uint32_t shift, uint8_t* dst)
+{
+	std::size_t i = 0;
+#if defined(__aarch64__)
+	const int16x8_t shifts = vdupq_n_s16(-static_cast<int16_t>(shift));
+	for (; i + 16 <= count; i += 16) {
+		uint8x8_t lo = vqmovn_u16(vshlq_u16(vld1q_u16(src + i), shifts));
+		uint8x8_t hi = vqmovn_u16(vshlq_u16(vld1q_u16(src + i + 8), shifts));
+		vst1q_u8(dst + i, vcombine_u8(lo, hi));
+	}
+#endif
+	for (; i < count; ++i) {
+		uint32_t v = src[i] >> shift;
+		dst[i] = static_cast<uint8_t>(v > 255 ? 255 : v);
+	}
+}
+
+ImageView AnalysisView(const uint8_t* buffer, const PixelLayout& layout, uint32_t width, uint32_t height,
+		       std::vector<uint16_t>& unpacked, std::vector<uint8_t>& scratch)
+{
+	ImageView view;
+	if (buffer == nullptr || width == 0 || height == 0) {
+		return view;
+	}
+	view.width = width;
+	view.height = height;
+	view.channels = layout.channels;
+	view.stride = static_cast<std::size_t>(width) * layout.channels;
+
+	if (layout.packing == PixelPacking::Bits8) {
+		view.data = buffer;
+		return view;
+	}
+
+	const std::size_t samples = view.stride * height;
+	unpacked.resize(samples);
+	scratch.resize(samples);
+	UnpackTo16(buffer, layout.packing, samples, unpacked.data());
+	NarrowTo8(unpacked.data(), samples, layout.bitDepth > 8 ? layout.bitDepth - 8 : 0, scratch.data());
+	view.data = scratch.data();
+	return view;
+}
@@ -0,0 +1,174 @@
+#include "PreviewTap.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+
+namespace {
+
+	constexpr uint32_t kSlotCount = 3;
+	constexpr std::size_t kHeaderBytes = 64;
+	constexpr std::size_t kSlotHeaderBytes = 64;
+	constexpr std::size_t kDataOffset = kHeaderBytes + kSlotCount * kSlotHeaderBytes;
+
+	struct SharedHeader {
+		char magic[8];
+		uint32_t slotCount;
+		uint32_t slotBytes;
+		std::atomic<uint64_t> published;
+	};
+
+	struct SlotHeader {
+		std::atomic<uint64_t> seq;
+		uint32_t width;
+		uint32_t height;
+		uint32_t channels;
+		uint32_t pad;
+		uint64_t frameId;
+	};
+
+	static_assert(sizeof(SharedHeader) <= kHeaderBytes, "preview header does not fit");
+	static_assert(sizeof(SlotHeader) <= kSlotHeaderBytes, "preview slot header does not fit");
+
+	// Add count bytes of src to the 16-bit sums in acc.
+	void AccumulateRow(const uint8_t* src, std::size_t count, uint16_t* acc)
+	{
+		std::size_t i = 0;
+#if defined(__aarch64__)
+		for (; i + 16 <= count; i += 16) {
+			uint8x16_t v = vld1q_u8(src + i);
+			vst1q_u16(acc + i, vaddw_u8(vld1q_u16(acc + i), vget_low_u8(v)));
+			vst1q_u16(acc + i + 8, vaddw_high_u8(vld1q_u16(acc + i + 8), v));
+		}
+#endif
+		for (; i < count; ++i) {
+			acc[i] += src[i];
+		}
+	}
+}
+
+
+void BoxDownsample(const ImageView& img, uint32_t factor, uint8_t* dst, std::vector<uint16_t>& rowSums)
+{
+	const uint32_t outWidth = img.width / factor;
+	const uint32_t outHeight = img.height / factor;
+	const uint32_t channels = img.channels;
+	const std::size_t rowBytes = static_cast<std::size_t>(outWidth) * factor * channels;
+	const uint32_t area = factor * factor;
+
+	rowSums.resize(rowBytes);
+
+	for (uint32_t oy = 0; oy < outHeight; ++oy) {
+		// Vertical pass over every input byte, vectorised.
+		std::fill(rowSums.begin(), rowSums.end(), 0);
+		for (uint32_t k = 0; k < factor; ++k) {
+			AccumulateRow(img.row(oy * factor + k), rowBytes, rowSums.data());
+		}
+
+		// Horizontal pass only touches one sum per input pixel and channel.
+		uint8_t* out = dst + static_cast<std::size_t>(oy) * outWidth * channels;
+		const uint16_t* sums = rowSums.data();
+		for (uint32_t ox = 0; ox < outWidth; ++ox) {
+			for (uint32_t c = 0; c < channels; ++c) {
+				uint32_t total = 0;
+				for (uint32_t k = 0; k < factor; ++k) {
+					total += sums[k * channels + c];
+				}
+				out[c] = static_cast<uint8_t>((total + area / 2) / area);
+			}
+			sums += factor * channels;
+			out += channels;
+		}
+	}
+}
+
+
+PreviewTap::PreviewTap(const std::string& name, uint32_t scale, uint32_t maxWidth, uint32_t maxHeight, uint32_t maxChannels)
+	: shmName(name), factor(scale)
+{
+	if (factor < 1 || factor > 16) {
+		throw std::runtime_error("Preview scale must be between 1 and 16.");
+	}
+
+	slotBytes = static_cast<std::size_t>(maxWidth / factor) * (maxHeight / factor) * maxChannels;
+	// Keep every slot cache-line aligned.
+	slotBytes = (slotBytes + 63) & ~static_cast<std::size_t>(63);
+	mappedBytes = kDataOffset + kSlotCount * slotBytes;
+
+	shm_unlink(shmName.c_str());
+	int fd = shm_open(shmName.c_str(), O_CREAT | O_RDWR, 0644);
+	if (fd < 0) {
+		throw std::runtime_error("Could not create preview shared memory " + shmName);
+	}
+	if (ftruncate(fd, static_cast<off_t>(mappedBytes)) != 0) {
+		close(fd);
+		shm_unlink(shmName.c_str());
+		throw std::runtime_error("Could not size preview shared memory " + shmName);
+	}
+
+	void* mem = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mem == MAP_FAILED) {
+		shm_unlink(shmName.c_str());
+		throw std::runtime_error("Could not map preview shared memory " + shmName);
+	}
+	base = static_cast<uint8_t*>(mem);
+
+	// ftruncate() zero-fills, so all sequence counters start even and nothing is published.
+	auto* header = new (base) SharedHeader;
+	header->slotCount = kSlotCount;
+	header->slotBytes = static_cast<uint32_t>(slotBytes);
+	for (uint32_t i = 0; i < kSlotCount; ++i) {
+		new (base + kHeaderBytes + i * kSlotHeaderBytes) SlotHeader;
+	}
+	header->published.store(0, std::memory_order_relaxed);
+	std::memcpy(header->magic, "ALVPREV1", 8);
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+PreviewTap::~PreviewTap() {
+	if (base != nullptr) {
+		munmap(base, mappedBytes);
+	}
+	shm_unlink(shmName.c_str());
+}
+
+void PreviewTap::publish(const ImageView& img, uint64_t frameId)
+{
+	if (img.empty()) return;
+
+	const uint32_t outWidth = img.width / factor;
+	const uint32_t outHeight = img.height / factor;
+	const std::size_t bytes = static_cast<std::size_t>(outWidth) * outHeight * img.channels;
+	if (bytes == 0 || bytes > slotBytes) return;
+
+	auto* header = reinterpret_cast<SharedHeader*>(base);
+	const uint64_t published = header->published.load(std::memory_order_relaxed);
+	const uint32_t index = static_cast<uint32_t>(published % kSlotCount);
+	auto* slot = reinterpret_cast<SlotHeader*>(base + kHeaderBytes + index * kSlotHeaderBytes);
+
+	// Odd sequence marks the slot as being written.
+	const uint64_t seq = slot->seq.load(std::memory_order_relaxed);
+	slot->seq.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	BoxDownsample(img, factor, base + kDataOffset + index * slotBytes, rowSums);
+	slot->width = outWidth;
+	slot->height = outHeight;
+	slot->channels = img.channels;
+	slot->frameId = frameId;
+
+	slot->seq.store(seq + 2, std::memory_order_release);
+	header->published.store(published + 1, std::memory_order_release);
+}
@@ -0,0 +1,219 @@
+#include "SessionJournal.h"
+#include "Crc32.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+static const char kMagic[8] = {'A', 'L', 'V', 'J', 'R', 'N', 'L', '2'};
+
+static bool WriteAll(int fd, const void* data, std::size_t bytes)
+{
+	const char* p = static_cast<const char*>(data);
+	while (bytes > 0) {
+		ssize_t n = ::write(fd, p, bytes);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		p += n;
+		bytes -= static_cast<std::size_t>(n);
+	}
+	return true;
+}
+
+
+SessionJournal::SessionJournal(const std::string& path, const std::vector<std::string>& directories, std::chrono::milliseconds commitInterval)
+	: interval(commitInterval), dirs(directories)
+{
+	std::string header(kHeaderBytes, '\0');
+	std::memcpy(&header[0], kMagic, sizeof(kMagic));
+	const uint32_t recordSize = sizeof(JournalRecord);
+	const uint32_t count = static_cast<uint32_t>(directories.size());
+	const uint64_t created = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	std::memcpy(&header[8], &recordSize, 4);
+	std::memcpy(&header[12], &count, 4);
+	std::memcpy(&header[16], &created, 8);
+	std::string dirs;
+	for (const auto& dir : directories) {
+		dirs += dir + "\n";
+	}
+	if (dirs.size() > kHeaderBytes - 24) {
+		throw std::runtime_error("Journal directories do not fit in the header");
+	}
+	std::memcpy(&header[24], dirs.data(), dirs.size());
+
+	fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+	if (fd < 0) {
+		throw std::runtime_error("Could not create journal " + path + ": " + std::strerror(errno));
+	}
+	if (!WriteAll(fd, header.data(), header.size()) || ::fdatasync(fd) != 0) {
+		::close(fd);
+		fd = -1;
+		throw std::runtime_error("Could not write journal " + path + ": " + std::strerror(errno));
+	}
+	committer = std::thread(&SessionJournal::commitLoop, this);
+}
+
+SessionJournal::~SessionJournal()
+{
+	close();
+}
+
+void SessionJournal::append(uint64_t frameCounter, uint32_t target, const std::string& path, uint64_t bytes, uint32_t dataCrc, const FrameMetadata& meta)
+{
+	JournalRecord record;
+	std::memset(&record, 0, sizeof(record));
+	record.frameCounter = frameCounter;
+	record.bytes = bytes;
+	record.dataCrc = dataCrc;
+	record.frameId = meta.frameId;
+	record.timestamp = meta.timestamp;
+	record.target = target;
+	const std::size_t slash = path.find_last_of('/');
+	const std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+	std::memcpy(record.name, name.data(), std::min(name.size(), sizeof(record.name)));
+
+	std::lock_guard<std::mutex> lock(mtx);
+	queued.push_back({record, path});
+}
+
+// Sync the frame file and seal its record. The file is not read back: size and CRC come from the writer's
+// buffer, and reading would cost as much disk traffic as writing the frame.
+bool SessionJournal::seal(Pending& frame) const
+{
+	int frameFd = ::open(frame.path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (frameFd < 0) {
+		return false;
+	}
+	bool ok = ::fdatasync(frameFd) == 0;
+	::close(frameFd);
+	frame.record.crc = Crc32(&frame.record, offsetof(JournalRecord, crc));
+	return ok;
+}
+
+// Commit thread: per interval, sync the frame files appended meanwhile and their directories, then one
+// write and one fdatasync of the journal for their records.
+void SessionJournal::commitLoop()
+{
+	std::vector<Pending> batch;
+	std::vector<JournalRecord> records;
+	std::unique_lock<std::mutex> lock(mtx);
+	while (true) {
+		cv.wait_for(lock, interval, [this] { return stopping; });
+		const bool last = stopping;
+		batch.swap(queued);
+		lock.unlock();
+
+		if (!batch.empty()) {
+			auto start = std::chrono::steady_clock::now();
+			bool ok = true;
+			std::vector<bool> touched(dirs.size(), false);
+			records.clear();
+			for (Pending& frame : batch) {
+				if (seal(frame)) {
+					records.push_back(frame.record);
+					if (frame.record.target < dirs.size()) {
+						touched[frame.record.target] = true;
+					}
+				}
+				else {
+					ok = false;
+				}
+			}
+			// New directory entries are only durable once their directory is synced.
+			for (std::size_t i = 0; i < dirs.size(); ++i) {
+				if (!touched[i]) {
+					continue;
+				}
+				int dirFd = ::open(dirs[i].c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+				ok = dirFd >= 0 && ::fsync(dirFd) == 0 && ok;
+				if (dirFd >= 0) {
+					::close(dirFd);
+				}
+			}
+			if (!records.empty()) {
+				ok = WriteAll(fd, records.data(), records.size() * sizeof(JournalRecord)) && ::fdatasync(fd) == 0 && ok;
+			}
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			lock.lock();
+			failed = failed || !ok;
+			recordCount += records.size();
+			commitCount++;
+			maxCommit = std::max(maxCommit, seconds);
+			lock.unlock();
+			batch.clear();
+		}
+
+		lock.lock();
+		if (last) {
+			return;
+		}
+	}
+}
+
+bool SessionJournal::close()
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		stopping = true;
+	}
+	cv.notify_one();
+	if (committer.joinable()) {
+		committer.join();
+	}
+	if (fd >= 0) {
+		failed = ::close(fd) != 0 || failed;
+		fd = -1;
+	}
+	return !failed;
+}
+
+bool ReadSessionJournal(const std::string& path, std::vector<std::string>& directories, std::vector<JournalRecord>& records, uint64_t& validBytes)
+{
+	std::ifstream in(path, std::ios::binary);
+	std::string header(SessionJournal::kHeaderBytes, '\0');
+	if (!in.read(&header[0], header.size()) || std::memcmp(header.data(), kMagic, sizeof(kMagic)) != 0) {
+		return false;
+	}
+	uint32_t recordSize = 0;
+	uint32_t count = 0;
+	std::memcpy(&recordSize, &header[8], 4);
+	std::memcpy(&count, &header[12], 4);
+	if (recordSize != sizeof(JournalRecord)) {
+		return false;
+	}
+
+	directories.clear();
+	std::istringstream dirs(std::string(header.c_str() + 24));
+	std::string dir;
+	while (directories.size() < count && std::getline(dirs, dir)) {
+		directories.push_back(dir);
+	}
+
+	// The whole journal is read at once; even a million frames is only 64 MB.
+	in.seekg(0, std::ios::end);
+	const uint64_t size = static_cast<uint64_t>(in.tellg());
+	const std::size_t available = static_cast<std::size_t>((size - SessionJournal::kHeaderBytes) / sizeof(JournalRecord));
+	records.resize(available);
+	in.seekg(SessionJournal::kHeaderBytes);
+	in.read(reinterpret_cast<char*>(records.data()), available * sizeof(JournalRecord));
+
+	std::size_t valid = 0;
+	while (valid < available && records[valid].crc == Crc32(&records[valid], offsetof(JournalRecord, crc))
+	       && records[valid].target < directories.size()) {
+		valid++;
+	}
+	records.resize(valid);
+	validBytes = SessionJournal::kHeaderBytes + valid * sizeof(JournalRecord);
+	return true;
+}
@@ -0,0 +1,233 @@
+#include "Stacking.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+
+namespace {
+
+	// sums[i] += samples[i]
+	void Accumulate(const uint16_t* samples, std::size_t count, uint32_t* sums)
+	{
+		std::size_t i = 0;
+#if defined(__aarch64__)
+		for (; i + 8 <= count; i += 8) {
+			uint16x8_t v = vld1q_u16(samples + i);
+			vst1q_u32(sums + i, vaddw_u16(vld1q_u32(sums + i), vget_low_u16(v)));
+			vst1q_u32(sums + i + 4, vaddw_high_u16(vld1q_u32(sums + i + 4), v));
+		}
+#endif
+		for (; i < count; ++i) {
+			sums[i] += samples[i];
+		}
+	}
+
+	// sums[i] += samples[i] for 8-bit samples into 16-bit sums
+	void Accumulate(const uint8_t* samples, std::size_t count, uint16_t* sums)
+	{
+		std::size_t i = 0;
+#if defined(__aarch64__)
+		for (; i + 16 <= count; i += 16) {
+			uint8x16_t v = vld1q_u8(samples + i);
+			vst1q_u16(sums + i, vaddw_u8(vld1q_u16(sums + i), vget_low_u8(v)));
+			vst1q_u16(sums + i + 8, vaddw_high_u8(vld1q_u16(sums + i + 8), v));
+		}
+#endif
+		for (; i < count; ++i) {
+			sums[i] = static_cast<uint16_t>(sums[i] + samples[i]);
+		}
+	}
+
+	void Widen(const uint8_t* samples, std::size_t count, uint16_t* dst)
+	{
+		std::size_t i = 0;
+#if defined(__aarch64__)
+		for (; i + 16 <= count; i += 16) {
+			uint8x16_t v = vld1q_u8(samples + i);
+			vst1q_u16(dst + i, vmovl_u8(vget_low_u8(v)));
+			vst1q_u16(dst + i + 8, vmovl_high_u8(v));
+		}
+#endif
+		for (; i < count; ++i) {
+			dst[i] = samples[i];
+		}
+	}
+
+	// Median of n values scaled by 2^shift, averaging the middle pair for even n. Reorders values.
+	uint32_t Median(uint16_t* values, std::size_t n, uint32_t shift)
+	{
+		std::nth_element(values, values + n / 2, values + n);
+		uint32_t median = values[n / 2];
+		if (n % 2 == 0) {
+			return (((median + *std::max_element(values, values + n / 2)) << shift) + 1) / 2;
+		}
+		return median << shift;
+	}
+
+	// Mean of the values within kappa standard deviations of the mean of all n values, scaled by 2^shift.
+	uint32_t SigmaClippedMean(const uint16_t* values, std::size_t n, double kappa, uint32_t shift)
+	{
+		double sum = 0.0, sumSq = 0.0;
+		for (std::size_t k = 0; k < n; ++k) {
+			sum += values[k];
+			sumSq += static_cast<double>(values[k]) * values[k];
+		}
+		const double mean = sum / n;
+		const double limit = kappa * std::sqrt(std::max(0.0, sumSq / n - mean * mean));
+
+		double kept = 0.0;
+		std::size_t keptCount = 0;
+		for (std::size_t k = 0; k < n; ++k) {
+			if (std::fabs(values[k] - mean) <= limit) {
+				kept += values[k];
+				keptCount++;
+			}
+		}
+		return static_cast<uint32_t>(std::lround(std::ldexp(keptCount ? kept / keptCount : mean, static_cast<int>(shift))));
+	}
+
+	// Run task over [0, count) in bands, on the pool if there is one.
+	void ForBands(ThreadPool* pool, std::size_t count, const std::function<void(std::size_t, std::size_t)>& task)
+	{
+		const std::size_t bands = pool ? pool->size() * 4 : 1;
+		const std::size_t perBand = (count + bands - 1) / bands;
+		auto run = [&](std::size_t band) {
+			std::size_t begin = band * perBand;
+			std::size_t end = std::min(count, begin + perBand);
+			if (begin < end) task(begin, end);
+		};
+		if (pool) {
+			pool->parallelFor(bands, run);
+		}
+		else {
+			run(0);
+		}
+	}
+}
+
+
+StackMethod ParseStackMethod(const std::string& name)
+{
+	if (name == "mean") return StackMethod::Mean;
+	if (name == "median") return StackMethod::Median;
+	if (name == "sigma") return StackMethod::SigmaClippedMean;
+	throw std::invalid_argument("Unknown stacking method: " + name);
+}
+
+const char* StackMethodName(StackMethod method)
+{
+	switch (method) {
+		case StackMethod::Mean: return "mean";
+		case StackMethod::Median: return "median";
+		case StackMethod::SigmaClippedMean: return "sigma";
+	}
+	return "unknown";
+}
+
+FrameStacker::FrameStacker(StackMethod method, std::size_t depth, ThreadPool* pool)
+	: method(method), depth(std::max<std::size_t>(1, depth)), pool(pool)
+{
+}
+
+bool FrameStacker::begin(std::size_t n)
+{
+	if (added == 0 && n != count) {
+		count = n;
+		sums16.clear();
+		sums.clear();
+		history.clear();
+	}
+	return n == count && !full();
+}
+
+bool FrameStacker::add(const uint16_t* samples, std::size_t n)
+{
+	if (!begin(n)) {
+		return false;
+	}
+
+	if (method == StackMethod::Mean) {
+		if (!sums16.empty()) {
+			// Frames of both depths in one stack; move the 16-bit sums over.
+			sums.assign(sums16.begin(), sums16.end());
+			sums16.clear();
+		}
+		if (sums.size() != count) {
+			sums.assign(count, 0);
+		}
+		Accumulate(samples, count, sums.data());
+	}
+	else {
+		history.resize(depth * count);
+		std::memcpy(history.data() + added * count, samples, count * sizeof(uint16_t));
+	}
+	++added;
+	return true;
+}
+
+bool FrameStacker::add(const uint8_t* samples, std::size_t n)
+{
+	// 255 * 257 still fits a 16-bit sum.
+	if (method == StackMethod::Mean && depth <= 257 && sums.empty()) {
+		if (!begin(n)) {
+			return false;
+		}
+		if (sums16.size() != count) {
+			sums16.assign(count, 0);
+		}
+		Accumulate(samples, count, sums16.data());
+		++added;
+		return true;
+	}
+
+	widened.resize(n);
+	Widen(samples, n, widened.data());
+	return add(widened.data(), n);
+}
+
+void FrameStacker::finish(std::vector<uint16_t>& out, uint32_t fractionBits)
+{
+	out.resize(count);
+	const std::size_t n = added;
+
+	if (n == 0) {
+		std::fill(out.begin(), out.end(), 0);
+	}
+	else if (method == StackMethod::Mean && !sums16.empty()) {
+		ForBands(pool, count, [&](std::size_t begin, std::size_t end) {
+			for (std::size_t i = begin; i < end; ++i) {
+				out[i] = static_cast<uint16_t>(std::min<uint32_t>(((static_cast<uint32_t>(sums16[i]) << fractionBits) + n / 2) / n, 65535));
+				sums16[i] = 0;
+			}
+		});
+	}
+	else if (method == StackMethod::Mean) {
+		ForBands(pool, count, [&](std::size_t begin, std::size_t end) {
+			for (std::size_t i = begin; i < end; ++i) {
+				out[i] = static_cast<uint16_t>(std::min<uint64_t>(((static_cast<uint64_t>(sums[i]) << fractionBits) + n / 2) / n, 65535));
+				sums[i] = 0;
+			}
+		});
+	}
+	else {
+		ForBands(pool, count, [&](std::size_t begin, std::size_t end) {
+			std::vector<uint16_t> values(n);
+			for (std::size_t i = begin; i < end; ++i) {
+				for (std::size_t k = 0; k < n; ++k) {
+					values[k] = history[k * count + i];
+				}
+				uint32_t value = method == StackMethod::Median
+					? Median(values.data(), n, fractionBits)
+					: SigmaClippedMean(values.data(), n, kappa, fractionBits);
+				out[i] = static_cast<uint16_t>(std::min<uint32_t>(value, 65535));
+			}
+		});
+	}
+	added = 0;
+}
@@ -0,0 +1,198 @@
+#include "StripedWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace VmbCPP {
+namespace Examples {
+
+StripePolicy ParseStripePolicy(const std::string& name)
+{
+    if (name == "rr") return StripePolicy::RoundRobin;
+    if (name == "bandwidth") return StripePolicy::Bandwidth;
+    throw std::invalid_argument("Unknown stripe policy: " + name);
+}
+
+const char* StripePolicyName(StripePolicy policy)
+{
+    return policy == StripePolicy::Bandwidth ? "bandwidth" : "round-robin";
+}
+
+StripedWriter::StripedWriter(std::vector<std::unique_ptr<FrameWriter>> writers, const std::vector<std::string>& directories, StripePolicy policy,
+                             const std::string& indexPath, std::shared_ptr<::Logger> logger, bool timing, std::size_t queueDepth) :
+    m_policy(policy), m_logger(logger), m_timing(timing), m_queueDepth(std::max<std::size_t>(1, queueDepth))
+{
+    m_index.open(indexPath, std::ios::out | std::ios::trunc);
+    if (!m_index) {
+        m_logger->error("Could not open session index " + indexPath);
+        throw std::runtime_error("Could not open session index " + indexPath);
+    }
+    m_index << "sequence,frame,target,path\n";
+
+    for (std::size_t i = 0; i < writers.size(); ++i) {
+        auto target = std::make_unique<Target>();
+        target->writer = std::move(writers[i]);
+        target->directory = directories[i];
+        m_targets.push_back(std::move(target));
+    }
+    for (std::size_t i = 0; i < m_targets.size(); ++i) {
+        m_targets[i]->thread = std::thread(&StripedWriter::Run, this, i);
+    }
+    if (!m_timing) {
+        m_logger->log("Striping frames " + std::string(StripePolicyName(policy)) + " over " + std::to_string(m_targets.size())
+                      + " targets, session index in " + indexPath + ".");
+    }
+}
+
+StripedWriter::~StripedWriter()
+{
+    Close();
+}
+
+int StripedWriter::Pick(uint64_t sequence, std::size_t bytes) const
+{
+    if (m_policy == StripePolicy::RoundRobin) {
+        const std::size_t i = sequence % m_targets.size();
+        return m_targets[i]->jobs.size() < m_queueDepth ? static_cast<int>(i) : -1;
+    }
+
+    // Unmeasured targets are assumed to be as fast as the fastest one so that each gets measured early.
+    double fastest = 0.0;
+    for (const auto& target : m_targets) {
+        fastest = std::max(fastest, target->bandwidth);
+    }
+    int best = -1;
+    double bestFinish = 0.0;
+    for (std::size_t i = 0; i < m_targets.size(); ++i) {
+        const Target& target = *m_targets[i];
+        if (target.jobs.size() >= m_queueDepth) {
+            continue;
+        }
+        const double rate = target.bandwidth > 0.0 ? target.bandwidth : (fastest > 0.0 ? fastest : 1.0);
+        const double finish = (target.queuedBytes + bytes) / rate;
+        if (best < 0 || finish < bestFinish) {
+            best = static_cast<int>(i);
+            bestFinish = finish;
+        }
+    }
+    return best;
+}
+
+void StripedWriter::Write(const uint8_t* buffer, VmbUint32_t bufferSize, const PixelLayout& layout, VmbUint32_t width, VmbUint32_t height, uint64_t frameCounter, const FrameMetadata& meta)
+{
+    if (buffer == nullptr || m_targets.empty()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_closing) {
+        return;
+    }
+    const uint64_t sequence = m_nextSequence++;
+    int chosen;
+    m_space.wait(lock, [&] { return (chosen = Pick(sequence, bufferSize)) >= 0; });
+    Target& target = *m_targets[chosen];
+
+    Job job;
+    if (!target.spare.empty()) {
+        job.data = std::move(target.spare.back());
+        target.spare.pop_back();
+    }
+    job.layout = layout;
+    job.width = width;
+    job.height = height;
+    job.frameCounter = frameCounter;
+    job.meta = meta;
+    job.sequence = sequence;
+    target.queuedBytes += bufferSize;
+    lock.unlock();
+
+    // The capture buffer is handed back to the camera once Write() returns, so the target works on a copy.
+    job.data.resize(bufferSize);
+    std::memcpy(job.data.data(), buffer, bufferSize);
+
+    lock.lock();
+    target.jobs.push_back(std::move(job));
+    target.work.notify_one();
+}
+
+// Target thread: writes its queued frames and records them in the session index.
+void StripedWriter::Run(std::size_t index)
+{
+    Target& target = *m_targets[index];
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        target.work.wait(lock, [&] { return !target.jobs.empty() || m_closing; });
+        if (target.jobs.empty()) {
+            return;
+        }
+        Job job = std::move(target.jobs.front());
+        target.jobs.pop_front();
+        lock.unlock();
+
+        const std::size_t bytes = job.data.size();
+        auto start = std::chrono::steady_clock::now();
+        std::string path = target.writer->Write(job.data.data(), static_cast<VmbUint32_t>(bytes), job.layout, job.width, job.height, job.frameCounter, job.meta);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!path.empty()) {
+            if (m_journal) {
+                m_journal->append(job.frameCounter, static_cast<uint32_t>(index), path, target.writer->LastBytes(), target.writer->LastCrc(), job.meta);
+            }
+            if (!m_timing) {
+                m_logger->debug(path + " saved.");
+            }
+        }
+
+        lock.lock();
+        target.queuedBytes -= bytes;
+        if (!path.empty()) {
+            target.frames++;
+            target.bytes += bytes;
+            if (seconds > 0.0) {
+                const double rate = bytes / seconds;
+                target.bandwidth = target.bandwidth > 0.0 ? 0.8 * target.bandwidth + 0.2 * rate : rate;
+            }
+        }
+        target.spare.push_back(std::move(job.data));
+
+        m_finished[job.sequence] = IndexEntry{job.frameCounter, index, path};
+        for (auto it = m_finished.begin(); it != m_finished.end() && it->first == m_nextIndexed; it = m_finished.erase(it)) {
+            m_index << it->first << "," << it->second.frameCounter << "," << it->second.target << "," << it->second.path << "\n";
+            m_nextIndexed++;
+        }
+        m_space.notify_all();
+    }
+}
+
+void StripedWriter::Close()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_closed) {
+            return;
+        }
+        m_closed = true;
+        m_closing = true;
+        for (auto& target : m_targets) {
+            target->work.notify_one();
+        }
+    }
+    for (auto& target : m_targets) {
+        if (target->thread.joinable()) {
+            target->thread.join();
+        }
+    }
+    m_index.flush();
+
+    for (std::size_t i = 0; i < m_targets.size(); ++i) {
+        Target& target = *m_targets[i];
+        target.writer->Flush();
+        m_logger->log("Target " + std::to_string(i) + " (" + target.directory + "): " + std::to_string(target.frames) + " frames, "
+                      + std::to_string(target.bytes / 1000000) + " MB, " + std::to_string(static_cast<int>(target.bandwidth / 1e6)) + " MB/s.");
+        target.writer->LogThroughput();
+    }
+}
+
+}} // namespace VmbCPP
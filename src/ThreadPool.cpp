@@ -0,0 +1,75 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+
+ThreadPool::ThreadPool(std::size_t numThreads)
+{
+	if (numThreads == 0) {
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	// The caller of parallelFor() is used as one of the workers.
+	for (std::size_t i = 1; i < numThreads; ++i) {
+		workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		stopping = true;
+	}
+	cvWork.notify_all();
+	for (auto& t : workers) {
+		if (t.joinable()) {
+			t.join();
+		}
+	}
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& task) {
+	if (count == 0) return;
+
+	if (workers.empty() || count == 1) {
+		for (std::size_t i = 0; i < count; ++i) {
+			task(i);
+		}
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(mtx);
+	job = &task;
+	jobCount = count;
+	nextIndex = 0;
+	pending = count;
+	++generation;
+	cvWork.notify_all();
+
+	runTasks(lock);
+	cvDone.wait(lock, [&]{ return pending == 0; });
+	job = nullptr;
+}
+
+void ThreadPool::workerLoop() {
+	std::size_t seen = 0;
+	std::unique_lock<std::mutex> lock(mtx);
+	while (true) {
+		cvWork.wait(lock, [&]{ return stopping || (generation != seen && job != nullptr); });
+		if (stopping) return;
+		seen = generation;
+		runTasks(lock);
+	}
+}
+
+void ThreadPool::runTasks(std::unique_lock<std::mutex>& lock) {
+	while (job != nullptr && nextIndex < jobCount) {
+		std::size_t i = nextIndex++;
+		const auto* task = job;
+		lock.unlock();
+		(*task)(i);
+		lock.lock();
+		if (--pending == 0) {
+			cvDone.notify_all();
+		}
+	}
+}
@@ -0,0 +1,339 @@
+#include "TiffWriter.h"
+#include "Crc32.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(ALVIUM_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+
+namespace {
+
+	enum TiffType : uint16_t {
+		TypeByte = 1,
+		TypeAscii = 2,
+		TypeShort = 3,
+		TypeLong = 4,
+		TypeRational = 5,
+		TypeSRational = 10,
+		TypeDouble = 12
+	};
+
+	// IFD under construction. Values that do not fit the 4-byte entry field go to a data area after the IFD.
+	class Ifd {
+		public:
+			void add(uint16_t tag, uint16_t type, uint32_t count, const void* value, std::size_t bytes)
+			{
+				Entry entry;
+				entry.tag = tag;
+				entry.type = type;
+				entry.count = count;
+				entry.value.assign(static_cast<const uint8_t*>(value), static_cast<const uint8_t*>(value) + bytes);
+				entries.push_back(entry);
+			}
+
+			void addShorts(uint16_t tag, const std::vector<uint16_t>& values)
+			{
+				add(tag, TypeShort, static_cast<uint32_t>(values.size()), values.data(), values.size() * 2);
+			}
+
+			void addLongs(uint16_t tag, const std::vector<uint32_t>& values)
+			{
+				add(tag, TypeLong, static_cast<uint32_t>(values.size()), values.data(), values.size() * 4);
+			}
+
+			void addAscii(uint16_t tag, const std::string& text)
+			{
+				add(tag, TypeAscii, static_cast<uint32_t>(text.size() + 1), text.c_str(), text.size() + 1);
+			}
+
+			// Serialise the IFD for placement at file offset start.
+			std::vector<uint8_t> build(uint32_t start)
+			{
+				std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.tag < b.tag; });
+
+				const std::size_t tableBytes = 2 + entries.size() * 12 + 4;
+				std::vector<uint8_t> out(tableBytes);
+				Put16(&out[0], static_cast<uint16_t>(entries.size()));
+
+				for (std::size_t i = 0; i < entries.size(); ++i) {
+					const Entry& e = entries[i];
+					uint8_t* slot = &out[2 + i * 12];
+					Put16(slot, e.tag);
+					Put16(slot + 2, e.type);
+					Put32(slot + 4, e.count);
+					if (e.value.size() <= 4) {
+						std::memcpy(slot + 8, e.value.data(), e.value.size());
+					}
+					else {
+						// Keep the data area word aligned.
+						if (out.size() % 2) out.push_back(0);
+						Put32(slot + 8, static_cast<uint32_t>(start + out.size()));
+						out.insert(out.end(), e.value.begin(), e.value.end());
+					}
+				}
+				// Next IFD offset stays 0: one image per file.
+				return out;
+			}
+
+		private:
+			struct Entry {
+				uint16_t tag;
+				uint16_t type;
+				uint32_t count;
+				std::vector<uint8_t> value;
+			};
+			std::vector<Entry> entries;
+
+			static void Put16(uint8_t* dst, uint16_t v) { std::memcpy(dst, &v, 2); }
+			static void Put32(uint8_t* dst, uint32_t v) { std::memcpy(dst, &v, 4); }
+	};
+
+	// Write every iovec, continuing after partial writes.
+	bool WriteAll(int fd, std::vector<iovec>& iov)
+	{
+		std::size_t first = 0;
+		while (first < iov.size()) {
+			int count = static_cast<int>(std::min<std::size_t>(iov.size() - first, IOV_MAX));
+			ssize_t n = ::writev(fd, &iov[first], count);
+			if (n < 0) {
+				if (errno == EINTR) continue;
+				return false;
+			}
+			std::size_t left = static_cast<std::size_t>(n);
+			while (first < iov.size() && left >= iov[first].iov_len) {
+				left -= iov[first].iov_len;
+				first++;
+			}
+			if (first < iov.size()) {
+				iov[first].iov_base = static_cast<uint8_t*>(iov[first].iov_base) + left;
+				iov[first].iov_len -= left;
+			}
+		}
+		return true;
+	}
+
+	// Horizontal differencing (TIFF Predictor 2) of one strip.
+	template <typename T>
+	void Predict(const T* src, uint32_t rows, uint32_t width, uint32_t channels, T* dst)
+	{
+		const std::size_t rowSamples = static_cast<std::size_t>(width) * channels;
+		for (uint32_t y = 0; y < rows; ++y) {
+			const T* in = src + y * rowSamples;
+			T* out = dst + y * rowSamples;
+			std::memcpy(out, in, channels * sizeof(T));
+			for (std::size_t i = channels; i < rowSamples; ++i) {
+				out[i] = static_cast<T>(in[i] - in[i - channels]);
+			}
+		}
+	}
+
+	// JSON copy of the metadata for readers that only look at ImageDescription.
+	std::string Description(const FrameMetadata& meta)
+	{
+		std::ostringstream oss;
+		oss << "{\"frame_id\": " << meta.frameId
+		    << ", \"timestamp\": " << meta.timestamp
+		    << ", \"exposure_us\": " << meta.exposure
+		    << ", \"gain_db\": " << meta.gain
+		    << ", \"offset_x\": " << meta.offsetX
+		    << ", \"offset_y\": " << meta.offsetY << "}";
+		return oss.str();
+	}
+}
+
+
+TiffWriter::TiffWriter(bool dng, bool deflate, uint32_t rowsPerStrip, std::size_t numThreads)
+	: dng(dng), deflate(deflate), rowsPerStrip(std::max<uint32_t>(1, rowsPerStrip))
+{
+#if !defined(ALVIUM_HAVE_ZLIB)
+	if (deflate) {
+		throw std::runtime_error("Deflate TIFF compression needs zlib, which was not found when the driver was built");
+	}
+#endif
+	if (deflate) {
+		pool = std::make_unique<ThreadPool>(numThreads);
+	}
+}
+
+bool TiffWriter::compressStrip(std::size_t index, const uint8_t* src, uint32_t rows, uint32_t width, uint32_t channels, uint32_t bytesPerSample)
+{
+#if defined(ALVIUM_HAVE_ZLIB)
+	const std::size_t bytes = static_cast<std::size_t>(rows) * width * channels * bytesPerSample;
+	std::vector<uint8_t>& diff = predicted[index];
+	diff.resize(bytes);
+	if (bytesPerSample == 2) {
+		Predict(reinterpret_cast<const uint16_t*>(src), rows, width, channels, reinterpret_cast<uint16_t*>(diff.data()));
+	}
+	else {
+		Predict(src, rows, width, channels, diff.data());
+	}
+
+	std::vector<uint8_t>& out = strips[index];
+	uLongf outBytes = compressBound(static_cast<uLong>(bytes));
+	out.resize(outBytes);
+	if (compress2(out.data(), &outBytes, diff.data(), static_cast<uLong>(bytes), Z_BEST_SPEED) != Z_OK) {
+		return false;
+	}
+	out.resize(outBytes);
+	return true;
+#else
+	(void)index; (void)src; (void)rows; (void)width; (void)channels; (void)bytesPerSample;
+	return false;
+#endif
+}
+
+bool TiffWriter::write(const std::string& path, const uint8_t* data, uint32_t width, uint32_t height, uint32_t channels,
+		       uint32_t bitsPerSample, uint32_t significantBits, const std::string& cfa, const FrameMetadata& meta,
+		       uint32_t* crc)
+{
+	if (data == nullptr || width == 0 || height == 0 || (bitsPerSample != 8 && bitsPerSample != 16)) {
+		return false;
+	}
+
+	const uint32_t bytesPerSample = bitsPerSample / 8;
+	const std::size_t rowBytes = static_cast<std::size_t>(width) * channels * bytesPerSample;
+	const uint32_t stripCount = (height + rowsPerStrip - 1) / rowsPerStrip;
+	const bool writeDng = dng && channels == 1;
+
+	// Strip payloads: slices of the caller's buffer, or the compressed strips.
+	std::vector<uint32_t> stripBytes(stripCount);
+	if (deflate) {
+		strips.resize(std::max<std::size_t>(strips.size(), stripCount));
+		predicted.resize(std::max<std::size_t>(predicted.size(), stripCount));
+		std::atomic<bool> failed(false);
+		pool->parallelFor(stripCount, [&](std::size_t i) {
+			uint32_t rows = std::min(rowsPerStrip, height - static_cast<uint32_t>(i) * rowsPerStrip);
+			if (!compressStrip(i, data + i * rowsPerStrip * rowBytes, rows, width, channels, bytesPerSample)) {
+				failed = true;
+			}
+		});
+		if (failed) {
+			return false;
+		}
+		for (uint32_t i = 0; i < stripCount; ++i) {
+			stripBytes[i] = static_cast<uint32_t>(strips[i].size());
+		}
+	}
+	else {
+		for (uint32_t i = 0; i < stripCount; ++i) {
+			uint32_t rows = std::min(rowsPerStrip, height - i * rowsPerStrip);
+			stripBytes[i] = static_cast<uint32_t>(rows * rowBytes);
+		}
+	}
+
+	std::vector<uint32_t> stripOffsets(stripCount);
+	uint32_t offset = 8;
+	for (uint32_t i = 0; i < stripCount; ++i) {
+		stripOffsets[i] = offset;
+		offset += stripBytes[i];
+	}
+	const uint32_t pad = offset % 2;
+	const uint32_t ifdOffset = offset + pad;
+
+	Ifd ifd;
+	const uint32_t zero = 0;
+	ifd.add(254, TypeLong, 1, &zero, 4);
+	ifd.addLongs(256, {width});
+	ifd.addLongs(257, {height});
+	ifd.addShorts(258, std::vector<uint16_t>(channels, static_cast<uint16_t>(bitsPerSample)));
+	ifd.addShorts(259, {static_cast<uint16_t>(deflate ? 8 : 1)});
+	ifd.addShorts(262, {static_cast<uint16_t>(writeDng ? (cfa.empty() ? 34892 : 32803) : (channels == 3 ? 2 : 1))});
+	ifd.addAscii(270, Description(meta));
+	ifd.addAscii(271, "Allied Vision");
+	if (!model.empty()) {
+		ifd.addAscii(272, model);
+	}
+	ifd.addLongs(273, stripOffsets);
+	ifd.addShorts(274, {1});
+	ifd.addShorts(277, {static_cast<uint16_t>(channels)});
+	ifd.addLongs(278, {rowsPerStrip});
+	ifd.addLongs(279, stripBytes);
+	ifd.addShorts(284, {1});
+	ifd.addAscii(305, "alvium");
+	if (deflate) {
+		ifd.addShorts(317, {2});
+	}
+
+	// ExposureTime in seconds as a rational of microseconds.
+	const uint32_t exposure[2] = { static_cast<uint32_t>(meta.exposure + 0.5), 1000000 };
+	ifd.add(33434, TypeRational, 1, exposure, sizeof(exposure));
+
+	if (writeDng) {
+		if (!cfa.empty()) {
+			const uint16_t dim[2] = { 2, 2 };
+			uint8_t pattern[4];
+			for (int i = 0; i < 4; ++i) {
+				pattern[i] = cfa[i] == 'R' ? 0 : (cfa[i] == 'G' ? 1 : 2);
+			}
+			ifd.add(33421, TypeShort, 2, dim, sizeof(dim));
+			ifd.add(33422, TypeByte, 4, pattern, sizeof(pattern));
+		}
+		const uint8_t version[4] = { 1, 4, 0, 0 };
+		ifd.add(50706, TypeByte, 4, version, sizeof(version));
+		ifd.addAscii(50708, model.empty() ? std::string("Allied Vision Alvium") : model);
+		ifd.addLongs(50717, {(1u << significantBits) - 1});
+		if (!cfa.empty()) {
+			// No colour calibration is known, so declare the camera space as XYZ with neutral white.
+			const int32_t identity[18] = { 1, 1, 0, 1, 0, 1,  0, 1, 1, 1, 0, 1,  0, 1, 0, 1, 1, 1 };
+			const uint32_t neutral[6] = { 1, 1, 1, 1, 1, 1 };
+			ifd.add(50721, TypeSRational, 9, identity, sizeof(identity));
+			ifd.add(50728, TypeRational, 3, neutral, sizeof(neutral));
+		}
+	}
+
+	// Private tags for programmatic readers.
+	const uint32_t frameId[2] = { static_cast<uint32_t>(meta.frameId), static_cast<uint32_t>(meta.frameId >> 32) };
+	const uint32_t timestamp[2] = { static_cast<uint32_t>(meta.timestamp), static_cast<uint32_t>(meta.timestamp >> 32) };
+	const uint32_t roiOffset[2] = { meta.offsetX, meta.offsetY };
+	ifd.add(65000, TypeLong, 2, frameId, sizeof(frameId));
+	ifd.add(65001, TypeLong, 2, timestamp, sizeof(timestamp));
+	ifd.add(65002, TypeLong, 2, roiOffset, sizeof(roiOffset));
+	ifd.add(65003, TypeDouble, 1, &meta.gain, sizeof(meta.gain));
+
+	std::vector<uint8_t> ifdBytes = ifd.build(ifdOffset);
+
+	uint8_t header[8] = { 'I', 'I', 42, 0 };
+	std::memcpy(header + 4, &ifdOffset, 4);
+	static uint8_t padByte = 0;
+
+	std::vector<iovec> iov;
+	iov.push_back({ header, sizeof(header) });
+	if (deflate) {
+		for (uint32_t i = 0; i < stripCount; ++i) {
+			iov.push_back({ strips[i].data(), strips[i].size() });
+		}
+	}
+	else {
+		iov.push_back({ const_cast<uint8_t*>(data), rowBytes * height });
+	}
+	if (pad) {
+		iov.push_back({ &padByte, 1 });
+	}
+	iov.push_back({ ifdBytes.data(), ifdBytes.size() });
+
+	if (crc) {
+		*crc = 0;
+		for (const iovec& part : iov) {
+			*crc = Crc32(part.iov_base, part.iov_len, *crc);
+		}
+	}
+
+	int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		return false;
+	}
+	bool ok = WriteAll(fd, iov);
+	return ::close(fd) == 0 && ok;
+}
@@ -18,6 +18,7 @@ static struct termios old, current;
 namespace {
 
 		volatile std::sig_atomic_t c_stop = 0;
+		volatile std::sig_atomic_t c_event = 0;
 
 		void signal_handler(int signal)
 		{
@@ -25,12 +26,17 @@ namespace {
 				{
 						c_stop = 1;
 				}
+				else if (signal == SIGUSR1)
+				{
+						c_event = 1;
+				}
 		}
 }
 
 void SetupSignalHandler()
 {
 		std::signal(SIGINT, signal_handler);
+		std::signal(SIGUSR1, signal_handler);
 }
 
 bool StopRequested()
@@ -38,6 +44,15 @@ bool StopRequested()
 		return c_stop != 0 ;
 }
 
+bool EventRequested()
+{
+		if (c_event == 0) {
+				return false;
+		}
+		c_event = 0;
+		return true;
+}
+
 void initTermios()
 {
 		tcgetattr(STDIN_FILENO, &old);
@@ -81,12 +96,19 @@ std::string PixelFormatToString(VmbPixelFormatType pf)
 		{
 				case VmbPixelFormatMono8:		return "Mono8";
 				case VmbPixelFormatMono10:		return "Mono10";
+				case VmbPixelFormatMono10p:		return "Mono10p";
 				case VmbPixelFormatMono12:		return "Mono12";
+				case VmbPixelFormatMono12p:		return "Mono12p";
+				case VmbPixelFormatMono12Packed:	return "Mono12Packed";
+				case VmbPixelFormatMono14:		return "Mono14";
+				case VmbPixelFormatMono16:		return "Mono16";
 				case VmbPixelFormatBayerRG8:	return "BayerRG8";
 				case VmbPixelFormatBayerBG8:	return "BayerBG8";
 				case VmbPixelFormatBayerGR8:	return "BayerGR8";
 				case VmbPixelFormatBayerGB8:	return "BayerGB8";
 				case VmbPixelFormatRgb8:		return "RGB8";
+				case VmbPixelFormatBgr8:		return "BGR8";
+				case VmbPixelFormatRgb12:		return "RGB12";
 				case VmbPixelFormatRgb16:		return "RGB16";
 				default: return "Unknown";
 		}
@@ -0,0 +1,235 @@
+#include "VideoRecorder.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace VmbCPP {
+namespace Examples {
+
+VideoCodec ParseVideoCodec(const std::string& name)
+{
+    if (name == "mjpg") return VideoCodec::Mjpeg;
+    if (name == "h264") return VideoCodec::H264;
+    throw std::invalid_argument("Unknown video codec: " + name);
+}
+
+const char* VideoCodecName(VideoCodec codec)
+{
+    return codec == VideoCodec::H264 ? "H.264" : "MJPEG";
+}
+
+// OpenCV names Bayer conversions after the second row, so the sensor's RGGB is OpenCV's BayerBG.
+static int DemosaicCode(const std::string& pattern)
+{
+    if (pattern == "RGGB") return cv::COLOR_BayerBG2BGR;
+    if (pattern == "BGGR") return cv::COLOR_BayerRG2BGR;
+    if (pattern == "GRBG") return cv::COLOR_BayerGB2BGR;
+    if (pattern == "GBRG") return cv::COLOR_BayerGR2BGR;
+    return -1;
+}
+
+VideoRecorder::VideoRecorder(const std::string& saveDir, const VideoSettings& settings, std::shared_ptr<::Logger> logger, bool timing, std::size_t queueDepth) :
+    m_saveDir(saveDir), m_settings(settings), m_logger(logger), m_timing(timing), m_queueDepth(std::max<std::size_t>(1, queueDepth))
+{
+    if (m_settings.codec == VideoCodec::H264) {
+        // Encoder options only reach FFmpeg through this variable, read whenever a file is opened. Set it here,
+        // before the encoder thread exists, since setenv() is not safe against concurrent getenv().
+        std::string options = "preset;ultrafast|threads;" + std::to_string(m_settings.threads);
+        if (m_settings.bitrateKbps > 0) {
+            options += "|b;" + std::to_string(m_settings.bitrateKbps * 1000);
+        }
+        ::setenv("OPENCV_FFMPEG_WRITER_OPTIONS", options.c_str(), 1);
+    }
+    m_thread = std::thread(&VideoRecorder::Run, this);
+    if (!m_timing) {
+        std::string rate = m_settings.codec == VideoCodec::Mjpeg ? "quality " + std::to_string(m_settings.quality)
+                         : m_settings.bitrateKbps > 0 ? std::to_string(m_settings.bitrateKbps) + " kbit/s" : "default bitrate";
+        m_logger->log("Recording " + std::string(VideoCodecName(m_settings.codec)) + " video, " + rate + ", "
+                      + std::to_string(static_cast<int>(m_settings.segmentSeconds)) + " s segments, " + std::to_string(m_settings.threads) + " encoder threads.");
+    }
+}
+
+VideoRecorder::~VideoRecorder()
+{
+    Close();
+}
+
+// Convert the frame into an 8-bit BGR (colour and Bayer) or grey image.
+bool VideoRecorder::Convert(const uint8_t* buffer, VmbUint32_t bufferSize, const PixelLayout& layout, VmbUint32_t width, VmbUint32_t height, cv::Mat& out)
+{
+    if (!layout.known || ImageBytes(layout.packing, layout.channels, width, height) > bufferSize) {
+        return false;
+    }
+
+    cv::Mat image;
+    if (layout.packing == PixelPacking::Bits8) {
+        image = cv::Mat(height, width, layout.channels == 3 ? CV_8UC3 : CV_8UC1, const_cast<uint8_t*>(buffer));
+    }
+    else {
+        const std::size_t samples = static_cast<std::size_t>(width) * height * layout.channels;
+        m_unpacked.resize(samples);
+        UnpackTo16(buffer, layout.packing, samples, m_unpacked.data());
+        cv::Mat unpacked(height, width, layout.channels == 3 ? CV_16UC3 : CV_16UC1, m_unpacked.data());
+        unpacked.convertTo(m_scaled, layout.channels == 3 ? CV_8UC3 : CV_8UC1, 1.0 / (1u << (layout.bitDepth - 8)));
+        image = m_scaled;
+    }
+
+    const int demosaic = layout.channels == 1 ? DemosaicCode(BayerPattern(layout.format)) : -1;
+    if (demosaic >= 0) {
+        cv::cvtColor(image, out, demosaic);
+    }
+    else if (layout.channels == 3 && !layout.bgr) {
+        cv::cvtColor(image, out, cv::COLOR_RGB2BGR);
+    }
+    else {
+        image.copyTo(out);
+    }
+    return true;
+}
+
+bool VideoRecorder::Write(const uint8_t* buffer, VmbUint32_t bufferSize, const PixelLayout& layout, VmbUint32_t width, VmbUint32_t height, uint64_t frameCounter, const FrameMetadata& meta)
+{
+    Job job;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_closing) {
+            return false;
+        }
+        if (m_jobs.size() >= m_queueDepth) {
+            m_dropped++;
+            return false;
+        }
+        if (!m_spare.empty()) {
+            job.image = m_spare.back();
+            m_spare.pop_back();
+        }
+    }
+
+    if (!Convert(buffer, bufferSize, layout, width, height, job.image)) {
+        m_logger->error("Frame " + std::to_string(frameCounter) + " cannot be converted for video (" + PixelFormatToString(layout.format) + ").");
+        return false;
+    }
+    job.frameCounter = frameCounter;
+    job.meta = meta;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_jobs.push_back(std::move(job));
+    m_work.notify_one();
+    return true;
+}
+
+bool VideoRecorder::OpenSegment(const cv::Mat& image)
+{
+    const bool h264 = m_settings.codec == VideoCodec::H264;
+    std::ostringstream name;
+    name << m_saveDir << "/video_" << std::setw(4) << std::setfill('0') << m_segment;
+    const std::string path = name.str() + (h264 ? ".mkv" : ".avi");
+
+    std::vector<int> params = {cv::VIDEOWRITER_PROP_IS_COLOR, image.channels() == 3 ? 1 : 0};
+    bool opened;
+    if (h264) {
+        opened = m_video.open(path, cv::CAP_FFMPEG, cv::VideoWriter::fourcc('a', 'v', 'c', '1'), m_settings.fps, cv::Size(image.cols, image.rows), params);
+    }
+    else {
+        opened = m_video.open(path, cv::CAP_OPENCV_MJPEG, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), m_settings.fps, cv::Size(image.cols, image.rows), params);
+    }
+    if (!opened || !m_video.isOpened()) {
+        m_logger->error("Could not open video segment " + path);
+        return false;
+    }
+    // The MJPEG writer only reads IS_COLOR from the open() parameters; quality and stripes are properties.
+    if (!h264) {
+        if (!m_video.set(cv::VIDEOWRITER_PROP_QUALITY, m_settings.quality)) {
+            m_logger->error("Could not set MJPEG quality " + std::to_string(m_settings.quality) + " on " + path);
+        }
+        if (!m_video.set(cv::VIDEOWRITER_PROP_NSTRIPES, m_settings.threads)) {
+            m_logger->error("Could not set " + std::to_string(m_settings.threads) + " MJPEG encoder stripes on " + path);
+        }
+    }
+
+    m_sidecar.open(name.str() + ".csv", std::ios::out | std::ios::trunc);
+    m_sidecar << "index,frame,frame_id,timestamp,exposure_us\n";
+    m_segmentFrames = 0;
+    m_segmentStart = std::chrono::steady_clock::now();
+    if (!m_timing) {
+        m_logger->log("Video segment " + path + " started.");
+    }
+    return true;
+}
+
+void VideoRecorder::CloseSegment()
+{
+    if (!m_video.isOpened()) {
+        return;
+    }
+    m_video.release();
+    m_sidecar.close();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_segmentStart).count();
+    if (!m_timing) {
+        m_logger->log("Video segment " + std::to_string(m_segment) + ": " + std::to_string(m_segmentFrames) + " frames in "
+                      + std::to_string(static_cast<int>(seconds)) + " s.");
+    }
+    m_segment++;
+}
+
+// Encoder thread: starts a new segment when the current one is full and writes the queued frames.
+void VideoRecorder::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_work.wait(lock, [this] { return !m_jobs.empty() || m_closing; });
+        if (m_jobs.empty()) {
+            break;
+        }
+        Job job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        lock.unlock();
+
+        if (m_video.isOpened() && std::chrono::steady_clock::now() - m_segmentStart >= std::chrono::duration<double>(m_settings.segmentSeconds)) {
+            CloseSegment();
+        }
+        if (m_video.isOpened() || OpenSegment(job.image)) {
+            auto start = std::chrono::steady_clock::now();
+            m_video.write(job.image);
+            m_encodeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            m_sidecar << m_segmentFrames++ << "," << job.frameCounter << "," << job.meta.frameId << "," << job.meta.timestamp << "," << job.meta.exposure << "\n";
+            m_encoded++;
+        }
+
+        lock.lock();
+        m_spare.push_back(job.image);
+    }
+    lock.unlock();
+    CloseSegment();
+}
+
+void VideoRecorder::Close()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_closed) {
+            return;
+        }
+        m_closed = true;
+        m_closing = true;
+    }
+    m_work.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    if (m_encoded > 0 && m_encodeSeconds > 0.0) {
+        const double fps = m_encoded / m_encodeSeconds;
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(1) << "Video: " << m_encoded << " frames in " << m_segment << " segments, encode "
+            << fps << " fps for " << m_settings.fps << " fps capture (" << (fps >= m_settings.fps ? "keeps up" : "falls behind")
+            << "), " << m_dropped << " frames dropped.";
+        m_logger->log(oss.str());
+    }
+}
+
+}} // namespace VmbCPP
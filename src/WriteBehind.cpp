@@ -0,0 +1,113 @@
+#include "WriteBehind.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Files kept open while their writeback is in flight, whatever their size.
+static const std::size_t kMaxPending = 64;
+
+
+WriteBehind::WriteBehind(std::size_t budgetBytes) : budgetBytes(budgetBytes)
+{
+}
+
+WriteBehind::~WriteBehind()
+{
+	drain();
+}
+
+bool WriteBehind::fail(const std::string& what, const std::string& path)
+{
+	lastError = what + " " + path + ": " + std::strerror(errno);
+	return false;
+}
+
+bool WriteBehind::write(const std::string& path, const void* data, std::size_t bytes, uint64_t id)
+{
+	int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0) {
+		return fail("Could not open", path);
+	}
+
+	// Reserve the extents up front so the filesystem allocates them in one piece. Not every filesystem
+	// supports it, which only costs the layout.
+	if (bytes > 0 && ::fallocate(fd, 0, 0, static_cast<off_t>(bytes)) != 0 && errno != EOPNOTSUPP && errno != ENOSYS) {
+		fail("Could not preallocate", path);
+		::close(fd);
+		return false;
+	}
+
+	const char* p = static_cast<const char*>(data);
+	std::size_t left = bytes;
+	while (left > 0) {
+		ssize_t n = ::write(fd, p, left);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			fail("Could not write", path);
+			::close(fd);
+			return false;
+		}
+		p += n;
+		left -= static_cast<std::size_t>(n);
+	}
+
+	// Start writeback now rather than when the kernel's dirty thresholds are hit.
+	::sync_file_range(fd, 0, static_cast<off_t>(bytes), SYNC_FILE_RANGE_WRITE);
+	pending.push_back({fd, bytes, path, id});
+	dirtyBytes += bytes;
+
+	// Failures of the files retired here belong to those files and are left in failures().
+	if (dirtyBytes > budgetBytes || pending.size() > kMaxPending) {
+		auto start = std::chrono::steady_clock::now();
+		waitCount++;
+		while (!pending.empty() && (dirtyBytes > budgetBytes || pending.size() > kMaxPending)) {
+			retire();
+		}
+		waited += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+	return true;
+}
+
+bool WriteBehind::drain()
+{
+	bool ok = true;
+	while (!pending.empty()) {
+		ok = retire() && ok;
+	}
+	return ok;
+}
+
+std::vector<WriteBehind::Failure> WriteBehind::failures()
+{
+	std::vector<Failure> out;
+	out.swap(failed);
+	return out;
+}
+
+// Wait for the oldest file to reach the disk, then drop its pages and close it.
+bool WriteBehind::retire()
+{
+	Pending file = pending.front();
+	pending.pop_front();
+	dirtyBytes -= file.bytes;
+
+	bool ok = true;
+	if (::sync_file_range(file.fd, 0, static_cast<off_t>(file.bytes),
+			SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER) != 0) {
+		ok = fail("Could not flush", file.path);
+	}
+	::posix_fadvise(file.fd, 0, static_cast<off_t>(file.bytes), POSIX_FADV_DONTNEED);
+	if (::close(file.fd) != 0 && ok) {
+		ok = fail("Could not close", file.path);
+	}
+	if (!ok) {
+		failed.push_back({file.id, lastError});
+	}
+	return ok;
+}
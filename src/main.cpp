@@ -20,10 +20,19 @@
 #include <thread>
 #include <condition_variable>
 #include <vector>
+#include <algorithm>
 
 namespace fs = std::filesystem;
 using namespace std::chrono;
 
+// Raise a black-box event if key is <E> or SIGUSR1 arrived since the last poll. Called from every capture loop.
+static void PollEvent(VmbCPP::Examples::Driver& driver, bool blackbox, char key)
+{
+	if (blackbox && (key == 'e' || key == 'E' || EventRequested())) {
+		driver.TriggerEvent();
+	}
+}
+
 int main(int argc, char* argv[])
 {
 	SetupSignalHandler();
@@ -46,12 +55,51 @@ int main(int argc, char* argv[])
     double exposureTime = 100000.0;
 	bool exposureFlag = false;
     std::string mode = "fixed";
+    size_t burstFrames = 0;
     bool processing = false;
     bool debug = false;
     bool timing = false;
 	bool running = true;
     int core = -1;
     VmbCPP::Examples::ROI roi;
+    bool focus = false;
+    Rect focusRoi;
+    FocusMetric focusMetric = FocusMetric::LaplacianVariance;
+    bool stats = false;
+    FrameStatsSettings statsSettings;
+    int previewEvery = 0;
+    uint32_t previewScale = 8;
+    bool autoExposure = false;
+    std::string pixelFormat;
+    std::string imageFormat = "png";
+    bool tiffDeflate = false;
+    AutoExposureSettings aeSettings;
+    std::string calibDir = "/home/sst/data/alvium_calib";
+    size_t calibFrames = 16;
+    StackMethod calibStack = StackMethod::Mean;
+    bool correct = false;
+    size_t stackFrames = 0;
+    StackMethod stackMethod = StackMethod::Mean;
+    double stackKappa = 2.5;
+    CompressionCodec compression = CompressionCodec::None;
+    int compressionLevel = 1;
+    uint32_t chunkRows = 64;
+    std::size_t dirtyMB = 64;
+    std::vector<std::string> stripeDirs;
+    int journalMs = 100;
+    bool directDelivery = false;
+    VmbCPP::Examples::StripePolicy stripePolicy = VmbCPP::Examples::StripePolicy::RoundRobin;
+    bool blackbox = false;
+    bool video = false;
+    VmbCPP::Examples::VideoSettings videoSettings;
+    double preEvent = 0.0;
+    double postEvent = 0.0;
+    size_t ringMegabytes = 1024;
+    std::string eventLine;
+    std::string profilePath;
+    std::string cameraId;
+    std::string transportLayers;
+    std::string saveProfilePath;
 	
     for (int i = 1; i < argc; ++i) 
     {
@@ -59,7 +107,14 @@ int main(int argc, char* argv[])
 
 	    if (arg == "--output" && i + 1 < argc)
 	    {
-	    	outputDir = argv[++i];
+			// Several directories stripe the frames over them; the first also holds the log and session index.
+			stripeDirs = split(argv[++i], ',');
+			if (stripeDirs.empty() || std::find(stripeDirs.begin(), stripeDirs.end(), "") != stripeDirs.end())
+			{
+				std::cerr << "Invalid output. Use: --output directory[,directory...]\n";
+				return 1;
+			}
+	    	outputDir = stripeDirs.front();
 			loggerFile = outputDir / "alvium_log.txt";
     	}
 	    else if (arg == "--framerate" && i + 1 < argc)
@@ -75,11 +130,21 @@ int main(int argc, char* argv[])
 	    else if (arg == "--mode" && i + 1 < argc)
 	    {
 		    mode = argv[++i];
-		    if (mode != "fixed" && mode != "trigger" && mode != "trigger_keyboard" && mode != "exposure")
+		    if (mode != "fixed" && mode != "trigger" && mode != "trigger_keyboard" && mode != "exposure" && mode != "calibrate_dark" && mode != "calibrate_flat" && mode != "burst")
 		    {
-			    std::cerr << "Invalid mode. Use 'fixed', 'trigger', 'trigger_keyboard' or 'exposure'.\n";
+			    std::cerr << "Invalid mode. Use 'fixed', 'trigger', 'trigger_keyboard', 'exposure', 'calibrate_dark', 'calibrate_flat' or 'burst <N>'.\n";
 			    return 1;
 		    }
+		    if (mode == "burst")
+		    {
+			    int frames = i + 1 < argc ? std::atoi(argv[++i]) : 0;
+			    if (frames <= 0)
+			    {
+				    std::cerr << "Burst mode needs a frame count, e.g. --mode burst 200.\n";
+				    return 1;
+			    }
+			    burstFrames = static_cast<size_t>(frames);
+		    }
 	    }
 	    else if (arg == "--exposure" && i + 1 < argc)
 	    {
@@ -143,6 +208,320 @@ int main(int argc, char* argv[])
                 }
             }
         }
+        else if (arg == "--focus")
+        {
+            focus = true;
+        }
+        else if (arg == "--focus_roi" && i + 1 < argc)
+        {
+            auto focus_params = split(argv[++i], ',');
+            if (focus_params.size() != 4)
+            {
+                std::cerr << "Invalid focus ROI format. Use: --focus_roi width,height,offsetX,offsetY\n";
+                return 1;
+            }
+            focusRoi.width = std::stoi(focus_params[0]);
+            focusRoi.height = std::stoi(focus_params[1]);
+            focusRoi.x = std::stoi(focus_params[2]);
+            focusRoi.y = std::stoi(focus_params[3]);
+            focus = true;
+        }
+        else if (arg == "--focus_metric" && i + 1 < argc)
+        {
+            try
+            {
+                focusMetric = ParseFocusMetric(argv[++i]);
+            }
+            catch (const std::invalid_argument&)
+            {
+                std::cerr << "Invalid focus metric. Use 'laplacian', 'tenengrad' or 'nge'.\n";
+                return 1;
+            }
+            focus = true;
+        }
+        else if (arg == "--stats" && i + 1 < argc)
+        {
+            statsSettings.step = std::stoi(argv[++i]);
+            if (statsSettings.step != 4 && statsSettings.step != 8)
+            {
+                std::cerr << "Statistics sampling step must be 4 or 8.\n";
+                return 1;
+            }
+            stats = true;
+        }
+        else if (arg == "--preview" && i + 1 < argc)
+        {
+            auto preview_params = split(argv[++i], ',');
+            if (preview_params.empty() || preview_params.size() > 2)
+            {
+                std::cerr << "Invalid preview format. Use: --preview everyN[,scale]\n";
+                return 1;
+            }
+            previewEvery = std::stoi(preview_params[0]);
+            if (preview_params.size() == 2)
+            {
+                previewScale = std::stoi(preview_params[1]);
+            }
+            if (previewEvery < 1 || previewScale < 1 || previewScale > 16)
+            {
+                std::cerr << "Preview needs every >= 1 and a scale between 1 and 16.\n";
+                return 1;
+            }
+        }
+        else if (arg == "--ae" && i + 1 < argc)
+        {
+            try
+            {
+                aeSettings = ParseAutoExposureTarget(argv[++i]);
+            }
+            catch (const std::invalid_argument& e)
+            {
+                std::cerr << e.what() << ". Use e.g. --ae mean:118 or --ae p99:230\n";
+                return 1;
+            }
+            autoExposure = true;
+        }
+        else if (arg == "--pixelformat" && i + 1 < argc)
+        {
+            pixelFormat = argv[++i];
+        }
+        else if (arg == "--save_format" && i + 1 < argc)
+        {
+            imageFormat = argv[++i];
+            if (imageFormat != "png" && imageFormat != "tiff" && imageFormat != "dng")
+            {
+                std::cerr << "Invalid save format. Use 'png', 'tiff' or 'dng'.\n";
+                return 1;
+            }
+        }
+        else if (arg == "--tiff_deflate")
+        {
+            tiffDeflate = true;
+        }
+        else if (arg == "--video" && i + 1 < argc)
+        {
+            try
+            {
+                videoSettings.codec = VmbCPP::Examples::ParseVideoCodec(argv[++i]);
+                video = true;
+            }
+            catch (const std::invalid_argument&)
+            {
+                std::cerr << "Invalid video codec. Use: --video mjpg or --video h264\n";
+                return 1;
+            }
+        }
+        else if (arg == "--video_quality" && i + 1 < argc)
+        {
+            videoSettings.quality = std::stoi(argv[++i]);
+            if (videoSettings.quality < 1 || videoSettings.quality > 100)
+            {
+                std::cerr << "Video quality must be between 1 and 100.\n";
+                return 1;
+            }
+        }
+        else if (arg == "--video_bitrate" && i + 1 < argc)
+        {
+            videoSettings.bitrateKbps = std::stoi(argv[++i]);
+            if (videoSettings.bitrateKbps < 0)
+            {
+                std::cerr << "Video bitrate must be positive (kbit/s).\n";
+                return 1;
+            }
+        }
+        else if (arg == "--video_segment" && i + 1 < argc)
+        {
+            videoSettings.segmentSeconds = std::stod(argv[++i]);
+            if (videoSettings.segmentSeconds < 1.0)
+            {
+                std::cerr << "Video segments must be at least 1 s long.\n";
+                return 1;
+            }
+        }
+        else if (arg == "--video_threads" && i + 1 < argc)
+        {
+            videoSettings.threads = std::stoi(argv[++i]);
+            if (videoSettings.threads < 1 || videoSettings.threads > 4)
+            {
+                std::cerr << "Video encoder threads must be between 1 and 4.\n";
+                return 1;
+            }
+        }
+        else if (arg == "--calib_dir" && i + 1 < argc)
+        {
+            calibDir = argv[++i];
+        }
+        else if (arg == "--calib_frames" && i + 1 < argc)
+        {
+            int frames = std::stoi(argv[++i]);
+            if (frames < 1 || frames > 256)
+            {
+                std::cerr << "Calibration frame count must be between 1 and 256.\n";
+                return 1;
+            }
+            calibFrames = frames;
+        }
+        else if (arg == "--calib_stack" && i + 1 < argc)
+        {
+            try
+            {
+                calibStack = ParseStackMethod(argv[++i]);
+            }
+            catch (const std::invalid_argument&)
+            {
+                std::cerr << "Invalid calibration stacking. Use 'mean', 'median' or 'sigma'.\n";
+                return 1;
+            }
+        }
+        else if (arg == "--correct")
+        {
+            correct = true;
+        }
+        else if (arg == "--stack" && i + 1 < argc)
+        {
+            auto stack_params = split(argv[++i], ',');
+            if (stack_params.empty() || stack_params.size() > 3)
+            {
+                std::cerr << "Invalid stack format. Use: --stack K[,mean|median|sigma[,kappa]]\n";
+                return 1;
+            }
+            try
+            {
+                int frames = std::stoi(stack_params[0]);
+                if (frames < 2 || frames > 256)
+                {
+                    std::cerr << "Stack size must be between 2 and 256 frames.\n";
+                    return 1;
+                }
+                stackFrames = frames;
+                if (stack_params.size() > 1)
+                {
+                    stackMethod = ParseStackMethod(stack_params[1]);
+                }
+                if (stack_params.size() > 2)
+                {
+                    stackKappa = std::stod(stack_params[2]);
+                }
+            }
+            catch (const std::invalid_argument&)
+            {
+                std::cerr << "Invalid stack format. Use: --stack K[,mean|median|sigma[,kappa]]\n";
+                return 1;
+            }
+        }
+        else if (arg == "--compress" && i + 1 < argc)
+        {
+            auto compress_params = split(argv[++i], ':');
+            try
+            {
+                if (compress_params.empty() || compress_params.size() > 2)
+                {
+                    throw std::invalid_argument("bad format");
+                }
+                compression = ParseCompressionCodec(compress_params[0]);
+                if (compress_params.size() == 2)
+                {
+                    compressionLevel = std::stoi(compress_params[1]);
+                }
+            }
+            catch (const std::invalid_argument&)
+            {
+                std::cerr << "Invalid compression. Use: --compress zstd[:level] or --compress lz4[:acceleration]\n";
+                return 1;
+            }
+        }
+        else if (arg == "--chunk_rows" && i + 1 < argc)
+        {
+            int rows = std::stoi(argv[++i]);
+            if (rows < 4 || rows > 3008)
+            {
+                std::cerr << "Chunk rows must be between 4 and 3008.\n";
+                return 1;
+            }
+            chunkRows = rows;
+        }
+        else if (arg == "--stripe" && i + 1 < argc)
+        {
+            try
+            {
+                stripePolicy = VmbCPP::Examples::ParseStripePolicy(argv[++i]);
+            }
+            catch (const std::invalid_argument&)
+            {
+                std::cerr << "Invalid stripe policy. Use: --stripe rr or --stripe bandwidth\n";
+                return 1;
+            }
+        }
+        else if (arg == "--journal_ms" && i + 1 < argc)
+        {
+            journalMs = std::stoi(argv[++i]);
+            if (journalMs < 0 || journalMs > 10000)
+            {
+                std::cerr << "Journal commit interval must be between 0 and 10000 ms.\n";
+                return 1;
+            }
+        }
+        else if (arg == "--dirty_mb" && i + 1 < argc)
+        {
+            int mb = std::stoi(argv[++i]);
+            if (mb < 0 || mb > 1024)
+            {
+                std::cerr << "Dirty budget must be between 0 and 1024 MB.\n";
+                return 1;
+            }
+            dirtyMB = mb;
+        }
+        else if (arg == "--delivery" && i + 1 < argc)
+        {
+            std::string delivery = argv[++i];
+            if (delivery != "observer" && delivery != "direct")
+            {
+                std::cerr << "Invalid delivery path. Use: --delivery observer or --delivery direct\n";
+                return 1;
+            }
+            directDelivery = delivery == "direct";
+        }
+        else if (arg == "--blackbox" && i + 1 < argc)
+        {
+            auto blackbox_params = split(argv[++i], ',');
+            if (blackbox_params.size() < 2 || blackbox_params.size() > 3)
+            {
+                std::cerr << "Invalid black-box format. Use: --blackbox pre_seconds,post_seconds[,ring_mb]\n";
+                return 1;
+            }
+            preEvent = std::stod(blackbox_params[0]);
+            postEvent = std::stod(blackbox_params[1]);
+            if (blackbox_params.size() == 3)
+            {
+                ringMegabytes = std::stoul(blackbox_params[2]);
+            }
+            if (preEvent < 0.0 || postEvent < 0.0 || ringMegabytes == 0)
+            {
+                std::cerr << "Black-box windows must not be negative and the ring needs memory.\n";
+                return 1;
+            }
+            blackbox = true;
+        }
+        else if (arg == "--blackbox_line" && i + 1 < argc)
+        {
+            eventLine = argv[++i];
+        }
+        else if (arg == "--camera" && i + 1 < argc)
+        {
+            cameraId = argv[++i];
+        }
+        else if (arg == "--tl" && i + 1 < argc)
+        {
+            transportLayers = argv[++i];
+        }
+        else if (arg == "--profile" && i + 1 < argc)
+        {
+            profilePath = argv[++i];
+        }
+        else if (arg == "--save_profile" && i + 1 < argc)
+        {
+            saveProfilePath = argv[++i];
+        }
 
 	    else if (arg == "--help")
 	    {
@@ -152,34 +531,115 @@ int main(int argc, char* argv[])
 		    std::cout << "USAGE:" << std::endl;
 		    std::cout << "	--help		Prints help information" << std::endl << std::endl;
 		    std::cout << "OPTIONS" << std::endl;
-		    std::cout << "	--output	Directory to save images" << std::endl;
+		    std::cout << "	--output	Directory to save images, or a comma-separated list of directories to stripe frames across" << std::endl;
+		    std::cout << "	--stripe	How frames are spread over several --output directories (rr or bandwidth, default rr)" << std::endl;
 		    std::cout << "	--framerate	Desired frame rate (0 - 30 Hz)" << std::endl;
 		    std::cout << "	--exposure	Desired exposure time (64 - 10000000 us)" << std::endl;
 		    std::cout << "	--mode		Choose between fixed frame rate, triggered, and fixed exposure time operation" << std::endl;
+		    std::cout << "			'burst N' captures N frames at the maximum frame rate into N preallocated buffers and writes them afterwards" << std::endl;
 		    std::cout << "	--processing 	Choose whether to save .raw images or .png images" << std::endl;
+		    std::cout << "	--pixelformat	Camera pixel format, e.g. RGB8, Mono8, Mono12 or Mono12p (10/12-bit data is stored packed)" << std::endl;
+		    std::cout << "	--save_format	Image format used with --processing ('png', 'tiff' or 'dng'; TIFF/DNG carry exposure, gain, timestamp, frame ID and ROI)" << std::endl;
+		    std::cout << "	--tiff_deflate	Compress TIFF/DNG files with Deflate and the horizontal predictor" << std::endl;
+		    std::cout << "	--calib_dir	Directory holding master darks and flats (default /home/sst/data/alvium_calib)" << std::endl;
+		    std::cout << "	--calib_frames	Number of frames stacked into a master with --mode calibrate_dark/calibrate_flat (default 16)" << std::endl;
+		    std::cout << "	--calib_stack	Stacking used for masters ('mean', 'median' or 'sigma'; median and sigma keep every frame in memory and are refused beyond half the RAM)" << std::endl;
+		    std::cout << "	--correct	Apply the master dark/flat for the current exposure and ROI before saving" << std::endl;
+		    std::cout << "	--stack		Save one stacked frame per K frames (K[,mean|median|sigma[,kappa]], default mean, kappa 2.5)" << std::endl;
+		    std::cout << "	--compress	Compress raw frames into .rawz files in parallel row chunks (zstd[:level] or lz4[:acceleration])" << std::endl;
+		    std::cout << "	--chunk_rows	Rows per compressed chunk (default 64, rounded up to a multiple of 4)" << std::endl;
+		    std::cout << "	--video	Encode frames into segmented video files instead of images (mjpg or h264)" << std::endl;
+		    std::cout << "	--video_quality	MJPEG quality, 1-100 (default 90)" << std::endl;
+		    std::cout << "	--video_bitrate	H.264 bitrate in kbit/s (default: encoder default)" << std::endl;
+		    std::cout << "	--video_segment	Seconds per video file (default 600)" << std::endl;
+		    std::cout << "	--video_threads	Encoder threads (default 3)" << std::endl;
+		    std::cout << "	--journal_ms	Commit interval of the crash-safe session journal (default 100, 0 = no journal; see alvium_recover)" << std::endl;
+		    std::cout << "	--dirty_mb	Raw frame data allowed in the page cache before the writer waits for the disk (default 64, 0 = kernel writeback)" << std::endl;
+		    std::cout << "	--delivery	observer (VmbCPP frame observers, default) or direct (VmbC callback into a lock-free ring)" << std::endl;
+		    std::cout << "	--blackbox	Keep frames in RAM and only save the windows around events (pre_seconds,post_seconds[,ring_mb], default 1024 MB)" << std::endl;
+		    std::cout << "	--blackbox_line	Also raise black-box events on rising edges of a camera line (e.g. Line0); <E> and SIGUSR1 always do" << std::endl;
+		    std::cout << "	--camera	Camera ID (e.g. DEV_1AB22C00041B) or serial number; an ID is opened without enumerating all cameras" << std::endl;
+		    std::cout << "	--tl		Transport layers to load, .cti files or directories separated by ':' (e.g. the USB TL only)" << std::endl;
+		    std::cout << "	--profile	Camera settings file to apply after the mode and ROI; only features that differ are written" << std::endl;
+		    std::cout << "	--save_profile	Save the camera settings to a file for --profile once the camera is configured" << std::endl;
 		    std::cout << "	--debug		Choose to log DEBUG information" << std::endl;
 		    std::cout << "	--timing	Choose to log only frame timing information" << std::endl;
 		    std::cout << "	--core		Core to lock camera process to" << std::endl;
             std::cout << "  --roi       Choose region of interest (use '1/4' for quarter image, '1/16' for one-sixteenth image, or add a custom width, height, offsetX, and offsetY" << std::endl;
+		    std::cout << "	--focus		Score the focus of every frame and print the running best score" << std::endl;
+		    std::cout << "	--focus_roi	Region of the frame to score for focus (width,height,offsetX,offsetY relative to the frame)" << std::endl;
+		    std::cout << "	--focus_metric	Focus metric to track ('laplacian', 'tenengrad' or 'nge')" << std::endl;
+		    std::cout << "	--stats		Record per-frame quality statistics in frames.meta, sampling every 4th or 8th pixel" << std::endl;
+		    std::cout << "	--ae		Host-side auto-exposure towards a mean or percentile level (e.g. mean:118 or p99:230)" << std::endl;
+		    std::cout << "	--preview	Publish every Nth frame, downsampled (default 1/8), to shared memory for test/preview.py (everyN[,scale])" << std::endl;
             return 1;
 	    }
 	    else {
 		    std::cerr << "Unknown argument: " << arg << "\n";
 		    std::cerr << "Usage: " << argv[0]
-			      << " [--output <directory>] [--framerate <0-30>] [--exposure <64 - 10000000>] [--mode <fixed/trigger/trigger_keyboard/exposure>] [--processing] [--debug] [--timing] [--core <0-3>] [--roi <width,height,offsetX,offsetY>] \n";
+			      << " [--output <directory[,directory...]>] [--stripe <rr/bandwidth>] [--framerate <0-30>] [--exposure <64 - 10000000>] [--mode <fixed/trigger/trigger_keyboard/exposure/calibrate_dark/calibrate_flat/burst N>] [--processing] [--pixelformat <name>] [--save_format <png/tiff/dng>] [--tiff_deflate] [--debug] [--timing] [--core <0-3>] [--roi <width,height,offsetX,offsetY>] [--focus] [--focus_roi <width,height,offsetX,offsetY>] [--focus_metric <laplacian/tenengrad/nge>] [--stats <4/8>] [--preview <everyN[,scale]>] [--ae <mean:level/pNN:level>] [--calib_dir <directory>] [--calib_frames <N>] [--calib_stack <mean/median/sigma>] [--correct] [--stack <K[,method[,kappa]]>] [--compress <zstd[:level]/lz4[:accel]>] [--chunk_rows <N>] [--dirty_mb <N>] [--delivery <observer/direct>] [--journal_ms <ms>] [--video <mjpg/h264>] [--video_quality <1-100>] [--video_bitrate <kbps>] [--video_segment <s>] [--video_threads <1-4>] [--blackbox <pre,post[,ring_mb]>] [--blackbox_line <line>] [--profile <file>] [--save_profile <file>] [--camera <id/serial>] [--tl <cti[:cti...]>] \n";
 		    return 1;
 	    }
 
     }
 
-	if ((mode != "exposure") && (exposureFlag == true)) {
+	bool calibrating = (mode == "calibrate_dark") || (mode == "calibrate_flat");
+
+	if ((mode != "exposure") && !calibrating && (exposureFlag == true)) {
 		std::cerr << "Cannot input custom exposure time when not in exposure mode. Set with --mode 'exposure'." << std::endl;
 	}
 
+	if (video && calibrating) {
+		std::cerr << "Video recording cannot be combined with calibration." << std::endl;
+		return 1;
+	}
+
+	if (blackbox && (stackFrames > 0 || calibrating)) {
+		std::cerr << "Black-box recording cannot be combined with stacking or calibration." << std::endl;
+		return 1;
+	}
+
+	if (mode == "burst" && (video || blackbox || stackFrames > 0 || correct || autoExposure || stripeDirs.size() > 1)) {
+		std::cerr << "Burst mode writes plain frames to one directory and cannot be combined with video, black-box, stacking, correction, auto-exposure or striping." << std::endl;
+		return 1;
+	}
+
 	if ((mode != "fixed") && (mode != "trigger") && (fixedFlag == true)) {
 		std::cerr << "Cannot input fixed frame rate when not in fixed frame rate or trigger mode. Set with --mode 'fixed'." << std::endl; 
 	} 
 
+    if (calibrating || correct)
+    {
+        try
+        {
+            fs::create_directories(calibDir);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Failed to create calibration directory: " << calibDir
+                  << "\nReason: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    for (const auto& dir : stripeDirs)
+    {
+	    if (dir.empty() || dir == outputDir.string() || fs::exists(dir))
+	    {
+		    continue;
+	    }
+	    try
+	    {
+		    fs::create_directories(dir);
+	    }
+	    catch (const std::exception& e)
+	    {
+		    std::cerr << "Failed to create directory: " << dir
+			      << "\nReason: " << e.what() << std::endl;
+		    return 1;
+	    }
+    }
+
     if (!fs::exists(outputDir))
     {
 	    try
@@ -206,14 +666,80 @@ int main(int argc, char* argv[])
 	
     try
     {
-        VmbCPP::Examples::Driver Driver(nullptr, outputDir, logger, frameRate, mode, exposureTime, processing, timing, core, roi);
+        VmbCPP::Examples::Driver Driver(cameraId.empty() ? nullptr : cameraId.c_str(), outputDir, logger, frameRate, mode, exposureTime, processing, timing, core, roi,
+                                        transportLayers.empty() ? nullptr : transportLayers.c_str());
+        if (!pixelFormat.empty()) {
+            Driver.SetPixelFormat(pixelFormat);
+        }
+        if (!profilePath.empty()) {
+            Driver.LoadProfile(profilePath);
+        }
+        if (!saveProfilePath.empty()) {
+            Driver.SaveProfile(saveProfilePath);
+        }
+        Driver.SetImageFormat(imageFormat, tiffDeflate);
+        if (focus) {
+            Driver.EnableFocusScoring(focusRoi, focusMetric);
+        }
+        if (stats) {
+            Driver.EnableFrameStats(statsSettings);
+        }
+        if (previewEvery > 0) {
+            Driver.EnablePreview(previewEvery, previewScale);
+        }
+        if (autoExposure) {
+            Driver.EnableAutoExposure(aeSettings);
+        }
+        if (calibrating) {
+            Driver.EnableCalibrationCapture(mode == "calibrate_dark" ? CalibrationKind::Dark : CalibrationKind::Flat, calibFrames, calibStack, calibDir);
+        }
+        else if (correct) {
+            Driver.EnableCorrection(calibDir);
+        }
+        if (compression != CompressionCodec::None) {
+            Driver.EnableCompression(compression, compressionLevel, chunkRows);
+        }
+        Driver.SetDirtyBudget(dirtyMB << 20);
+        if (directDelivery) {
+            Driver.EnableDirectDelivery();
+        }
+        Driver.SetJournalInterval(std::chrono::milliseconds(journalMs));
+        if (stripeDirs.size() > 1) {
+            Driver.SetStripeTargets(stripeDirs, stripePolicy);
+        }
+        if (stackFrames > 0 && !calibrating) {
+            Driver.EnableStacking(stackFrames, stackMethod, stackKappa);
+        }
+        if (video) {
+            Driver.EnableVideo(videoSettings);
+        }
+        if (blackbox) {
+            Driver.EnableBlackbox(preEvent, postEvent, ringMegabytes);
+            if (!eventLine.empty()) {
+                Driver.EnableLineEvent(eventLine);
+            }
+        }
+
+        if (mode == "burst") {
+            Driver.CaptureBurst(burstFrames);
+            return 0;
+        }
 		
 		Driver.Start();
 		initTermios();
+		if (blackbox) {
+			std::cout << "Press <E> or send SIGUSR1 to save the frames around an event." << std::endl;
+		}
 		
-        if ((mode == "fixed") || (mode == "exposure")) {
+        if ((mode == "fixed") || (mode == "exposure") || calibrating) {
 				std::cout << "Press <enter> to stop acquisition" << std::endl;
 				while(running) {
+					if (calibrating && Driver.CalibrationDone()) {
+						running = false;
+						std::cout << "Calibration master saved. Shutting down..." << std::endl;
+						break;
+					}
+
 					if (StopRequested()) {
 						running = false;
 						logger->log("Interrupt signal detected. Shutting down.");
@@ -223,6 +749,7 @@ int main(int argc, char* argv[])
 					
 					char c;
 					c = getch();
+					PollEvent(Driver, blackbox, c);
 					if (c == '\n') {
 						running = false;
 						logger->log("Exit key pressed. Shutting down.");
@@ -243,6 +770,7 @@ int main(int argc, char* argv[])
 
 				char c;
 				c = getch();
+				PollEvent(Driver, blackbox, c);
 				if (c == 'f' || c == 'F') {
 					Driver.TriggerFrame();
 				}
@@ -269,6 +797,7 @@ int main(int argc, char* argv[])
                 }
                 char c;
                 c = getch();
+                PollEvent(Driver, blackbox, c);
                 if (c == '\n') {
                     running = false;
                     logger->log("Exit key pressed. Shutting down.");
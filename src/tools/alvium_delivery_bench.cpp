@@ -0,0 +1,246 @@
+/*=============================================================================
+  Frame delivery latency: VmbCPP observer path against the direct ring.
+
+  Replays the hand-off from the SDK's capture thread to the driver's worker
+  without a camera. The observer path does what FrameHandler and the driver
+  do per frame: lock the handler mutex, copy the FramePtr, call the virtual
+  FrameReceived() and push into the mutex/condition-variable FrameQueue. The
+  direct path copies a FrameDescriptor into FrameDescriptorRing. For each
+  path it prints the time spent in the callback and the time from callback
+  entry until the worker has the frame, in microseconds. Built with
+  -DALVIUM_BUILD_BENCHMARKS=ON.
+=============================================================================*/
+
+#include "FrameDescriptorRing.h"
+
+#include <VmbCPP/SharedPointer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct FakeFrame
+{
+	std::vector<uint8_t> buffer;
+	std::atomic<int64_t> callbackNs{0};	// Rewritten when the handler is reused, like the SDK reuses a frame
+};
+using FakeFramePtr = VmbCPP::shared_ptr<FakeFrame>;
+
+// The driver's FrameQueue.
+class ObserverQueue
+{
+public:
+	void push(const FakeFramePtr& f)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		q.push(f);
+		cv.notify_one();
+	}
+	bool pop(FakeFramePtr& f)
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		cv.wait(lock, [&] { return !q.empty() || closed; });
+		if (q.empty())
+		{
+			return false;
+		}
+		f = q.front();
+		q.pop();
+		return true;
+	}
+	void close()
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		closed = true;
+		cv.notify_one();
+	}
+
+private:
+	std::queue<FakeFramePtr> q;
+	std::mutex mtx;
+	std::condition_variable cv;
+	bool closed = false;
+};
+
+class Observer
+{
+public:
+	virtual ~Observer() = default;
+	virtual void FrameReceived(const FakeFramePtr frame) = 0;
+};
+
+class QueueObserver : public Observer
+{
+public:
+	explicit QueueObserver(ObserverQueue& queue) : m_queue(queue) {}
+	void FrameReceived(const FakeFramePtr frame) override { m_queue.push(frame); }
+
+private:
+	ObserverQueue& m_queue;
+};
+
+// FrameHandler: the frame and its observer behind a mutex.
+struct Handler
+{
+	FakeFramePtr frame;
+	VmbCPP::shared_ptr<Observer> observer;
+	std::mutex mutex;
+};
+
+static void PrintUsage(const char* prog)
+{
+	std::cerr << "Usage: " << prog << " [--frames <20000>] [--fps <1000>]\n";
+}
+
+static double Percentile(std::vector<double>& v, double p)
+{
+	std::size_t k = std::min(v.size() - 1, static_cast<std::size_t>(p * (v.size() - 1) + 0.5));
+	std::nth_element(v.begin(), v.begin() + k, v.end());
+	return v[k];
+}
+
+static void Report(const std::string& path, std::vector<double>& callbackUs, std::vector<double>& latencyUs)
+{
+	std::cout << path << ","
+		  << Percentile(callbackUs, 0.50) << "," << Percentile(callbackUs, 0.99) << ","
+		  << Percentile(latencyUs, 0.50) << "," << Percentile(latencyUs, 0.99) << ","
+		  << *std::max_element(latencyUs.begin(), latencyUs.end()) << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	int frames = 20000;
+	double fps = 1000.0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+
+		if (arg == "--frames" && i + 1 < argc)
+		{
+			frames = std::max(1, std::stoi(argv[++i]));
+		}
+		else if (arg == "--fps" && i + 1 < argc)
+		{
+			fps = std::stod(argv[++i]);
+		}
+		else
+		{
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+	if (fps <= 0.0)
+	{
+		PrintUsage(argv[0]);
+		return 1;
+	}
+	const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+	const std::size_t buffers = 5;
+
+	std::cout << "path,callback_p50_us,callback_p99_us,latency_p50_us,latency_p99_us,latency_max_us\n" << std::fixed << std::setprecision(2);
+
+	// Observer path.
+	{
+		ObserverQueue queue;
+		std::vector<Handler> handlers(buffers);
+		VmbCPP::shared_ptr<Observer> observer(new QueueObserver(queue));
+		for (auto& handler : handlers)
+		{
+			handler.frame = VmbCPP::make_shared<FakeFrame>();
+			handler.observer = observer;
+		}
+
+		std::vector<double> latencyUs;
+		latencyUs.reserve(frames);
+		std::thread worker([&] {
+			FakeFramePtr frame;
+			while (queue.pop(frame))
+			{
+				const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+				latencyUs.push_back((now - frame->callbackNs.load()) / 1e3);
+			}
+		});
+
+		std::vector<double> callbackUs;
+		callbackUs.reserve(frames);
+		auto next = Clock::now();
+		for (int i = 0; i < frames; ++i)
+		{
+			std::this_thread::sleep_until(next);
+			next += period;
+			Handler& handler = handlers[i % buffers];
+			auto t0 = Clock::now();
+			handler.frame->callbackNs = std::chrono::duration_cast<std::chrono::nanoseconds>(t0.time_since_epoch()).count();
+			{
+				std::lock_guard<std::mutex> lock(handler.mutex);
+				FakeFramePtr frame = handler.frame;
+				VmbCPP::shared_ptr<Observer> target = handler.observer;
+				target->FrameReceived(frame);
+			}
+			callbackUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+		}
+		queue.close();
+		worker.join();
+		Report("observer", callbackUs, latencyUs);
+	}
+
+	// Direct path.
+	{
+		// No buffers are recycled here, so give the ring the slack the unbounded FrameQueue has.
+		FrameDescriptorRing ring(64);
+		std::vector<double> latencyUs;
+		latencyUs.reserve(frames);
+		std::atomic<bool> done{false};
+		std::thread worker([&] {
+			FrameDescriptor d;
+			while (true)
+			{
+				if (ring.pop(d, std::chrono::milliseconds(100)))
+				{
+					const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+					latencyUs.push_back((now - d.deliveredNs) / 1e3);
+				}
+				else if (done)
+				{
+					break;
+				}
+			}
+		});
+
+		std::vector<double> callbackUs;
+		callbackUs.reserve(frames);
+		auto next = Clock::now();
+		for (int i = 0; i < frames; ++i)
+		{
+			std::this_thread::sleep_until(next);
+			next += period;
+			auto t0 = Clock::now();
+			FrameDescriptor d;
+			d.deliveredNs = std::chrono::duration_cast<std::chrono::nanoseconds>(t0.time_since_epoch()).count();
+			d.index = static_cast<uint32_t>(i % buffers);
+			d.frameId = static_cast<uint64_t>(i);
+			ring.push(d);
+			callbackUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+		}
+		done = true;
+		ring.close();
+		worker.join();
+		Report("direct", callbackUs, latencyUs);
+		if (ring.dropped() > 0)
+		{
+			std::cerr << ring.dropped() << " descriptors dropped\n";
+		}
+	}
+	return 0;
+}
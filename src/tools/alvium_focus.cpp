@@ -0,0 +1,238 @@
+/*=============================================================================
+  Offline focus scoring over a recorded session.
+
+  Scores every .raw or .png frame in a folder with the same engine the driver
+  uses live (--focus) and reports the sharpest frame. Output is CSV on stdout,
+  followed by a final "best,<file>,<score>" line for scripts such as
+  test/calibration.py. The size and storage format of .raw frames are taken
+  from the session's alvium_log.txt unless given on the command line.
+=============================================================================*/
+
+#include "FocusMetrics.h"
+#include "PixelFormat.h"
+#include "Utils.h"
+
+#include <opencv2/opencv.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static void PrintUsage(const char* prog)
+{
+	std::cerr << "Usage: " << prog
+		  << " --input <directory> [--width <4128>] [--height <3008>] [--pixel_format <RGB8/Mono12p/...>]"
+		  << " [--roi <width,height,offsetX,offsetY>] [--metric <laplacian/tenengrad/nge>] [--threads <n>]\n";
+}
+
+// Storage format and size from the "Raw frames stored as ..." line the driver writes to alvium_log.txt.
+static bool ReadStoredFormat(const fs::path& logFile, std::string& format, uint32_t& width, uint32_t& height)
+{
+	const std::string marker = "Raw frames stored as ";
+	std::ifstream in(logFile);
+	std::string line;
+	bool found = false;
+	while (std::getline(in, line))
+	{
+		std::size_t pos = line.find(marker);
+		char name[32];
+		unsigned w = 0;
+		unsigned h = 0;
+		if (pos != std::string::npos && std::sscanf(line.c_str() + pos + marker.size(), "%31s %ux%u", name, &w, &h) == 3)
+		{
+			format = name;
+			width = w;
+			height = h;
+			found = true;
+		}
+	}
+	return found;
+}
+
+int main(int argc, char* argv[])
+{
+	fs::path inputDir;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	std::string pixelFormat;
+	Rect roi;
+	FocusMetric metric = FocusMetric::LaplacianVariance;
+	std::size_t threads = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+
+		if (arg == "--input" && i + 1 < argc)
+		{
+			inputDir = argv[++i];
+		}
+		else if (arg == "--width" && i + 1 < argc)
+		{
+			width = std::stoi(argv[++i]);
+		}
+		else if (arg == "--height" && i + 1 < argc)
+		{
+			height = std::stoi(argv[++i]);
+		}
+		else if (arg == "--pixel_format" && i + 1 < argc)
+		{
+			pixelFormat = argv[++i];
+		}
+		else if (arg == "--roi" && i + 1 < argc)
+		{
+			auto roi_params = split(argv[++i], ',');
+			if (roi_params.size() != 4)
+			{
+				std::cerr << "Invalid ROI format. Use: --roi width,height,offsetX,offsetY\n";
+				return 1;
+			}
+			roi.width = std::stoi(roi_params[0]);
+			roi.height = std::stoi(roi_params[1]);
+			roi.x = std::stoi(roi_params[2]);
+			roi.y = std::stoi(roi_params[3]);
+		}
+		else if (arg == "--metric" && i + 1 < argc)
+		{
+			try
+			{
+				metric = ParseFocusMetric(argv[++i]);
+			}
+			catch (const std::invalid_argument& e)
+			{
+				std::cerr << e.what() << "\n";
+				return 1;
+			}
+		}
+		else if (arg == "--threads" && i + 1 < argc)
+		{
+			threads = std::stoi(argv[++i]);
+		}
+		else
+		{
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (inputDir.empty() || !fs::is_directory(inputDir))
+	{
+		PrintUsage(argv[0]);
+		return 1;
+	}
+
+	// Command line values win over the session log; sessions without a log fall back to 4128x3008 RGB8.
+	std::string loggedFormat = "RGB8";
+	uint32_t loggedWidth = 4128;
+	uint32_t loggedHeight = 3008;
+	ReadStoredFormat(inputDir / "alvium_log.txt", loggedFormat, loggedWidth, loggedHeight);
+	if (pixelFormat.empty())
+	{
+		pixelFormat = loggedFormat;
+	}
+	if (width == 0)
+	{
+		width = loggedWidth;
+	}
+	if (height == 0)
+	{
+		height = loggedHeight;
+	}
+
+	const PixelLayout layout = ParseStorageFormat(pixelFormat);
+	if (!layout.known)
+	{
+		std::cerr << "Unknown pixel format " << pixelFormat << "\n";
+		return 1;
+	}
+
+	std::vector<fs::path> files;
+	for (const auto& entry : fs::directory_iterator(inputDir))
+	{
+		std::string ext = entry.path().extension().string();
+		if (ext == ".raw" || ext == ".png")
+		{
+			files.push_back(entry.path());
+		}
+	}
+	std::sort(files.begin(), files.end());
+
+	if (files.empty())
+	{
+		std::cerr << "No .raw or .png frames found in " << inputDir << "\n";
+		return 1;
+	}
+
+	FocusScorer scorer(roi, threads);
+	std::vector<uint8_t> raw;
+	std::vector<uint16_t> unpacked;
+	std::vector<uint8_t> scratch;
+	std::string bestFile;
+	double bestScore = -1.0;
+
+	std::cout << "file,laplacian,tenengrad,nge,mean_luma\n";
+	std::cout << std::setprecision(6);
+
+	for (const auto& path : files)
+	{
+		ImageView view;
+		cv::Mat img;
+
+		if (path.extension() == ".raw")
+		{
+			// Deeper formats are unpacked and narrowed to 8 bits, as the driver does for live scoring.
+			raw.resize(ImageBytes(layout.packing, layout.channels, width, height));
+			std::ifstream in(path, std::ios::binary);
+			if (!in.read(reinterpret_cast<char*>(raw.data()), raw.size()))
+			{
+				std::cerr << "Skipping " << path << ": shorter than a " << width << "x" << height << " " << pixelFormat << " frame\n";
+				continue;
+			}
+			view = AnalysisView(raw.data(), layout, width, height, unpacked, scratch);
+		}
+		else
+		{
+			img = cv::imread(path.string(), cv::IMREAD_UNCHANGED);
+			if (img.empty() || img.elemSize1() != 1 || !img.isContinuous())
+			{
+				std::cerr << "Skipping " << path << ": not an 8-bit image\n";
+				continue;
+			}
+			view.data = img.data;
+			view.width = img.cols;
+			view.height = img.rows;
+			view.channels = img.channels();
+			view.stride = img.step[0];
+		}
+
+		FocusScores scores = scorer.score(view);
+		std::cout << path.filename().string() << ","
+			  << scores.laplacianVariance << ","
+			  << scores.tenengrad << ","
+			  << scores.normalizedGradientEnergy << ","
+			  << scores.meanLuma << "\n";
+
+		double value = FocusScore(scores, metric);
+		if (value > bestScore)
+		{
+			bestScore = value;
+			bestFile = path.string();
+		}
+	}
+
+	if (bestFile.empty())
+	{
+		std::cerr << "No frames could be scored.\n";
+		return 1;
+	}
+
+	std::cout << "best," << bestFile << "," << bestScore << std::endl;
+	return 0;
+}
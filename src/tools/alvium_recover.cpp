@@ -0,0 +1,216 @@
+/*=============================================================================
+  Rebuild the frame index of a session from its journal.
+
+  Reads session.journal in the session's (first) output directory, drops a
+  torn tail left by a crash, checks that every journaled frame file is still
+  there with the size and CRC-32 it had when it was synced and committed
+  (sizes alone prove nothing, the raw writer preallocates), and writes the frames
+  that pass to session_index.csv (sequence,frame,target,path) in frame order,
+  the same index a striped session writes when it ends cleanly. Frame files
+  that were written after the last journal commit are counted but not
+  indexed, since nothing vouches that they are complete.
+=============================================================================*/
+
+#include "Crc32.h"
+#include "SessionJournal.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+static void PrintUsage(const char* prog)
+{
+	std::cerr << "Usage: " << prog << " --session <directory> [--repair] [--no_verify] [--threads <n>]\n";
+}
+
+int main(int argc, char* argv[])
+{
+	fs::path sessionDir;
+	bool repair = false;
+	bool verify = true;
+	std::size_t threads = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+
+		if (arg == "--session" && i + 1 < argc)
+		{
+			sessionDir = argv[++i];
+		}
+		else if (arg == "--repair")
+		{
+			// Truncate the journal to its intact records so the session can be appended to again.
+			repair = true;
+		}
+		else if (arg == "--no_verify")
+		{
+			verify = false;
+		}
+		else if (arg == "--threads" && i + 1 < argc)
+		{
+			threads = std::stoi(argv[++i]);
+		}
+		else
+		{
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (sessionDir.empty())
+	{
+		PrintUsage(argv[0]);
+		return 1;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	const fs::path journalPath = sessionDir / "session.journal";
+	std::vector<std::string> directories;
+	std::vector<JournalRecord> records;
+	uint64_t validBytes = 0;
+	if (!ReadSessionJournal(journalPath.string(), directories, records, validBytes))
+	{
+		std::cerr << journalPath << " is missing or not a session journal\n";
+		return 1;
+	}
+	const uint64_t journalBytes = fs::file_size(journalPath);
+	const uint64_t tornBytes = journalBytes - validBytes;
+
+	auto pathOf = [&](const JournalRecord& r) {
+		return directories[r.target] + "/" + std::string(r.name, strnlen(r.name, sizeof(r.name)));
+	};
+
+	// Read every frame file back in parallel; status 0 missing, 1 intact, 2 wrong size, 3 wrong CRC.
+	std::vector<uint8_t> status(records.size(), 1);
+	if (verify)
+	{
+		ThreadPool pool(threads);
+		const std::size_t bands = pool.size() * 8;
+		pool.parallelFor(bands, [&](std::size_t band) {
+			const std::size_t begin = records.size() * band / bands;
+			const std::size_t end = records.size() * (band + 1) / bands;
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				int fd = ::open(pathOf(records[i]).c_str(), O_RDONLY | O_CLOEXEC);
+				uint32_t crc = 0;
+				uint64_t bytes = 0;
+				if (fd < 0 || !FileCrc32(fd, crc, bytes))
+				{
+					status[i] = 0;
+				}
+				else if (bytes != records[i].bytes)
+				{
+					status[i] = 2;
+				}
+				else if (crc != records[i].dataCrc)
+				{
+					status[i] = 3;
+				}
+				if (fd >= 0)
+				{
+					::close(fd);
+				}
+			}
+		});
+	}
+
+	std::vector<std::size_t> order;
+	order.reserve(records.size());
+	std::size_t missing = 0;
+	std::size_t resized = 0;
+	std::size_t corrupt = 0;
+	for (std::size_t i = 0; i < records.size(); ++i)
+	{
+		if (status[i] == 1)
+		{
+			order.push_back(i);
+		}
+		else if (status[i] == 0)
+		{
+			missing++;
+		}
+		else if (status[i] == 2)
+		{
+			resized++;
+		}
+		else
+		{
+			corrupt++;
+		}
+	}
+	std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+		return records[a].frameCounter < records[b].frameCounter;
+	});
+
+	// Frame files that never made it into a commit.
+	std::unordered_set<std::string> journaled;
+	journaled.reserve(records.size());
+	for (const auto& r : records)
+	{
+		journaled.insert(pathOf(r));
+	}
+	std::size_t unjournaled = 0;
+	for (const auto& dir : directories)
+	{
+		std::error_code ec;
+		for (const auto& entry : fs::directory_iterator(dir, ec))
+		{
+			const std::string name = entry.path().filename().string();
+			if (name.rfind("frame_", 0) == 0 && journaled.find(dir + "/" + name) == journaled.end())
+			{
+				unjournaled++;
+			}
+		}
+	}
+
+	const fs::path indexPath = sessionDir / "session_index.csv";
+	const fs::path tmpPath = sessionDir / "session_index.csv.tmp";
+	{
+		std::ofstream index(tmpPath, std::ios::out | std::ios::trunc);
+		index << "sequence,frame,target,path\n";
+		for (std::size_t k = 0; k < order.size(); ++k)
+		{
+			const JournalRecord& r = records[order[k]];
+			index << k << "," << r.frameCounter << "," << r.target << "," << pathOf(r) << "\n";
+		}
+		index.close();
+		if (!index)
+		{
+			std::cerr << "Could not write " << tmpPath << "\n";
+			return 1;
+		}
+	}
+	fs::rename(tmpPath, indexPath);
+
+	if (repair && tornBytes > 0 && ::truncate(journalPath.c_str(), static_cast<off_t>(validBytes)) != 0)
+	{
+		std::cerr << "Could not truncate " << journalPath << "\n";
+		return 1;
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "records," << records.size() << "\n"
+		  << "indexed," << order.size() << "\n"
+		  << "missing," << missing << "\n"
+		  << "size_mismatch," << resized << "\n"
+		  << "crc_mismatch," << corrupt << "\n"
+		  << "unjournaled," << unjournaled << "\n"
+		  << "torn_bytes," << tornBytes << (repair && tornBytes > 0 ? " (truncated)" : "") << "\n"
+		  << "seconds," << seconds << std::endl;
+	return 0;
+}
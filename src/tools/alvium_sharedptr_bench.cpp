@@ -0,0 +1,123 @@
+/*=============================================================================
+  Per-frame reference counting overhead of VmbCPP::shared_ptr.
+
+  A frame pointer is copied and released about five times on its way from
+  the SDK to the worker: FrameHandler::FrameDoneCallback, GetFrame(), the
+  observer argument, FrameQueue::push and FrameQueue::pop. This benchmark
+  replays that pattern with the mutex-based counter VmbCPP used before
+  (reproduced here with a pthread mutex, which is what VmbCPP::Mutex wraps),
+  the current atomic VmbCPP::shared_ptr and std::shared_ptr, once on a single
+  thread and once with the callback and worker threads sharing the pointer.
+  Built with -DALVIUM_BUILD_BENCHMARKS=ON.
+=============================================================================*/
+
+#include <VmbCPP/SharedPointer.h>
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Copies and releases of a frame pointer per delivered frame.
+static const int kCopiesPerFrame = 5;
+
+struct FakeFrame
+{
+	unsigned char* buffer = nullptr;
+	long long size = 0;
+};
+
+// The counter VmbCPP::shared_ptr used before: a long guarded by a mutex on every inc() and dec().
+template <class T>
+class LegacyPtr
+{
+public:
+	explicit LegacyPtr(T* object) : m_count(new Count{object, 1, {}}) {}
+	LegacyPtr(const LegacyPtr& other) : m_count(other.m_count)
+	{
+		std::lock_guard<std::mutex> lock(m_count->mutex);
+		m_count->count++;
+	}
+	~LegacyPtr()
+	{
+		m_count->mutex.lock();
+		if (--m_count->count == 0)
+		{
+			m_count->mutex.unlock();
+			delete m_count->object;
+			delete m_count;
+			return;
+		}
+		m_count->mutex.unlock();
+	}
+	LegacyPtr& operator=(const LegacyPtr&) = delete;
+
+private:
+	struct Count
+	{
+		T* object;
+		long count;
+		std::mutex mutex;
+	};
+	Count* m_count;
+};
+
+// Touch the copy so the compiler cannot drop it.
+template <class Ptr>
+static void __attribute__((noinline)) Deliver(Ptr frame)
+{
+	asm volatile("" : : "r"(&frame) : "memory");
+}
+
+template <class Ptr>
+static double FrameCost(const Ptr& frame, uint64_t frames, int threads)
+{
+	std::atomic<bool> go{false};
+	auto run = [&] {
+		while (!go.load()) {}
+		for (uint64_t i = 0; i < frames; ++i)
+		{
+			for (int k = 0; k < kCopiesPerFrame; ++k)
+			{
+				Deliver<Ptr>(frame);
+			}
+		}
+	};
+
+	std::thread workers[2];
+	for (int t = 1; t < threads; ++t)
+	{
+		workers[t] = std::thread(run);
+	}
+	auto start = std::chrono::steady_clock::now();
+	go = true;
+	run();
+	for (int t = 1; t < threads; ++t)
+	{
+		workers[t].join();
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return seconds / frames * 1e9;
+}
+
+int main(int argc, char* argv[])
+{
+	uint64_t frames = argc > 1 ? std::stoull(argv[1]) : 2000000;
+
+	LegacyPtr<FakeFrame> legacy(new FakeFrame);
+	VmbCPP::shared_ptr<FakeFrame> atomic = VmbCPP::make_shared<FakeFrame>();
+	std::shared_ptr<FakeFrame> standard = std::make_shared<FakeFrame>();
+
+	std::cout << "counter,threads,ns_per_frame\n" << std::fixed << std::setprecision(1);
+	for (int threads = 1; threads <= 2; ++threads)
+	{
+		std::cout << "mutex (before)," << threads << "," << FrameCost(legacy, frames, threads) << "\n";
+		std::cout << "VmbCPP atomic," << threads << "," << FrameCost(atomic, frames, threads) << "\n";
+		std::cout << "std::shared_ptr," << threads << "," << FrameCost(standard, frames, threads) << "\n";
+	}
+	return 0;
+}
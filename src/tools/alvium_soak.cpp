@@ -0,0 +1,227 @@
+/*=============================================================================
+  Long-run write soak benchmark.
+
+  Writes synthetic raw frames at a fixed frame rate for a given duration, the
+  way the driver's raw writer does, either through std::ofstream (kernel
+  writeback) or through WriteBehind with a dirty-byte budget. Every interval
+  it prints one CSV line with the write latency percentiles, the frames that
+  took longer than a frame period and the system-wide Dirty/Writeback figures
+  from /proc/meminfo, so that writeback stalls show up as latency spikes
+  minutes into the run. Built with -DALVIUM_BUILD_BENCHMARKS=ON.
+=============================================================================*/
+
+#include "WriteBehind.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static void PrintUsage(const char* prog)
+{
+	std::cerr << "Usage: " << prog
+		  << " --output <directory> [--frame_mb <12.4>] [--fps <30>] [--minutes <10>] [--interval <10>]"
+		  << " [--writer <ofstream/writebehind>] [--dirty_mb <64>] [--files <N>]\n";
+}
+
+// Value in kB of a /proc/meminfo field, or -1.
+static long MemInfoKB(const std::string& field)
+{
+	std::ifstream in("/proc/meminfo");
+	std::string name;
+	long value;
+	std::string unit;
+	while (in >> name >> value >> unit)
+	{
+		if (name == field + ":")
+		{
+			return value;
+		}
+	}
+	return -1;
+}
+
+static double Percentile(std::vector<double>& v, double p)
+{
+	if (v.empty())
+	{
+		return 0.0;
+	}
+	std::size_t k = std::min(v.size() - 1, static_cast<std::size_t>(p * (v.size() - 1) + 0.5));
+	std::nth_element(v.begin(), v.begin() + k, v.end());
+	return v[k];
+}
+
+int main(int argc, char* argv[])
+{
+	fs::path outputDir;
+	double frameMB = 12.4;
+	double fps = 30.0;
+	double minutes = 10.0;
+	double interval = 10.0;
+	std::string writer = "writebehind";
+	std::size_t dirtyMB = 64;
+	std::size_t files = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+
+		if (arg == "--output" && i + 1 < argc)
+		{
+			outputDir = argv[++i];
+		}
+		else if (arg == "--frame_mb" && i + 1 < argc)
+		{
+			frameMB = std::stod(argv[++i]);
+		}
+		else if (arg == "--fps" && i + 1 < argc)
+		{
+			fps = std::stod(argv[++i]);
+		}
+		else if (arg == "--minutes" && i + 1 < argc)
+		{
+			minutes = std::stod(argv[++i]);
+		}
+		else if (arg == "--interval" && i + 1 < argc)
+		{
+			interval = std::stod(argv[++i]);
+		}
+		else if (arg == "--writer" && i + 1 < argc)
+		{
+			writer = argv[++i];
+		}
+		else if (arg == "--dirty_mb" && i + 1 < argc)
+		{
+			dirtyMB = std::stoul(argv[++i]);
+		}
+		else if (arg == "--files" && i + 1 < argc)
+		{
+			// Reuse N file names so that long runs do not fill the disk.
+			files = std::stoul(argv[++i]);
+		}
+		else
+		{
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (outputDir.empty() || !fs::is_directory(outputDir) || fps <= 0.0 || frameMB <= 0.0
+	    || (writer != "ofstream" && writer != "writebehind"))
+	{
+		PrintUsage(argv[0]);
+		return 1;
+	}
+
+	std::vector<uint8_t> frame(static_cast<std::size_t>(frameMB * 1e6));
+	for (std::size_t i = 0; i < frame.size(); ++i)
+	{
+		frame[i] = static_cast<uint8_t>(i * 2654435761u >> 24);
+	}
+
+	std::unique_ptr<WriteBehind> writeBehind;
+	if (writer == "writebehind")
+	{
+		writeBehind = std::make_unique<WriteBehind>(dirtyMB << 20);
+	}
+
+	using Clock = std::chrono::steady_clock;
+	const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+	const auto start = Clock::now();
+	const auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(minutes * 60.0));
+	auto next = start;
+	auto report = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(interval));
+
+	std::vector<double> latencies;
+	uint64_t frameCounter = 0;
+	uint64_t late = 0;
+
+	std::cout << "seconds,frames,p50_ms,p99_ms,max_ms,late,dirty_mb,writeback_mb\n";
+	std::cout << std::fixed << std::setprecision(2);
+
+	while (Clock::now() < end)
+	{
+		std::this_thread::sleep_until(next);
+		next += period;
+
+		std::ostringstream name;
+		name << "frame_" << std::setw(6) << std::setfill('0') << (files > 0 ? frameCounter % files : frameCounter) << ".raw";
+		const std::string path = (outputDir / name.str()).string();
+
+		auto t0 = Clock::now();
+		if (writeBehind)
+		{
+			if (!writeBehind->write(path, frame.data(), frame.size(), frameCounter))
+			{
+				std::cerr << writeBehind->error() << "\n";
+				return 1;
+			}
+			for (const auto& failure : writeBehind->failures())
+			{
+				std::cerr << "frame " << failure.id << ": " << failure.message << "\n";
+				return 1;
+			}
+		}
+		else
+		{
+			std::ofstream out(path, std::ios::out | std::ios::binary);
+			out.write(reinterpret_cast<const char*>(frame.data()), frame.size());
+			out.close();
+			if (!out)
+			{
+				std::cerr << "Could not write " << path << "\n";
+				return 1;
+			}
+		}
+		auto t1 = Clock::now();
+		frameCounter++;
+
+		latencies.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+		if (t1 - t0 > period)
+		{
+			late++;
+		}
+		// A writer that falls behind does not get to catch up with a burst.
+		if (t1 > next)
+		{
+			next = t1;
+		}
+
+		if (t1 >= report || Clock::now() >= end)
+		{
+			const double maxMs = *std::max_element(latencies.begin(), latencies.end());
+			std::cout << std::chrono::duration<double>(t1 - start).count() << ","
+				  << latencies.size() << ","
+				  << Percentile(latencies, 0.50) << ","
+				  << Percentile(latencies, 0.99) << ","
+				  << maxMs << ","
+				  << late << ","
+				  << MemInfoKB("Dirty") / 1024.0 << ","
+				  << MemInfoKB("Writeback") / 1024.0 << std::endl;
+			latencies.clear();
+			late = 0;
+			report += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(interval));
+		}
+	}
+
+	if (writeBehind && !writeBehind->drain())
+	{
+		for (const auto& failure : writeBehind->failures())
+		{
+			std::cerr << "frame " << failure.id << ": " << failure.message << "\n";
+		}
+		return 1;
+	}
+	return 0;
+}
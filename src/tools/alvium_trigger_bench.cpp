@@ -0,0 +1,151 @@
+/*=============================================================================
+  Per-trigger feature access latency.
+
+  Opens a camera, puts it in software trigger mode the way the driver does,
+  and times the host side of TriggerSoftware and of an ExposureTime read
+  through three paths: a GetFeatureByName lookup on every call (what
+  Driver::TriggerFrame used to do), a FeaturePtr looked up once, and the
+  driver's FeatureTable. Prints one CSV line per path with the mean, p50,
+  p99 and max call time in microseconds. No frames are captured. Built with
+  -DALVIUM_BUILD_BENCHMARKS=ON.
+=============================================================================*/
+
+#include "FeatureTable.h"
+
+#include <VmbCPP/VmbCPP.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace VmbCPP;
+using namespace VmbCPP::Examples;
+
+static void PrintUsage(const char* prog)
+{
+	std::cerr << "Usage: " << prog << " [--camera <id>] [--iterations <2000>]\n";
+}
+
+static double Percentile(std::vector<double>& v, double p)
+{
+	std::size_t k = std::min(v.size() - 1, static_cast<std::size_t>(p * (v.size() - 1) + 0.5));
+	std::nth_element(v.begin(), v.begin() + k, v.end());
+	return v[k];
+}
+
+// Time iterations calls of call; returns false on the first failing call.
+static bool Measure(const std::string& label, int iterations, const std::function<VmbErrorType()>& call)
+{
+	std::vector<double> us;
+	us.reserve(iterations);
+	for (int i = 0; i < iterations; ++i)
+	{
+		auto t0 = std::chrono::steady_clock::now();
+		VmbErrorType err = call();
+		auto t1 = std::chrono::steady_clock::now();
+		if (err != VmbErrorSuccess)
+		{
+			std::cerr << label << " failed, err=" << err << "\n";
+			return false;
+		}
+		us.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+	}
+	double mean = 0.0;
+	for (double v : us)
+	{
+		mean += v;
+	}
+	mean /= us.size();
+	const double maxUs = *std::max_element(us.begin(), us.end());
+	std::cout << label << "," << mean << "," << Percentile(us, 0.50) << "," << Percentile(us, 0.99) << "," << maxUs << std::endl;
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	std::string cameraId;
+	int iterations = 2000;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+
+		if (arg == "--camera" && i + 1 < argc)
+		{
+			cameraId = argv[++i];
+		}
+		else if (arg == "--iterations" && i + 1 < argc)
+		{
+			iterations = std::max(1, std::stoi(argv[++i]));
+		}
+		else
+		{
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	VmbSystem& system = VmbSystem::GetInstance();
+	if (system.Startup() != VmbErrorSuccess)
+	{
+		std::cerr << "Could not start API\n";
+		return 1;
+	}
+
+	CameraPtr camera;
+	CameraPtrVector cameras;
+	if (!cameraId.empty())
+	{
+		system.GetCameraByID(cameraId.c_str(), camera);
+	}
+	else if (system.GetCameras(cameras) == VmbErrorSuccess && !cameras.empty())
+	{
+		camera = cameras[0];
+	}
+	if (!camera || camera->Open(VmbAccessModeFull) != VmbErrorSuccess)
+	{
+		std::cerr << "Could not open camera\n";
+		system.Shutdown();
+		return 1;
+	}
+
+	FeatureTable table;
+	table.Resolve(camera);
+	table.SetBool(HotFeature::AcquisitionFrameRateEnable, false);
+	table.SetEnum(HotFeature::TriggerSelector, "FrameStart");
+	table.SetEnum(HotFeature::TriggerMode, "On");
+	table.SetEnum(HotFeature::TriggerSource, "Software");
+
+	FeaturePtr trigger;
+	FeaturePtr exposure;
+	camera->GetFeatureByName("TriggerSoftware", trigger);
+	camera->GetFeatureByName("ExposureTime", exposure);
+
+	std::cout << "path,mean_us,p50_us,p99_us,max_us\n" << std::fixed << std::setprecision(2);
+	bool ok = true;
+	ok = ok && Measure("trigger_lookup", iterations, [&] {
+		FeaturePtr feature;
+		VmbErrorType err = camera->GetFeatureByName("TriggerSoftware", feature);
+		return err == VmbErrorSuccess ? feature->RunCommand() : err;
+	});
+	ok = ok && Measure("trigger_featureptr", iterations, [&] { return trigger->RunCommand(); });
+	ok = ok && Measure("trigger_table", iterations, [&] { return table.RunCommand(HotFeature::TriggerSoftware); });
+
+	double value = 0.0;
+	ok = ok && Measure("exposure_lookup", iterations, [&] {
+		FeaturePtr feature;
+		VmbErrorType err = camera->GetFeatureByName("ExposureTime", feature);
+		return err == VmbErrorSuccess ? feature->GetValue(value) : err;
+	});
+	ok = ok && Measure("exposure_featureptr", iterations, [&] { return exposure->GetValue(value); });
+	ok = ok && Measure("exposure_table", iterations, [&] { return table.GetFloat(HotFeature::ExposureTime, value); });
+
+	table.SetEnum(HotFeature::TriggerMode, "Off");
+	camera->Close();
+	system.Shutdown();
+	return ok ? 0 : 1;
+}
@@ -5,8 +5,13 @@ import argparse
 from vmbpy import vmbsystem
 from vmbpy.c_binding.vmb_image_transform import VmbImage, VmbImageInfo, VmbPixelInfo, VmbPixelFormat, VmbTransformInfo, VmbTransformType, call_vmb_image_transform
 import ctypes
+import shutil
+import subprocess
 from tqdm import tqdm
 
+from frame_metadata import read_frame_metadata
+from rawformat import read_raw, stored_format, to_bgr8
+
 def calibration_parameters(image_folder, args, show_corners=False):
     '''
     Calibrate camera from a folder of images.
@@ -86,16 +91,130 @@ def calibration_parameters(image_folder, args, show_corners=False):
     return camera_matrix, dist_coeffs, rms_error
 
 
-def process_raw_opencv(file_path, width=4128, height=3008): 
-    rgb_img = np.fromfile(file_path, dtype=np.uint8).reshape((height, width, 3))
+def find_focus_tool():
+    '''
+    Locate the native alvium_focus binary: $ALVIUM_FOCUS, the default build directory, then PATH.
+    '''
+    candidates = [
+        os.environ.get("ALVIUM_FOCUS"),
+        os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "build", "alvium_focus"),
+        shutil.which("alvium_focus"),
+    ]
+    for candidate in candidates:
+        if candidate and os.path.isfile(candidate) and os.access(candidate, os.X_OK):
+            return candidate
+    return None
+
+
+def best_focus(image_folder, metric="laplacian", roi=None):
+    '''
+    Find the sharpest frame of a focus sweep.
+
+    Args:
+        image_folder (str): folder with .png or .raw frames
+        metric (str): "laplacian" (variance of Laplacian), "tenengrad" or "nge" (normalized gradient energy)
+        roi (tuple): optional (width, height, offsetX, offsetY) region to score
+
+    Returns:
+        best_path (str): path of the frame with the highest score
+        focus_scores (dict): file name -> {metric name: score} for every frame
+    '''
+    tool = find_focus_tool()
+    focus_scores = {}
+
+    if tool:
+        cmd = [tool, "--input", image_folder, "--metric", metric]
+        if roi:
+            cmd += ["--roi", ",".join(str(v) for v in roi)]
+        result = subprocess.run(cmd, capture_output=True, text=True, check=True)
+
+        best_path = None
+        lines = result.stdout.strip().splitlines()
+        header = lines[0].split(",")
+        for line in lines[1:]:
+            fields = line.split(",")
+            if fields[0] == "best":
+                best_path = fields[1]
+                continue
+            focus_scores[fields[0]] = {name: float(v) for name, v in zip(header[1:], fields[1:])}
+    else:
+        # Fallback when the native tool has not been built: variance of Laplacian only.
+        print("alvium_focus not found, falling back to the (slower) OpenCV Laplacian.")
+        best_path, best_score = None, -1.0
+        for filename in tqdm(sorted(os.listdir(image_folder))):
+            if not filename.lower().endswith(".png"):
+                continue
+            filepath = os.path.join(image_folder, filename)
+            gray = cv2.imread(filepath, cv2.IMREAD_GRAYSCALE)
+            if gray is None:
+                continue
+            if roi:
+                w, h, x, y = roi
+                gray = gray[y:y + h, x:x + w]
+            score = cv2.Laplacian(gray, cv2.CV_64F, ksize=1).var()
+            focus_scores[filename] = {"laplacian": score}
+            if score > best_score:
+                best_path, best_score = filepath, score
+
+    if best_path is None:
+        raise RuntimeError(f"No frames could be scored in {image_folder}")
+
+    print(f"Best focus ({metric}): {best_path}")
+    return best_path, focus_scores
+
+
+def load_frame_stats(folder):
+    '''
+    Load the per-frame statistics the driver records with --stats, from frames.meta (or frame_stats.csv for
+    older sessions).
+
+    Returns:
+        stats (dict): frame name (e.g. "frame_000001") -> {column: value}, empty if no statistics were recorded
+    '''
+    stats = {}
+    meta_path = os.path.join(folder, "frames.meta")
+    if os.path.exists(meta_path):
+        records, _ = read_frame_metadata(meta_path)
+        if "has_stats" in records.dtype.names:
+            columns = ["mean", "p1", "p50", "p99", "saturated_pct", "black_pct", "sharpness", "compute_us"]
+            for record in records[records["has_stats"] != 0]:
+                stats[f"frame_{int(record['frame']):06d}"] = {name: float(record[name]) for name in columns}
+            return stats
+
+    stats_path = os.path.join(folder, "frame_stats.csv")
+    if not os.path.exists(stats_path):
+        return stats
+
+    with open(stats_path, "r") as f:
+        header = f.readline().strip().split(",")
+        for line in f:
+            fields = line.strip().split(",")
+            if len(fields) != len(header):
+                continue
+            stats[fields[0]] = {name: float(v) for name, v in zip(header[1:], fields[1:])}
+    return stats
+
+
+def rejected_by_stats(frame_stats, args):
+    '''
+    True if the recorded statistics show the frame is over-exposed or too blurry to be used.
+    '''
+    if frame_stats is None:
+        return False
+    if args.max_saturated is not None and frame_stats["saturated_pct"] > args.max_saturated:
+        return True
+    if args.min_sharpness is not None and frame_stats["sharpness"] < args.min_sharpness:
+        return True
+    return False
 
-    bgr_img = cv2.cvtColor(rgb_img, cv2.COLOR_RGB2BGR)
+
+def process_raw_opencv(file_path, width=4128, height=3008, pixel_format="RGB8"):
+    bgr_img = to_bgr8(read_raw(file_path, width, height, pixel_format), pixel_format)
 
     return bgr_img
 
-def process_grayscale(file_path, width=4128, height=3008):
-    img = np.fromfile(file_path, dtype=np.uint8).reshape((height, width, 3))
-    gray_img = cv2.cvtColor(img, cv2.COLOR_RGB2GRAY)
+def process_grayscale(file_path, width=4128, height=3008, pixel_format="RGB8"):
+    gray_img = cv2.cvtColor(process_raw_opencv(file_path, width, height, pixel_format), cv2.COLOR_BGR2GRAY)
 
     return gray_img
 
@@ -139,11 +258,15 @@ def main():
             description="Convert raw Bayer images to color PNGs and run camera calibration."
     )
     parser.add_argument("--input_folder", type=str, help="Path to folder with .raw images")
-    parser.add_argument("--width", type=int, default=4128, help="Image width in pixels")
-    parser.add_argument("--height", type=int, default=3008, help="Image height in pixels")
+    parser.add_argument("--width", type=int, default=None, help="Image width in pixels (default: from alvium_log.txt, else 4128)")
+    parser.add_argument("--height", type=int, default=None, help="Image height in pixels (default: from alvium_log.txt, else 3008)")
+    parser.add_argument("--pixel_format", type=str, default=None, help="Storage format of the .raw frames, e.g. RGB8 or Mono12p (default: from alvium_log.txt, else RGB8)")
     parser.add_argument("--pattern_size", type=int, default=(10, 7), nargs="+", help="How many internal squares are in the checkerboard [horizontal] [vertical]")
     parser.add_argument("--square_size", type=float, default=0.02176, help="Square size in metres.")
     parser.add_argument("--mode", type=str, default="processing", help="calib to determine calibration parameters, focus to determine best focus based on a series of images.")
+    parser.add_argument("--focus_metric", type=str, default="laplacian", help="Focus metric for focus mode: laplacian, tenengrad or nge.")
+    parser.add_argument("--max_saturated", type=float, default=None, help="Skip frames with more than this percentage of saturated pixels (needs a session recorded with --stats).")
+    parser.add_argument("--min_sharpness", type=float, default=None, help="Skip frames with a lower sharpness proxy than this (needs a session recorded with --stats).")
     parser.add_argument("--preprocessing", type=bool, default=False, help="denoising, equalization, and upsampling the checkerboard.")
 
     args = parser.parse_args()
@@ -165,24 +288,33 @@ def main():
 
     output_folder = input_folder + "/processed_images"
     mode = args.mode
-    width = args.width
-    height = args.height
+    pixel_format, width, height = stored_format(input_folder) or ("RGB8", 4128, 3008)
+    pixel_format = args.pixel_format or pixel_format
+    width = args.width or width
+    height = args.height or height
 
     if not os.path.exists(output_folder):
         os.makedirs(output_folder)
 
+    frame_stats = load_frame_stats(input_folder)
+    rejected = 0
+
     print(f"Processing .raw images and saving .pngs to {output_folder}")
     for filename in tqdm(sorted(os.listdir(input_folder))):
         if not filename.lower().endswith(".raw"):
             continue
 
+        if rejected_by_stats(frame_stats.get(os.path.splitext(filename)[0]), args):
+            rejected += 1
+            continue
+
         output_file = os.path.join(output_folder, os.path.splitext(filename)[0] + ".png")
 
         if not os.path.exists(output_file):
             filepath = os.path.join(input_folder, filename)
 
             try:
-                processed_color = process_raw_opencv(filepath, width, height)
+                processed_color = process_raw_opencv(filepath, width, height, pixel_format)
 
 
             except Exception as e:
@@ -193,11 +325,14 @@ def main():
             outpath = os.path.join(output_folder, os.path.splitext(filename)[0] + ".png")
             cv2.imwrite(outpath, processed_color)
 
+    if rejected:
+        print(f"Rejected {rejected} frames based on their recorded statistics")
+
     if mode == "calib":
         print("Images processed")
         camera_matrix, dist_coeffs, rms_error = calibration_parameters(output_folder, args)
     elif mode == "focus":
-        best_focus_path, focus_scores = best_focus(output_folder)
+        best_focus_path, focus_scores = best_focus(output_folder, args.focus_metric)
             
 
 if __name__ == "__main__":
@@ -0,0 +1,83 @@
+import argparse
+import os
+import struct
+
+import numpy as np
+
+# Layout of frames.meta (see include/FrameRecordStore.h).
+HEADER_BYTES = 32
+RECORD_V1 = np.dtype([
+    ("frame", "<u8"), ("frame_id", "<u8"), ("device_timestamp", "<u8"), ("host_timestamp_ns", "<i8"),
+    ("exposure_us", "<f4"), ("gain_db", "<f4"), ("write_latency_us", "<u4"),
+    ("status", "<u2"), ("queue_depth", "<u2"),
+])
+# Current layout: RECORD_V1 plus the --stats quality statistics, zero unless has_stats is set.
+RECORD = np.dtype(RECORD_V1.descr + [
+    ("mean", "<f4"), ("saturated_pct", "<f4"), ("black_pct", "<f4"), ("sharpness", "<f4"), ("compute_us", "<u4"),
+    ("p1", "u1"), ("p50", "u1"), ("p99", "u1"), ("has_stats", "u1"),
+])
+STATUS = {0: "not_written", 1: "written", 2: "write_failed", 3: "handed"}
+
+
+def read_frame_metadata(path):
+    '''
+    Load frames.meta written by the driver.
+
+    Args:
+        path (str): frames.meta, or the session directory holding it
+
+    Returns:
+        records (np.ndarray): structured array with one row per frame (fields as RECORD, or RECORD_V1 for
+            sessions recorded before the statistics were added)
+        tick_frequency (int): device timestamp ticks per second
+    '''
+    if os.path.isdir(path):
+        path = os.path.join(path, "frames.meta")
+    with open(path, "rb") as f:
+        header = f.read(HEADER_BYTES)
+        if header[:8] != b"ALVMETA1":
+            raise ValueError(f"{path} is not a frame metadata file")
+        record_size, = struct.unpack_from("<I", header, 8)
+        layouts = {RECORD.itemsize: RECORD, RECORD_V1.itemsize: RECORD_V1}
+        if record_size not in layouts:
+            raise ValueError(f"{path} has {record_size} byte records, expected {RECORD.itemsize}")
+        record = layouts[record_size]
+        tick_frequency, = struct.unpack_from("<Q", header, 16)
+        # A session that was cut short may end in a partial record.
+        data = f.read()
+    count = len(data) // record.itemsize
+    return np.frombuffer(data, dtype=record, count=count), tick_frequency
+
+
+def export_csv(records, path):
+    fmt = ["%.3f" if records.dtype[n].kind == "f" else "%d" for n in records.dtype.names]
+    np.savetxt(path, records, fmt=fmt, delimiter=",", header=",".join(records.dtype.names), comments="")
+
+
+def export_arrow(records, path):
+    import pyarrow as pa
+    import pyarrow.feather as feather
+    table = pa.table({n: records[n] for n in records.dtype.names})
+    feather.write_feather(table, path)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Export frames.meta to CSV or Arrow (Feather).")
+    parser.add_argument("session", help="session directory or frames.meta")
+    parser.add_argument("--csv", help="write a CSV file")
+    parser.add_argument("--arrow", help="write an Arrow/Feather file (needs pyarrow)")
+    args = parser.parse_args()
+
+    records, tick_frequency = read_frame_metadata(args.session)
+    if args.csv:
+        export_csv(records, args.csv)
+    if args.arrow:
+        export_arrow(records, args.arrow)
+
+    counts = {STATUS.get(s, s): int(n) for s, n in zip(*np.unique(records["status"], return_counts=True))}
+    print(f"{len(records)} frames, {counts}")
+    if len(records) > 1:
+        period = np.diff(records["device_timestamp"].astype(np.int64)) / tick_frequency
+        print(f"device period {period.mean() * 1e3:.3f} ms (std {period.std() * 1e3:.3f} ms), "
+              f"max queue depth {records['queue_depth'].max()}, "
+              f"max write latency {records['write_latency_us'].max() / 1e3:.1f} ms")
@@ -4,15 +4,15 @@ import numpy as np
 import argparse
 from tqdm import tqdm
 
+from rawformat import read_raw, stored_format, to_bgr8
 
-def cropping(image, size):
+
+def cropping(image, size, width=4128, height=3008, pixel_format="RGB8"):
     '''
     This function crops the image to a smaller size, such that the photogrammetry target takes up a larger portion of the total image.
     '''
 
-    rgb_img = np.fromfile(image, dtype=np.uint8).reshape((3008, 4128, 3))
-
-    img = cv2.cvtColor(rgb_img, cv2.COLOR_RGB2BGR)
+    img = to_bgr8(read_raw(image, width, height, pixel_format), pixel_format)
     
 
     h, w = img.shape[:2]
@@ -59,6 +59,8 @@ if __name__ == "__main__":
    if not os.path.exists(output_folder):
        os.makedirs(output_folder)
 
+   pixel_format, width, height = stored_format(input_folder) or ("RGB8", 4128, 3008)
+
    print(f"Cropping .raw images and saving .pngs to {output_folder}")
    for filename in tqdm(sorted(os.listdir(input_folder))):
        if not filename.lower().endswith(".raw"):
@@ -67,7 +69,7 @@ if __name__ == "__main__":
        filepath = os.path.join(input_folder, filename)
 
        try:
-           cropped = cropping(filepath, size)
+           cropped = cropping(filepath, size, width, height, pixel_format)
                
        except Exception as e:
            print(f"Error cropping {filename}: {e}")
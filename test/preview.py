@@ -0,0 +1,75 @@
+import mmap
+import os
+import struct
+import time
+import argparse
+
+import cv2
+import numpy as np
+
+HEADER_BYTES = 64
+SLOT_HEADER_BYTES = 64
+DATA_OFFSET = HEADER_BYTES + 3 * SLOT_HEADER_BYTES
+
+
+def read_latest(shm, slot_bytes):
+    '''
+    Copy the newest preview frame out of the driver's shared-memory triple buffer.
+
+    Returns:
+        frame_id (int): driver frame counter of the preview, or None if nothing consistent could be read
+        image (np.ndarray): height x width x channels uint8 image (RGB order)
+    '''
+    published = struct.unpack_from("<Q", shm, 16)[0]
+    if published == 0:
+        return None, None
+
+    slot = (published - 1) % 3
+    slot_offset = HEADER_BYTES + slot * SLOT_HEADER_BYTES
+
+    # Sequence lock: odd while the driver writes the slot, changed if it was rewritten during the copy.
+    for _ in range(3):
+        seq_before = struct.unpack_from("<Q", shm, slot_offset)[0]
+        if seq_before & 1:
+            continue
+        width, height, channels, _, frame_id = struct.unpack_from("<IIIIQ", shm, slot_offset + 8)
+        size = width * height * channels
+        start = DATA_OFFSET + slot * slot_bytes
+        data = bytes(shm[start:start + size])
+        seq_after = struct.unpack_from("<Q", shm, slot_offset)[0]
+        if seq_before == seq_after:
+            return frame_id, np.frombuffer(data, dtype=np.uint8).reshape((height, width, channels))
+    return None, None
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Show the live preview published by the driver with --preview.")
+    parser.add_argument("--name", type=str, default="/dev/shm/alvium_preview", help="Shared memory file of the preview")
+    parser.add_argument("--interval", type=float, default=0.05, help="Polling interval in seconds")
+    args = parser.parse_args()
+
+    fd = os.open(args.name, os.O_RDONLY)
+    shm = mmap.mmap(fd, 0, mmap.MAP_SHARED, mmap.PROT_READ)
+    os.close(fd)
+
+    if shm[:8] != b"ALVPREV1":
+        raise RuntimeError(f"{args.name} is not an Alvium preview buffer")
+    slot_bytes = struct.unpack_from("<I", shm, 12)[0]
+
+    last_id = None
+    while True:
+        frame_id, image = read_latest(shm, slot_bytes)
+        if image is not None and frame_id != last_id:
+            last_id = frame_id
+            if image.shape[2] == 3:
+                image = cv2.cvtColor(image, cv2.COLOR_RGB2BGR)
+            cv2.imshow("Alvium preview", image)
+            cv2.setWindowTitle("Alvium preview", f"Alvium preview - frame {frame_id}")
+        if cv2.waitKey(max(1, int(args.interval * 1000))) & 0xFF in (ord("q"), 27):
+            break
+
+    cv2.destroyAllWindows()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,203 @@
+import os
+import re
+import struct
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+
+# Samples per pixel and storage of the formats the driver writes to .raw files
+# (see the "Raw frames stored as ..." line in alvium_log.txt).
+FORMATS = {
+    "Mono8": (1, "u8"), "BayerRG8": (1, "u8"), "BayerBG8": (1, "u8"), "BayerGR8": (1, "u8"), "BayerGB8": (1, "u8"),
+    "RGB8": (3, "u8"), "BGR8": (3, "u8"),
+    "Mono10p": (1, "10p"), "BayerRG10p": (1, "10p"), "BayerBG10p": (1, "10p"), "BayerGR10p": (1, "10p"), "BayerGB10p": (1, "10p"),
+    "RGB10p": (3, "10p"), "BGR10p": (3, "10p"),
+    "Mono12p": (1, "12p"), "BayerRG12p": (1, "12p"), "BayerBG12p": (1, "12p"), "BayerGR12p": (1, "12p"), "BayerGB12p": (1, "12p"),
+    "RGB12p": (3, "12p"), "BGR12p": (3, "12p"),
+    "Mono12Packed": (1, "12packed"), "BayerRG12Packed": (1, "12packed"), "BayerBG12Packed": (1, "12packed"),
+    "BayerGR12Packed": (1, "12packed"), "BayerGB12Packed": (1, "12packed"),
+    "Mono14": (1, "u16"), "Mono16": (1, "u16"),
+    "BayerRG16": (1, "u16"), "BayerBG16": (1, "u16"), "BayerGR16": (1, "u16"), "BayerGB16": (1, "u16"),
+    "RGB14": (3, "u16"), "BGR14": (3, "u16"), "RGB16": (3, "u16"), "BGR16": (3, "u16"),
+}
+
+
+def unpack_10p(data, count):
+    '''
+    Unpack PFNC 10p data (four 10-bit samples in 5 bytes, LSB first) into uint16.
+    '''
+    groups = np.frombuffer(data, dtype=np.uint8)[:(count // 4) * 5].reshape(-1, 5).astype(np.uint16)
+    out = np.empty((groups.shape[0], 4), dtype=np.uint16)
+    out[:, 0] = groups[:, 0] | ((groups[:, 1] & 0x03) << 8)
+    out[:, 1] = (groups[:, 1] >> 2) | ((groups[:, 2] & 0x0F) << 6)
+    out[:, 2] = (groups[:, 2] >> 4) | ((groups[:, 3] & 0x3F) << 4)
+    out[:, 3] = (groups[:, 3] >> 6) | (groups[:, 4] << 2)
+    return out.reshape(-1)
+
+
+def unpack_12p(data, count):
+    '''
+    Unpack PFNC 12p data (two 12-bit samples in 3 bytes, LSB first) into uint16.
+    '''
+    groups = np.frombuffer(data, dtype=np.uint8)[:(count // 2) * 3].reshape(-1, 3).astype(np.uint16)
+    out = np.empty((groups.shape[0], 2), dtype=np.uint16)
+    out[:, 0] = groups[:, 0] | ((groups[:, 1] & 0x0F) << 8)
+    out[:, 1] = (groups[:, 1] >> 4) | (groups[:, 2] << 4)
+    return out.reshape(-1)
+
+
+def unpack_12packed(data, count):
+    '''
+    Unpack GigE Vision 12Packed data (two 12-bit samples in 3 bytes: high bits of each sample in bytes 0 and 2,
+    their low nibbles in byte 1) into uint16.
+    '''
+    groups = np.frombuffer(data, dtype=np.uint8)[:(count // 2) * 3].reshape(-1, 3).astype(np.uint16)
+    out = np.empty((groups.shape[0], 2), dtype=np.uint16)
+    out[:, 0] = (groups[:, 0] << 4) | (groups[:, 1] & 0x0F)
+    out[:, 1] = (groups[:, 2] << 4) | (groups[:, 1] >> 4)
+    return out.reshape(-1)
+
+
+def read_raw(file_path, width, height, pixel_format="RGB8"):
+    '''
+    Load a .raw frame written by the driver.
+
+    Args:
+        file_path (str): path of the .raw file
+        width (int), height (int): frame size
+        pixel_format (str): storage format from the log, e.g. "RGB8" or "Mono12p"
+
+    Returns:
+        image (np.ndarray): height x width (x 3) array, uint8 for 8-bit formats, uint16 otherwise
+    '''
+    with open(file_path, "rb") as f:
+        data = f.read()
+    return decode(data, width, height, pixel_format)
+
+
+def stored_format(folder):
+    '''
+    Storage format and size of the .raw frames in a session folder, from the "Raw frames stored as ..." line the
+    driver writes to alvium_log.txt.
+
+    Returns:
+        (pixel_format, width, height), or None if the folder has no such log line
+    '''
+    found = None
+    log_path = os.path.join(folder, "alvium_log.txt")
+    if os.path.isfile(log_path):
+        with open(log_path, errors="replace") as f:
+            for line in f:
+                match = re.search(r"Raw frames stored as (\w+) (\d+)x(\d+)", line)
+                if match:
+                    found = (match.group(1), int(match.group(2)), int(match.group(3)))
+    return found
+
+
+def to_bgr8(image, pixel_format):
+    '''
+    Convert a frame from read_raw into an 8-bit BGR image for OpenCV: deeper samples keep their top 8 bits and
+    Bayer mosaics are demosaiced.
+    '''
+    import cv2
+    bits = int(re.search(r"(\d+)(p|Packed)?$", pixel_format).group(1))
+    if bits > 8:
+        image = (image >> (bits - 8)).astype(np.uint8)
+    if pixel_format.startswith("Bayer"):
+        pattern = {"RG": "RGGB", "BG": "BGGR", "GR": "GRBG", "GB": "GBRG"}[pixel_format[5:7]]
+        return cv2.cvtColor(image, getattr(cv2, "COLOR_Bayer" + pattern + "2BGR"))
+    if pixel_format.startswith("RGB"):
+        return cv2.cvtColor(image, cv2.COLOR_RGB2BGR)
+    if pixel_format.startswith("BGR"):
+        return image
+    return cv2.cvtColor(image, cv2.COLOR_GRAY2BGR)
+
+
+def decode(data, width, height, pixel_format):
+    '''
+    Decode height rows of width pixels stored in pixel_format into an array.
+    '''
+    channels, storage = FORMATS[pixel_format]
+    count = width * height * channels
+
+    if storage == "u8":
+        pixels = np.frombuffer(data, dtype=np.uint8, count=count)
+    elif storage == "u16":
+        pixels = np.frombuffer(data, dtype="<u2", count=count)
+    elif storage == "10p":
+        pixels = unpack_10p(data, count)
+    elif storage == "12p":
+        pixels = unpack_12p(data, count)
+    else:
+        pixels = unpack_12packed(data, count)
+
+    shape = (height, width, channels) if channels > 1 else (height, width)
+    return pixels.reshape(shape)
+
+
+def _decompress_chunk(codec, payload, raw_bytes):
+    if codec == 1:
+        import zstandard
+        return zstandard.ZstdDecompressor().decompress(payload, max_output_size=raw_bytes)
+    import lz4.block
+    return lz4.block.decompress(payload, uncompressed_size=raw_bytes)
+
+
+def read_rawz(file_path, rows=None, workers=4):
+    '''
+    Load a chunk-compressed .rawz frame written with --compress.
+
+    Args:
+        file_path (str): path of the .rawz file
+        rows (tuple): optional (first, last) row range; only the chunks covering it are decompressed
+        workers (int): chunks decompressed in parallel
+
+    Returns:
+        image (np.ndarray): the frame (or the requested rows), as read_raw
+        info (dict): width, height, format, chunk_rows and frame_id from the header
+    '''
+    with open(file_path, "rb") as f:
+        data = f.read()
+    if data[:8] != b"ALVRAWZ1":
+        raise ValueError(f"{file_path} is not a .rawz file")
+
+    codec, width, height, channels, bit_depth, chunk_rows, chunk_count = struct.unpack_from("<7I", data, 8)
+    frame_id, = struct.unpack_from("<Q", data, 40)
+    pixel_format = data[48:64].split(b"\0", 1)[0].decode()
+    table = [struct.unpack_from("<QII", data, 64 + 16 * i) for i in range(chunk_count)]
+
+    first, last = rows if rows is not None else (0, height - 1)
+    chunks = range(first // chunk_rows, last // chunk_rows + 1)
+
+    def chunk(i):
+        offset, size, raw_bytes = table[i]
+        return _decompress_chunk(codec, data[offset:offset + size], raw_bytes)
+
+    with ThreadPoolExecutor(max_workers=workers) as pool:
+        parts = list(pool.map(chunk, chunks))
+
+    start = chunks[0] * chunk_rows
+    count = min(height, (chunks[-1] + 1) * chunk_rows) - start
+    image = decode(b"".join(parts), width, count, pixel_format)[first - start:last - start + 1]
+    info = {"width": width, "height": height, "channels": channels, "bit_depth": bit_depth,
+            "format": pixel_format, "chunk_rows": chunk_rows, "frame_id": frame_id}
+    return image, info
+
+
+def read_session_index(index_path):
+    '''
+    List the frames of a session striped over several --output directories.
+
+    Args:
+        index_path (str): session_index.csv in the first output directory
+
+    Returns:
+        frames (list): (frame, path) tuples in capture order; path is None for frames that failed to write
+    '''
+    frames = []
+    with open(index_path) as f:
+        next(f)
+        for line in f:
+            sequence, frame, target, path = line.rstrip("\n").split(",", 3)
+            frames.append((int(frame), path or None))
+    return frames
@@ -0,0 +1,84 @@
+import os
+import re
+import tempfile
+import unittest
+
+import numpy as np
+
+from rawformat import FORMATS, read_raw
+
+PIXEL_FORMAT_CPP = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "PixelFormat.cpp")
+
+
+def storage_names():
+    '''
+    Every (name, channels, bits) the driver can write, derived from kFormats in src/PixelFormat.cpp
+    with the CompactPacking and StorageFormatName rules.
+    '''
+    with open(PIXEL_FORMAT_CPP) as f:
+        source = f.read()
+    entries = re.findall(r'\{VmbPixelFormat\w+,\s*PixelPacking::(\w+),\s*(\d+),\s*(\d+),\s*\w+,\s*"(\w+)"\}', source)
+    names = {}
+    for packing, channels, bits, name in entries:
+        bits = int(bits)
+        if packing == "Bits16" and bits in (10, 12):
+            packing = "Packed10p" if bits == 10 else "Packed12p"
+        if packing in ("Packed10p", "Packed12p"):
+            name += "p"
+        elif packing == "Packed12Gev":
+            name += "Packed"
+        names[name] = (int(channels), bits, packing)
+    return names
+
+
+def pack(samples, bits, packing):
+    '''
+    Reference packers, written bit by bit rather than with the vectorised unpackers' arithmetic.
+    '''
+    if packing == "Bits8":
+        return samples.astype(np.uint8).tobytes()
+    if packing == "Bits16":
+        return samples.astype("<u2").tobytes()
+    if packing == "Packed12Gev":
+        out = bytearray()
+        for a, b in samples.reshape(-1, 2):
+            out += bytes([a >> 4, (a & 0xF) | (b & 0xF) << 4, b >> 4])
+        return bytes(out)
+    # 10p / 12p: samples back to back, least significant bit first
+    acc, used, out = 0, 0, bytearray()
+    for s in samples:
+        acc |= int(s) << used
+        used += bits
+        while used >= 8:
+            out.append(acc & 0xFF)
+            acc >>= 8
+            used -= 8
+    if used:
+        out.append(acc)
+    return bytes(out)
+
+
+class RoundTrip(unittest.TestCase):
+
+    def test_every_storage_name_reads_back(self):
+        names = storage_names()
+        self.assertGreater(len(names), 30)
+        rng = np.random.default_rng(7)
+        width, height = 8, 3
+        with tempfile.TemporaryDirectory() as tmp:
+            for name, (channels, bits, packing) in sorted(names.items()):
+                with self.subTest(name=name):
+                    self.assertIn(name, FORMATS)
+                    self.assertEqual(FORMATS[name][0], channels)
+                    samples = rng.integers(0, 1 << bits, size=width * height * channels, dtype=np.uint16)
+                    path = os.path.join(tmp, name + ".raw")
+                    with open(path, "wb") as f:
+                        f.write(pack(samples, bits, packing))
+                    image = read_raw(path, width, height, name)
+                    shape = (height, width, channels) if channels > 1 else (height, width)
+                    self.assertEqual(image.shape, shape)
+                    np.testing.assert_array_equal(image.reshape(-1).astype(np.uint16), samples)
+
+
+if __name__ == "__main__":
+    unittest.main()
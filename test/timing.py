@@ -9,22 +9,30 @@ import os
 base_dir = "/home/sst/data/alvium_test"
 subfolders = [f.path for f in os.scandir(base_dir) if f.is_dir()]
 input_folder = max(subfolders, key=os.path.getmtime)
-file_path = os.path.join(input_folder, "alvium_log.txt")
-print(f"Automatically loading latest log file: {file_path}")
+meta_path = os.path.join(input_folder, "frames.meta")
+
+if os.path.exists(meta_path):
+    # Sessions recorded since frames.meta exists: device timestamps, no text parsing.
+    from frame_metadata import read_frame_metadata
+    print(f"Automatically loading latest frame metadata: {meta_path}")
+    records, tick_frequency = read_frame_metadata(meta_path)
+    deltas = np.diff(records["device_timestamp"].astype(np.int64)) / tick_frequency
+else:
+    file_path = os.path.join(input_folder, "alvium_log.txt")
+    print(f"Automatically loading latest log file: {file_path}")
+
+    timestamps = []
+
+    with open(file_path, "r") as f:
+        for line in f:
+            match = re.search(r"\[(\d{4}-\d{2}-\d{2} \d{2}:\d{2}:\d{2}\.\d{3})", line)
+            if match:
+                ts_str = match.group(1)
+                ts = datetime.strptime(ts_str, "%Y-%m-%d %H:%M:%S.%f")
+                timestamps.append(ts)
+
+    deltas = [(t2 - t1).total_seconds() for t1, t2 in zip(timestamps, timestamps[1:])]
 
-timestamps = []
-
-counter = 0
-
-with open(file_path, "r") as f:
-    for line in f:
-        match = re.search(r"\[(\d{4}-\d{2}-\d{2} \d{2}:\d{2}:\d{2}\.\d{3})", line)
-        if match:
-            ts_str = match.group(1)
-            ts = datetime.strptime(ts_str, "%Y-%m-%d %H:%M:%S.%f")
-            timestamps.append(ts)
-
-deltas = [(t2 - t1).total_seconds() for t1, t2 in zip(timestamps, timestamps[1:])]
 print(f"Period: {deltas}")
 mean_deltas = np.mean(deltas)
 std_deltas = np.std(deltas)